@@ -0,0 +1,65 @@
+#pragma once
+#ifndef GFX_IMAGE_IMPL_BASIC_ALLOCATOR_H
+#define GFX_IMAGE_IMPL_BASIC_ALLOCATOR_H
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+
+// Where image headers and their data come from. Every Image_Create variant
+// (and anything that creates images, clone, convert, mip chains etc.) takes
+// its memory from the calling threads current allocator, the heap by default.
+// Image_Destroy returns each link of a chain to whichever allocator it came
+// from, so images from different allocators can be mixed freely
+typedef struct Image_Allocator Image_Allocator;
+
+// bump allocates from blocks of at least blockSize bytes. Destroying an image
+// from an arena frees nothing, Image_AllocatorReset releases every image
+// allocated from it at once (they must not be used after) and keeps the
+// blocks for reuse. 0 uses a default block size
+AL2O3_EXTERN_C Image_Allocator *Image_AllocatorCreateArena(size_t blockSize);
+
+// recycles freed images of up to maxPooledSize bytes (header included) through
+// power of 2 size class free lists, bigger images use the heap directly.
+// Image_AllocatorReset returns the cached free blocks to the heap. 0 uses a
+// default maximum
+AL2O3_EXTERN_C Image_Allocator *Image_AllocatorCreatePool(size_t maxPooledSize);
+
+AL2O3_EXTERN_C void Image_AllocatorReset(Image_Allocator *allocator);
+
+// every image from the allocator must be destroyed (or for arenas reset)
+// before the allocator is
+AL2O3_EXTERN_C void Image_AllocatorDestroy(Image_Allocator *allocator);
+
+// sets the allocator images created on this thread use, NULL for the heap.
+// Returns the previous one so scopes can be nested
+AL2O3_EXTERN_C Image_Allocator *Image_SetThreadAllocator(Image_Allocator *allocator);
+AL2O3_EXTERN_C Image_Allocator *Image_GetThreadAllocator(void);
+
+// Image_RawDataPtr of every image is aligned to at least this, enough for
+// aligned AVX-512 loads and non-temporal stores of whole cache lines
+#define Image_DefaultDataAlignment 64
+
+// sets the alignment of the pixel data of images created on this thread, a
+// power of 2 (e.g. 4096 for page aligned DMA), values below
+// Image_DefaultDataAlignment give the default. Returns the previous one.
+// Only the start of the data is aligned, rows are always tightly packed as
+// Image_CalculateIndex and the row/page size queries assume
+AL2O3_EXTERN_C size_t Image_SetThreadDataAlignment(size_t alignment);
+AL2O3_EXTERN_C size_t Image_GetThreadDataAlignment(void);
+
+// Image_Create/Image_CreateNoClear from a given allocator, whatever the
+// threads current one is
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateWithAllocator(Image_Allocator *allocator,
+																																	uint32_t width,
+																																	uint32_t height,
+																																	uint32_t depth,
+																																	uint32_t slices,
+																																	TinyImageFormat format);
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateNoClearWithAllocator(Image_Allocator *allocator,
+																																				 uint32_t width,
+																																				 uint32_t height,
+																																				 uint32_t depth,
+																																				 uint32_t slices,
+																																				 TinyImageFormat format);
+
+#endif // GFX_IMAGE_IMPL_BASIC_ALLOCATOR_H
@@ -0,0 +1,66 @@
+#pragma once
+#ifndef GFX_IMAGE_IMPL_BASIC_CONVERT_H
+#define GFX_IMAGE_IMPL_BASIC_CONVERT_H
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+
+// The kernel a step of an Image_FastConvert plan runs
+typedef enum Image_ConvertKernel {
+	// a hand written (SIMD) kernel for just this pair of formats
+	Image_CK_Fast,
+	// the template loops for plain (uncompressed, unpacked) format pairs
+	Image_CK_Matrix,
+	// decoding to logical pixels and encoding them again
+	Image_CK_Decode,
+} Image_ConvertKernel;
+
+#define Image_ConvertPlanMaxStepCount 4
+
+typedef struct Image_ConvertStep {
+	TinyImageFormat from;
+	TinyImageFormat to;
+	Image_ConvertKernel kernel;
+	// converts the image of the previous step (or the source) rather than
+	// writing a new one
+	bool inPlace;
+	// estimated cost of the step, in rough cycles per pixel
+	float cost;
+} Image_ConvertStep;
+
+typedef struct Image_ConvertPlan {
+	uint32_t stepCount;
+	Image_ConvertStep steps[Image_ConvertPlanMaxStepCount];
+	float cost;
+} Image_ConvertPlan;
+
+// the steps Image_FastConvert takes from one format to another. Where a pair
+// has no fast kernel, going through intermediate formats that have them
+// (e.g. half to float with the SIMD kernel then float to 8 bit) is taken when
+// the estimated cost is lower than the direct step. No steps when from and
+// to are the same and in place is allowed
+AL2O3_EXTERN_C void Image_PlanFastConvert(TinyImageFormat from, TinyImageFormat to, bool allowInPlace,
+																					Image_ConvertPlan *plan);
+
+// one image of an Image_FastConvertBatch
+typedef struct Image_ConvertJob {
+	Image_ImageHeader const *image;
+	TinyImageFormat format;
+	// set by the batch to what Image_FastConvert(image, format, allowInPlace)
+	// returns, NULL if it failed
+	Image_ImageHeader const *result;
+} Image_ConvertJob;
+
+// Image_FastConvert of every job, for lots of small images (sprite frames,
+// atlas pages, cube faces...) where per call overhead would dominate. Each
+// distinct pair of formats is planned once and every result is made up front
+// in one allocation from the calling threads allocator, then the jobs are
+// handed out a whole image at a time to threadCount threads (0 for every
+// hardware thread). Results are destroyed one by one as usual, their memory
+// goes back to the allocator with the last of them.
+// With allowInPlace an image must only appear in one job. false if any job
+// failed
+AL2O3_EXTERN_C bool Image_FastConvertBatch(Image_ConvertJob *jobs, size_t jobCount, bool allowInPlace,
+																					 uint32_t threadCount);
+
+#endif // GFX_IMAGE_IMPL_BASIC_CONVERT_H
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef GFX_IMAGE_IMPL_BASIC_LEVELS_H
+#define GFX_IMAGE_IMPL_BASIC_LEVELS_H
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+
+// Addressing of the levels of a chain without recomputing them. The functions
+// that build chains (mip map generation, Image_PackMipmaps, the clones and
+// converters) record every link and its offset in a directory on the head,
+// lookups (Image_LinkedImageOf, Image_MipMapCountOf, Image_LevelInfoOf etc.)
+// check it with one walk of the link pointers then index it. Chains linked by
+// hand have no directory and are walked. Formats and sizes are read from the
+// links on each lookup so converting a chain in place needs nothing.
+// Relinking the head or adding or removing links at the end is noticed and
+// the chain is walked again, a built chain relinked by hand in between must
+// call Image_ResetLevelDirectory before the next lookup
+
+// a link of a chain or a level of packed mip maps
+typedef struct Image_LevelInfo {
+	// the link holding the level, the head for packed mip maps
+	Image_ImageHeader const *image;
+	void *data;
+	TinyImageFormat format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+	uint32_t slices;
+	// where the level starts in the Image_PackMipmaps layout of the chain, e.g.
+	// a file of it, and its size
+	size_t offset;
+	size_t byteCount;
+} Image_LevelInfo;
+
+// links of the chain or for packed mip maps the packed levels
+AL2O3_EXTERN_C size_t Image_LevelCountOf(Image_ImageHeader const *image);
+
+// all zero (a NULL image) if there is no such level
+AL2O3_EXTERN_C Image_LevelInfo Image_LevelInfoOf(Image_ImageHeader const *image, size_t level);
+
+// forgets the directory of the chain image heads, later lookups walk it
+AL2O3_EXTERN_C void Image_ResetLevelDirectory(Image_ImageHeader const *image);
+
+#endif // GFX_IMAGE_IMPL_BASIC_LEVELS_H
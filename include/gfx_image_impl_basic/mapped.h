@@ -0,0 +1,60 @@
+#pragma once
+#ifndef GFX_IMAGE_IMPL_BASIC_MAPPED_H
+#define GFX_IMAGE_IMPL_BASIC_MAPPED_H
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+
+// Images whose pixel data is a memory mapped range of a file. Nothing is read
+// up front, pages are faulted in on first touch and the OS page cache decides
+// what stays resident, so huge texture caches open instantly. The header lives
+// in ordinary memory just before the mapping, so the image works with every
+// other Image_ function and Image_Destroy unmaps it
+typedef enum Image_MapMode {
+	// the image can't be written, it is marked Image_Flag_ReadOnly
+	Image_MM_ReadOnly,
+	// writes are private to this image, the file never changes
+	Image_MM_CopyOnWrite,
+	// writes go to the file (and any other mapping of it)
+	Image_MM_ReadWrite,
+} Image_MapMode;
+
+// on Image_MM_ReadOnly mappings, whose pages fault on any write. The
+// Image_Set*At functions return false and every other writer refuses them
+// like shared images (see shared.h), Image_Unshare gives a writable copy
+#define Image_Flag_ReadOnly 0x20
+
+// offsets of pixel data in a mapped file must be multiples of this (the page
+// size, or the allocation granularity on Windows)
+AL2O3_EXTERN_C size_t Image_MapOffsetAlignment(void);
+
+// maps the dataSize bytes at offset of an existing file as the pixel data of
+// an image of the given shape. Fails (NULL) if the file is too short or the
+// offset isn't aligned to Image_MapOffsetAlignment
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateMapped(char const *fileName,
+																													 uint64_t offset,
+																													 Image_MapMode mode,
+																													 uint32_t width,
+																													 uint32_t height,
+																													 uint32_t depth,
+																													 uint32_t slices,
+																													 TinyImageFormat format);
+
+// for output, creates the file if needed and extends it to hold the pixel
+// data at offset then maps it Image_MM_ReadWrite. Any extension reads as zero
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateMappedOutput(char const *fileName,
+																																 uint64_t offset,
+																																 uint32_t width,
+																																 uint32_t height,
+																																 uint32_t depth,
+																																 uint32_t slices,
+																																 TinyImageFormat format);
+
+// true if image (just this link of a chain) is a mapped image
+AL2O3_EXTERN_C bool Image_IsMapped(Image_ImageHeader const *image);
+
+// writes the dirty pages of an Image_MM_ReadWrite image back to the file
+// without waiting for Image_Destroy or the OS. False if it isn't mapped
+AL2O3_EXTERN_C bool Image_FlushMapped(Image_ImageHeader const *image);
+
+#endif // GFX_IMAGE_IMPL_BASIC_MAPPED_H
@@ -0,0 +1,59 @@
+#pragma once
+#ifndef GFX_IMAGE_IMPL_BASIC_MIPMAP_H
+#define GFX_IMAGE_IMPL_BASIC_MIPMAP_H
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+
+typedef enum Image_MipMapFilter {
+	// every level resampled from the base image with a Mitchell-Netravali filter
+	Image_MMF_HighQuality = 0,
+	// each level is a 2x2 box of the level above, on the stored channels where
+	// the format allows it (8/16/32 bit ints and floats) with correct rounding
+	Image_MMF_FastBox,
+} Image_MipMapFilter;
+
+// Extended options for mip map chain generation, Image_CreateMipMapChain is
+// the same as this with generateFromImage, a threadCount of 1 and high quality
+typedef struct Image_MipMapChainDesc {
+	// fill each level from the image, else the levels are left cleared
+	bool generateFromImage;
+
+	// threads to spread the slices and row bands of each level over.
+	// 0 uses every hardware thread, the results don't depend on the count
+	uint32_t threadCount;
+
+	Image_MipMapFilter filter;
+} Image_MipMapChainDesc;
+
+// false, with nothing linked, if image is shared (see shared.h) or the levels
+// couldn't be allocated
+AL2O3_EXTERN_C bool Image_CreateMipMapChainEx(Image_ImageHeader const *image, Image_MipMapChainDesc const *desc);
+
+// Packed mip maps built in place, one allocation holding every level in the
+// Image_PackMipmaps layout with nothing linked or repacked. The levels are
+// the same as Image_CreateMipMapChainEx makes and Image_ViewOfMipLevel or
+// Image_LevelInfoOf address each one
+
+// a cleared image with room for all of its levels. Fill level 0 (the usual
+// Image_RawDataPtr rows) then generate the rest
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateWithPackedMipMaps(uint32_t width,
+																																	 uint32_t height,
+																																	 uint32_t depth,
+																																	 uint32_t slices,
+																																	 TinyImageFormat format);
+
+// fills every level after the first of a packed mip map image from level 0.
+// False, with nothing written, if image is read only (see shared.h) or the
+// filter is out of memory
+AL2O3_EXTERN_C bool Image_GeneratePackedMipMaps(Image_ImageHeader const *image,
+																								uint32_t threadCount,
+																								Image_MipMapFilter filter);
+
+// a new packed mip map image of image (just this link) and its levels as
+// desc says. The same as Image_CreateMipMapChainEx then Image_PackMipmaps
+// without the second copy of the chain
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreatePackedMipMapChainEx(Image_ImageHeader const *image,
+																																			 Image_MipMapChainDesc const *desc);
+
+#endif // GFX_IMAGE_IMPL_BASIC_MIPMAP_H
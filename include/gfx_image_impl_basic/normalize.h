@@ -0,0 +1,27 @@
+#pragma once
+#ifndef GFX_IMAGE_IMPL_BASIC_NORMALIZE_H
+#define GFX_IMAGE_IMPL_BASIC_NORMALIZE_H
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+
+// Extended options for normalisation, Image_NormalizeEachChannel and
+// Image_NormalizeAcrossChannels are the same as these with a threadCount of 1
+// and the range scanned from the image
+typedef struct Image_NormalizeDesc {
+	// threads to spread the row bands over. 0 uses every hardware thread, the
+	// results don't depend on the count
+	uint32_t threadCount;
+
+	// use rangeMin and rangeMax (e.g. from an earlier Image_GetColorRangeOf)
+	// instead of scanning the image for them. Across channels normalisation
+	// uses the lowest min and highest max of the channels the format has
+	bool useRange;
+	Image_PixelD rangeMin;
+	Image_PixelD rangeMax;
+} Image_NormalizeDesc;
+
+AL2O3_EXTERN_C bool Image_NormalizeEachChannelEx(Image_ImageHeader const *image, Image_NormalizeDesc const *desc);
+AL2O3_EXTERN_C bool Image_NormalizeAcrossChannelsEx(Image_ImageHeader const *image, Image_NormalizeDesc const *desc);
+
+#endif // GFX_IMAGE_IMPL_BASIC_NORMALIZE_H
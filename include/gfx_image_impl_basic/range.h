@@ -0,0 +1,16 @@
+#pragma once
+#ifndef GFX_IMAGE_IMPL_BASIC_RANGE_H
+#define GFX_IMAGE_IMPL_BASIC_RANGE_H
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+
+// Image_GetColorRangeOf (which runs on the calling thread) spread over
+// threadCount threads, 0 uses every hardware thread. The results don't depend
+// on the count
+AL2O3_EXTERN_C bool Image_GetColorRangeOfEx(Image_ImageHeader const *src,
+																						uint32_t threadCount,
+																						Image_PixelD *omin,
+																						Image_PixelD *omax);
+
+#endif // GFX_IMAGE_IMPL_BASIC_RANGE_H
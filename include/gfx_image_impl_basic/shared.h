@@ -0,0 +1,54 @@
+#pragma once
+#ifndef GFX_IMAGE_IMPL_BASIC_SHARED_H
+#define GFX_IMAGE_IMPL_BASIC_SHARED_H
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+
+// Shared read-only snapshots. A snapshot is the same image (and chain) with
+// another reference rather than a copy, so taking one costs nothing. Every
+// link of the chain gains the reference, so a link reached through
+// Image_LinkedImageOf is as shared as the head. Every holder calls
+// Image_Destroy once and the chain is freed with the last.
+// Nothing is copied behind the holders backs, a shared image is read only
+// until Image_Unshare hands back one that can be written. The per pixel
+// Image_Set*At functions don't check, writing through them is the callers
+// mistake. The bulk writers check Image_IsReadOnly, which also covers read
+// only mappings (see mapped.h), and fail visibly: normalising, Image_ViewCopy,
+// image stream sinks, mip map generation and the Image_TryCopy* functions
+// return false, Image_FastConvert converts out of place and the plain
+// Image_Copy* functions ASSERT. Snapshots are marked with Image_Flag_Shared
+// so images this library didn't allocate are never taken for shared
+#define Image_Flag_Shared 0x40
+
+// another reference to image, to be destroyed like any image. Take snapshots
+// on the thread that owns the image, not while another thread writes it
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateSharedSnapshot(Image_ImageHeader const *image);
+
+// true if image has more than one reference
+AL2O3_EXTERN_C bool Image_IsShared(Image_ImageHeader const *image);
+
+// true if the writers refuse image, it is shared or a read only mapping
+AL2O3_EXTERN_C bool Image_IsReadOnly(Image_ImageHeader const *image);
+
+// image itself if it can be written, otherwise an Image_Clone of it with this
+// reference dropped (a read only mapping is unmapped with its last reference).
+// NULL if the copy fails, the reference is kept.
+// The pixel data always directly follows its header so a copy is the whole
+// chain rather than just the links that are written
+AL2O3_EXTERN_C Image_ImageHeader const *Image_Unshare(Image_ImageHeader const *image);
+
+// the Image_Copy* functions for destinations that may be read only. False,
+// with nothing written, if dst is read only or the copy couldn't be made
+AL2O3_EXTERN_C bool Image_TryCopyImage(Image_ImageHeader const *src, Image_ImageHeader const *dst);
+AL2O3_EXTERN_C bool Image_TryCopyImageChain(Image_ImageHeader const *src, Image_ImageHeader const *dst);
+AL2O3_EXTERN_C bool Image_TryCopySlice(Image_ImageHeader const *src, uint32_t sw,
+																			 Image_ImageHeader const *dst, uint32_t dw);
+AL2O3_EXTERN_C bool Image_TryCopyPage(Image_ImageHeader const *src, uint32_t sz, uint32_t sw,
+																			Image_ImageHeader const *dst, uint32_t dz, uint32_t dw);
+AL2O3_EXTERN_C bool Image_TryCopyRow(Image_ImageHeader const *src, uint32_t sy, uint32_t sz, uint32_t sw,
+																		 Image_ImageHeader const *dst, uint32_t dy, uint32_t dz, uint32_t dw);
+AL2O3_EXTERN_C bool Image_TryCopyPixel(Image_ImageHeader const *src, uint32_t sx, uint32_t sy, uint32_t sz, uint32_t sw,
+																			 Image_ImageHeader const *dst, uint32_t dx, uint32_t dy, uint32_t dz, uint32_t dw);
+
+#endif // GFX_IMAGE_IMPL_BASIC_SHARED_H
@@ -0,0 +1,61 @@
+#pragma once
+#ifndef GFX_IMAGE_IMPL_BASIC_STATISTICS_H
+#define GFX_IMAGE_IMPL_BASIC_STATISTICS_H
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image_impl_basic/view.h"
+
+typedef struct Image_StatisticsDesc {
+	// threads to spread the pass over. 0 uses every hardware thread, the
+	// results are bit identical whatever the count
+	uint32_t threadCount;
+
+	// histogram bins per channel, 0 gives 256
+	uint32_t binCount;
+
+	// the range each channels histogram covers, values outside it are counted
+	// in the end bins. Without it each channel covers its own min to max, for
+	// formats other than 8 bit ones that costs an extra min/max pass first
+	bool useRange;
+	Image_PixelD rangeMin;
+	Image_PixelD rangeMax;
+} Image_StatisticsDesc;
+
+typedef struct Image_ChannelStatistics {
+	// values seen, NaNs are skipped. 0 for channels the format doesn't store
+	uint64_t count;
+	double min;
+	double max;
+	double mean;
+	// population variance
+	double variance;
+	// the range the histogram bins evenly divide
+	double histogramMin;
+	double histogramMax;
+} Image_ChannelStatistics;
+
+// indexed by logical channel (r, g, b, a) like Image_PixelD, the histograms of
+// each channel follow in the same allocation, see Image_StatisticsHistogramOf
+typedef struct Image_Statistics {
+	uint32_t binCount;
+	Image_ChannelStatistics channel[4];
+} Image_Statistics;
+
+// statistics of every pixel of the image in one pass (bar the optional range
+// scan), returns NULL if the format can't be decoded
+AL2O3_EXTERN_C Image_Statistics const *Image_ComputeStatistics(Image_ImageHeader const *image,
+																															 Image_StatisticsDesc const *desc);
+// the same over the pixels of a view, all zero for an empty view (see view.h)
+AL2O3_EXTERN_C Image_Statistics const *Image_ViewComputeStatistics(Image_View const *view,
+																																	 Image_StatisticsDesc const *desc);
+AL2O3_EXTERN_C void Image_DestroyStatistics(Image_Statistics const *stats);
+
+// binCount counts of channel
+AL2O3_EXTERN_C uint64_t const *Image_StatisticsHistogramOf(Image_Statistics const *stats, uint32_t channel);
+
+// the value below which percentile (0 to 100) of the channels values lie,
+// interpolated linearly inside the histogram bin so only as exact as the bins
+AL2O3_EXTERN_C double Image_StatisticsPercentile(Image_Statistics const *stats, uint32_t channel, double percentile);
+
+#endif // GFX_IMAGE_IMPL_BASIC_STATISTICS_H
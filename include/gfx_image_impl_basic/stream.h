@@ -0,0 +1,80 @@
+#pragma once
+#ifndef GFX_IMAGE_IMPL_BASIC_STREAM_H
+#define GFX_IMAGE_IMPL_BASIC_STREAM_H
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+
+// Out of core processing for images too big to hold in memory. Rows are pulled
+// from a source a band at a time, converted, normalised and box filtered into
+// mip levels, and pushed to a sink per level. Peak memory grows with the band
+// height and width, not the image height. Rows are whole and tightly packed,
+// every source and sink sees them top to bottom exactly once
+
+// where rows come from (e.g. a decoder), a 2D image of width x height
+typedef struct Image_StreamSource {
+	uint32_t width;
+	uint32_t height;
+	TinyImageFormat format;
+
+	// copies rowCount rows starting at firstRow to dst, false aborts the stream
+	bool (*readRows)(void *user, uint32_t firstRow, uint32_t rowCount, void *dst);
+	void *user;
+} Image_StreamSource;
+
+// where rows go (e.g. an encoder). Level n of the output is the source size
+// halved n times (rounding down to 1) in the output format
+typedef struct Image_StreamSink {
+	// gets rowCount rows starting at firstRow, false aborts the stream. NULL
+	// discards the level (a mip level may only be wanted to build smaller ones)
+	bool (*writeRows)(void *user, uint32_t firstRow, uint32_t rowCount, void const *src);
+	void *user;
+} Image_StreamSink;
+
+typedef struct Image_StreamDesc {
+	// rows per band, 0 uses a default
+	uint32_t bandHeight;
+
+	// threads to spread the work of each band over. 0 uses every hardware
+	// thread, the results don't depend on the count
+	uint32_t threadCount;
+
+	// what the sinks get, TinyImageFormat_UNDEFINED keeps the source format
+	TinyImageFormat outputFormat;
+
+	// normalise each channel from rangeMin..rangeMax to 0..1 after converting,
+	// the range usually comes from an earlier Image_StreamColorRange pass
+	bool normalize;
+	Image_PixelD rangeMin;
+	Image_PixelD rangeMax;
+} Image_StreamDesc;
+
+// the same as Image_PreciseConvert, Image_NormalizeEachChannelEx then
+// Image_CreateMipMapChainEx with Image_MMF_FastBox on the whole image. sinks[0]
+// gets the full size image and sinks[n] mip level n, sinkCount - 1 levels are
+// generated (at most down to 1x1). False if a callback failed, or before any
+// row is read if the source can't be converted to the output format or the
+// output format can't be normalised or filtered (block formats and those
+// that can't be encoded) when that is asked for. Sources of images with more
+// than one page (Image_StreamSourceOfImage of a volume or array) are refused
+// with more than one sink, the filter would blend the pages together
+AL2O3_EXTERN_C bool Image_StreamProcess(Image_StreamSource const *source,
+																				Image_StreamSink const *sinks,
+																				uint32_t sinkCount,
+																				Image_StreamDesc const *desc);
+
+// Image_GetColorRangeOf over every row of source. Only bandHeight and
+// threadCount of desc are used. False if the source failed
+AL2O3_EXTERN_C bool Image_StreamColorRange(Image_StreamSource const *source,
+																					 Image_StreamDesc const *desc,
+																					 Image_PixelD *omin,
+																					 Image_PixelD *omax);
+
+// sources and sinks reading or writing every row of an image (all its pages
+// in order), e.g. a file mapped one. The image must outlive the stream. Rows
+// of tiled images are spread over their tiles so their sources and sinks
+// fail, Image_CloneLinear first. Sinks of read only images (see shared.h) fail
+AL2O3_EXTERN_C Image_StreamSource Image_StreamSourceOfImage(Image_ImageHeader const *image);
+AL2O3_EXTERN_C Image_StreamSink Image_StreamSinkOfImage(Image_ImageHeader const *image);
+
+#endif // GFX_IMAGE_IMPL_BASIC_STREAM_H
@@ -0,0 +1,33 @@
+#pragma once
+#ifndef GFX_IMAGE_IMPL_BASIC_TILED_H
+#define GFX_IMAGE_IMPL_BASIC_TILED_H
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+
+// A tiled image stores each page as Image_TileSize x Image_TileSize tiles, the
+// tiles in row order and the pixels of a tile in Morton (Z) order, so 2x2
+// footprints are 4 consecutive pixels and vertical neighbours share cache
+// lines. The data is the same size as a linear image, only the order of the
+// pixels differs. Only 2D images of one pixel block formats with a width and
+// height that are multiples of Image_TileSize, without packed mip maps, can be
+// tiled. Copies, clones, conversions, colour ranges, statistics, normalising
+// and mip map generation all handle tiled images. Rows, views and streams
+// see the stored order, so regions of a tiled image need a linear copy
+#define Image_Flag_Tiled 0x80
+#define Image_TileSize 8
+
+AL2O3_EXTERN_C bool Image_IsTiled(Image_ImageHeader const *image);
+AL2O3_EXTERN_C bool Image_CanBeTiled(Image_ImageHeader const *image);
+
+// the pixel index of (x, y, z, w) for Image_GetPixelAt and friends in
+// whichever layout image has. Image_CalculateIndex only suits linear images
+AL2O3_EXTERN_C size_t Image_CalculateLayoutIndex(Image_ImageHeader const *image,
+																								 uint32_t x, uint32_t y, uint32_t z, uint32_t w);
+
+// copies of image and its chain, tiled where a link can be or linear. NULL if
+// any link or the page a swizzle goes through can't be made
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CloneTiled(Image_ImageHeader const *image);
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CloneLinear(Image_ImageHeader const *image);
+
+#endif // GFX_IMAGE_IMPL_BASIC_TILED_H
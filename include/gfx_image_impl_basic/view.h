@@ -0,0 +1,76 @@
+#pragma once
+#ifndef GFX_IMAGE_IMPL_BASIC_VIEW_H
+#define GFX_IMAGE_IMPL_BASIC_VIEW_H
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+
+// A non owning window onto part of an image's storage (a crop, a slice or
+// cube face, a page, a mip level), so per face or per tile work needs no
+// allocation or copy. A view is a plain value, it stays valid as long as the
+// image it came from and writes through it change that image
+typedef struct Image_View {
+	// first pixel (or block) of the view
+	void *data;
+	TinyImageFormat format;
+
+	// in pixels, block formats always cover whole blocks
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+	uint32_t slices;
+
+	// bytes from one row (of blocks) to the next, one z page to the next and
+	// one slice to the next
+	size_t rowPitch;
+	size_t pagePitch;
+	size_t slicePitch;
+
+	// the image (the link, or the head of packed mip maps) whose storage this
+	// is, NULL for empty views. Copies into the view fail while it is read
+	// only (see shared.h), even if it was shared after the view was made
+	Image_ImageHeader const *image;
+
+	// the image was read only when the view was made or the view is empty
+	bool readOnly;
+} Image_View;
+
+// The rows of a tiled image (Image_Flag_Tiled) are spread over its tiles so no
+// pitches address them, views of one (or its tiled mip levels) are empty: data
+// is NULL, every size 0 and copies and clones of them fail
+
+// every pixel of image (just this link of a chain)
+AL2O3_EXTERN_C Image_View Image_ViewOf(Image_ImageHeader const *image);
+
+// width x height x depth x slices pixels of image from (x, y, z, w). For block
+// formats the origin and extent must be whole blocks
+AL2O3_EXTERN_C Image_View Image_ViewOfRegion(Image_ImageHeader const *image,
+																						 uint32_t x, uint32_t y, uint32_t z, uint32_t w,
+																						 uint32_t width, uint32_t height, uint32_t depth, uint32_t slices);
+
+// one slice, for cubemaps face f of cube c is slice c * 6 + f
+AL2O3_EXTERN_C Image_View Image_ViewOfSlice(Image_ImageHeader const *image, uint32_t w);
+
+// mip level of image, either a link of its mip map chain or a level of its
+// packed mip maps
+AL2O3_EXTERN_C Image_View Image_ViewOfMipLevel(Image_ImageHeader const *image, uint32_t level);
+
+// the same as Image_ViewOfRegion relative to another view
+AL2O3_EXTERN_C Image_View Image_SubView(Image_View const *view,
+																				uint32_t x, uint32_t y, uint32_t z, uint32_t w,
+																				uint32_t width, uint32_t height, uint32_t depth, uint32_t slices);
+
+// copies the pixels of src to dst converting formats as Image_CopyImage does.
+// Both must have the same extent and may be views of the same image if they
+// don't overlap. False if the formats can't be converted, dst is read only or
+// its image now is
+AL2O3_EXTERN_C bool Image_ViewCopy(Image_View const *src, Image_View const *dst);
+
+// a new image holding the pixels of view in newFormat, UNDEFINED keeps the
+// views format. The Image_PreciseConvert of views
+AL2O3_EXTERN_C Image_ImageHeader const *Image_ViewClone(Image_View const *view, TinyImageFormat newFormat);
+
+// Image_GetColorRangeOf of the pixels of view
+AL2O3_EXTERN_C bool Image_ViewGetColorRangeOf(Image_View const *view, Image_PixelD *omin, Image_PixelD *omax);
+
+#endif // GFX_IMAGE_IMPL_BASIC_VIEW_H
@@ -0,0 +1,386 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "gfx_image/image.h"
+#include "gfx_image_impl_basic/allocator.h"
+#include "allocator.hpp"
+#include "levels.hpp"
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace {
+
+// sits just before every image header. The pixel data directly follows the
+// header so the header is placed at the aligned data address less its size,
+// base is where the underlying allocation really starts
+struct AllocationPrefix {
+	void *base;
+	Image_Allocator *allocator;
+	Image::ExternalRelease release;
+	uint32_t sizeClass;
+	std::atomic<uint32_t> references;
+	std::atomic<Image::LevelDirectory *> directory;
+};
+static_assert(sizeof(AllocationPrefix) <= Image::ImagePrefixSize, "ImagePrefixSize too small");
+
+uint32_t const NotPooled = ~0u;
+// arena blocks are carved up at this granularity
+size_t const ArenaGranularity = 16;
+
+size_t const DefaultArenaBlockSize = 4 * 1024 * 1024;
+size_t const DefaultMaxPooledSize = 1024 * 1024;
+// smallest size class, covers a header and a few hundred bytes of pixels
+size_t const MinPooledSize = 256;
+uint32_t const MaxSizeClassCount = 32;
+
+enum class AllocatorKind {
+	Arena,
+	Pool,
+};
+
+struct ArenaBlock {
+	uint8_t *memory;
+	size_t size;
+	size_t used;
+};
+
+// freed pool blocks link through their first bytes
+struct FreeBlock {
+	FreeBlock *next;
+};
+
+thread_local Image_Allocator *threadAllocator = nullptr;
+thread_local size_t threadDataAlignment = Image_DefaultDataAlignment;
+
+uintptr_t AlignUp(uintptr_t v, size_t alignment) {
+	return (v + alignment - 1) & ~(alignment - 1);
+}
+
+} // end anon namespace
+
+struct Image_Allocator {
+	AllocatorKind kind;
+	std::mutex mutex;
+
+	// arena
+	size_t blockSize;
+	std::vector<ArenaBlock> blocks;
+	size_t currentBlock;
+
+	// pool
+	size_t maxPooledSize;
+	uint32_t sizeClassCount;
+	FreeBlock *freeLists[MaxSizeClassCount];
+};
+
+namespace {
+
+Image_Allocator *NewAllocator(AllocatorKind kind) {
+	void *memory = MEMORY_MALLOC(sizeof(Image_Allocator));
+	if (!memory) {
+		return nullptr;
+	}
+	auto allocator = new(memory) Image_Allocator();
+	allocator->kind = kind;
+	allocator->blockSize = 0;
+	allocator->currentBlock = 0;
+	allocator->maxPooledSize = 0;
+	allocator->sizeClassCount = 0;
+	for (auto &freeList : allocator->freeLists) {
+		freeList = nullptr;
+	}
+	return allocator;
+}
+
+void *ArenaAllocate(Image_Allocator *arena, size_t size) {
+	size = AlignUp(size, ArenaGranularity);
+	// blocks kept from before a reset are reused in order
+	while (arena->currentBlock < arena->blocks.size()) {
+		ArenaBlock &block = arena->blocks[arena->currentBlock];
+		if (block.size - block.used >= size) {
+			void *result = block.memory + block.used;
+			block.used += size;
+			return result;
+		}
+		arena->currentBlock++;
+	}
+
+	ArenaBlock block;
+	block.size = size > arena->blockSize ? size : arena->blockSize;
+	block.memory = (uint8_t *) MEMORY_MALLOC(block.size);
+	if (!block.memory) {
+		return nullptr;
+	}
+	block.used = size;
+	arena->blocks.push_back(block);
+	arena->currentBlock = arena->blocks.size() - 1;
+	return block.memory;
+}
+
+uint32_t SizeClassOf(Image_Allocator const *pool, size_t size) {
+	uint32_t sizeClass = 0;
+	size_t classSize = MinPooledSize;
+	while (classSize < size) {
+		classSize <<= 1;
+		sizeClass++;
+	}
+	return sizeClass < pool->sizeClassCount ? sizeClass : NotPooled;
+}
+
+AllocationPrefix *PrefixOf(Image_ImageHeader const *image) {
+	return (AllocationPrefix *) (((AllocationPrefix const *) image) - 1);
+}
+
+// each image of a group holds a reference on the carrier image whose data
+// the group was carved from
+void ReleaseGroupMember(void *carrier) {
+	auto image = (Image_ImageHeader const *) carrier;
+	if (Image::ReleaseImage(image)) {
+		Image::FreeImage(image);
+	}
+}
+
+void ReleaseFreeLists(Image_Allocator *pool) {
+	for (uint32_t i = 0; i < pool->sizeClassCount; ++i) {
+		FreeBlock *block = pool->freeLists[i];
+		while (block) {
+			FreeBlock *next = block->next;
+			MEMORY_FREE(block);
+			block = next;
+		}
+		pool->freeLists[i] = nullptr;
+	}
+}
+
+} // end anon namespace
+
+Image_ImageHeader *Image::AllocateImage(Image_Allocator *allocator, size_t byteCount, bool zeroed) {
+	size_t const alignment = threadDataAlignment;
+	size_t const headerSize = sizeof(AllocationPrefix) + sizeof(Image_ImageHeader);
+	size_t const totalSize = headerSize + byteCount + alignment - 1;
+	void *base = nullptr;
+	uint32_t sizeClass = NotPooled;
+	// calloc gets large blocks as fresh zero pages from the OS, so nothing
+	// is touched up front, only reused arena and pool memory needs clearing
+	bool needsClear = zeroed;
+
+	if (!allocator) {
+		base = zeroed ? MEMORY_CALLOC(1, totalSize) : MEMORY_MALLOC(totalSize);
+		needsClear = false;
+	} else if (allocator->kind == AllocatorKind::Arena) {
+		std::lock_guard<std::mutex> lock(allocator->mutex);
+		base = ArenaAllocate(allocator, totalSize);
+	} else {
+		sizeClass = SizeClassOf(allocator, totalSize);
+		if (sizeClass != NotPooled) {
+			std::lock_guard<std::mutex> lock(allocator->mutex);
+			FreeBlock *block = allocator->freeLists[sizeClass];
+			if (block) {
+				allocator->freeLists[sizeClass] = block->next;
+				base = block;
+			}
+		}
+		if (!base && sizeClass != NotPooled) {
+			base = MEMORY_MALLOC(MinPooledSize << sizeClass);
+		} else if (!base) {
+			base = zeroed ? MEMORY_CALLOC(1, totalSize) : MEMORY_MALLOC(totalSize);
+			needsClear = false;
+		}
+	}
+	if (!base) {
+		return nullptr;
+	}
+
+	uintptr_t const data = AlignUp((uintptr_t) base + headerSize, alignment);
+	auto image = ((Image_ImageHeader *) data) - 1;
+	AllocationPrefix *prefix = ((AllocationPrefix *) image) - 1;
+	prefix->base = base;
+	prefix->allocator = allocator;
+	prefix->release = nullptr;
+	prefix->sizeClass = sizeClass;
+	prefix->references.store(1, std::memory_order_relaxed);
+	prefix->directory.store(nullptr, std::memory_order_relaxed);
+	if (needsClear) {
+		memset((void *) data, 0, byteCount);
+	}
+	return image;
+}
+
+Image_ImageHeader *Image::AllocateImage(size_t byteCount, bool zeroed) {
+	return AllocateImage(threadAllocator, byteCount, zeroed);
+}
+
+void Image::FreeImage(Image_ImageHeader const *image) {
+	if (!image) {
+		return;
+	}
+	AllocationPrefix const *prefix = ((AllocationPrefix const *) image) - 1;
+	Image_Allocator *allocator = prefix->allocator;
+	FreeLevelDirectory(prefix->directory.load(std::memory_order_acquire));
+
+	if (prefix->release) {
+		prefix->release(prefix->base);
+	} else if (!allocator) {
+		MEMORY_FREE(prefix->base);
+	} else if (allocator->kind == AllocatorKind::Arena) {
+		// released in bulk by Image_AllocatorReset
+	} else if (prefix->sizeClass == NotPooled) {
+		MEMORY_FREE(prefix->base);
+	} else {
+		std::lock_guard<std::mutex> lock(allocator->mutex);
+		auto block = (FreeBlock *) prefix->base;
+		block->next = allocator->freeLists[prefix->sizeClass];
+		allocator->freeLists[prefix->sizeClass] = block;
+	}
+}
+
+bool Image::AllocateImageGroup(size_t count, size_t const *byteCounts, Image_ImageHeader **images) {
+	ASSERT(count > 0);
+	size_t const alignment = threadDataAlignment;
+	// every member needs a prefix and header before its aligned data
+	size_t const memberOverhead = ImagePrefixSize + sizeof(Image_ImageHeader) + alignment - 1;
+	size_t total = 0;
+	for (size_t i = 0; i < count; ++i) {
+		total += memberOverhead + byteCounts[i];
+	}
+	// the carriers own header is never filled in, only its prefix is used
+	Image_ImageHeader *carrier = AllocateImage(threadAllocator, total, false);
+	if (!carrier) {
+		return false;
+	}
+	PrefixOf(carrier)->references.store((uint32_t) count, std::memory_order_relaxed);
+
+	uintptr_t cursor = (uintptr_t) (carrier + 1);
+	for (size_t i = 0; i < count; ++i) {
+		uintptr_t const data = AlignUp(cursor + ImagePrefixSize + sizeof(Image_ImageHeader), alignment);
+		auto image = ((Image_ImageHeader *) data) - 1;
+		AdoptExternalImage(image, carrier, &ReleaseGroupMember);
+		images[i] = image;
+		cursor = data + byteCounts[i];
+	}
+	return true;
+}
+
+void Image::AdoptExternalImage(Image_ImageHeader *image, void *base, ExternalRelease release) {
+	ASSERT(release);
+	AllocationPrefix *prefix = ((AllocationPrefix *) image) - 1;
+	prefix->base = base;
+	prefix->allocator = nullptr;
+	prefix->release = release;
+	prefix->sizeClass = NotPooled;
+	prefix->references.store(1, std::memory_order_relaxed);
+	prefix->directory.store(nullptr, std::memory_order_relaxed);
+}
+
+Image::ExternalRelease Image::ExternalReleaseOf(Image_ImageHeader const *image) {
+	AllocationPrefix const *prefix = ((AllocationPrefix const *) image) - 1;
+	return prefix->release;
+}
+
+void Image::RetainImage(Image_ImageHeader const *image) {
+	auto prefix = (AllocationPrefix *) (((AllocationPrefix const *) image) - 1);
+	prefix->references.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool Image::ReleaseImage(Image_ImageHeader const *image) {
+	auto prefix = (AllocationPrefix *) (((AllocationPrefix const *) image) - 1);
+	// acquire release so every write through any reference happens before
+	// the free
+	uint32_t const before = prefix->references.fetch_sub(1, std::memory_order_acq_rel);
+	ASSERT(before > 0);
+	return before == 1;
+}
+
+uint32_t Image::ReferenceCountOf(Image_ImageHeader const *image) {
+	AllocationPrefix const *prefix = ((AllocationPrefix const *) image) - 1;
+	return prefix->references.load(std::memory_order_acquire);
+}
+
+std::atomic<Image::LevelDirectory *> *Image::LevelDirectorySlotOf(Image_ImageHeader const *image) {
+	auto prefix = (AllocationPrefix *) (((AllocationPrefix const *) image) - 1);
+	// images of a group live as long as the allocation they were carved from
+	AllocationPrefix const *owner = prefix->release == &ReleaseGroupMember ?
+			PrefixOf((Image_ImageHeader const *) prefix->base) : prefix;
+	if (owner->allocator && owner->allocator->kind == AllocatorKind::Arena) {
+		return nullptr;
+	}
+	return &prefix->directory;
+}
+
+AL2O3_EXTERN_C Image_Allocator *Image_AllocatorCreateArena(size_t blockSize) {
+	Image_Allocator *arena = NewAllocator(AllocatorKind::Arena);
+	if (arena) {
+		arena->blockSize = blockSize ? blockSize : DefaultArenaBlockSize;
+	}
+	return arena;
+}
+
+AL2O3_EXTERN_C Image_Allocator *Image_AllocatorCreatePool(size_t maxPooledSize) {
+	Image_Allocator *pool = NewAllocator(AllocatorKind::Pool);
+	if (pool) {
+		pool->maxPooledSize = maxPooledSize ? maxPooledSize : DefaultMaxPooledSize;
+		uint32_t classCount = 0;
+		for (size_t classSize = MinPooledSize; classSize <= pool->maxPooledSize && classCount < MaxSizeClassCount;
+				 classSize <<= 1) {
+			classCount++;
+		}
+		pool->sizeClassCount = classCount;
+	}
+	return pool;
+}
+
+AL2O3_EXTERN_C void Image_AllocatorReset(Image_Allocator *allocator) {
+	if (!allocator) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(allocator->mutex);
+	if (allocator->kind == AllocatorKind::Arena) {
+		for (auto &block : allocator->blocks) {
+			block.used = 0;
+		}
+		allocator->currentBlock = 0;
+	} else {
+		ReleaseFreeLists(allocator);
+	}
+}
+
+AL2O3_EXTERN_C void Image_AllocatorDestroy(Image_Allocator *allocator) {
+	if (!allocator) {
+		return;
+	}
+	if (allocator->kind == AllocatorKind::Arena) {
+		for (auto &block : allocator->blocks) {
+			MEMORY_FREE(block.memory);
+		}
+	} else {
+		ReleaseFreeLists(allocator);
+	}
+	if (threadAllocator == allocator) {
+		threadAllocator = nullptr;
+	}
+	allocator->~Image_Allocator();
+	MEMORY_FREE(allocator);
+}
+
+AL2O3_EXTERN_C Image_Allocator *Image_SetThreadAllocator(Image_Allocator *allocator) {
+	Image_Allocator *previous = threadAllocator;
+	threadAllocator = allocator;
+	return previous;
+}
+
+AL2O3_EXTERN_C Image_Allocator *Image_GetThreadAllocator(void) {
+	return threadAllocator;
+}
+
+AL2O3_EXTERN_C size_t Image_SetThreadDataAlignment(size_t alignment) {
+	ASSERT((alignment & (alignment - 1)) == 0);
+	size_t const previous = threadDataAlignment;
+	threadDataAlignment = alignment > Image_DefaultDataAlignment ? alignment : Image_DefaultDataAlignment;
+	return previous;
+}
+
+AL2O3_EXTERN_C size_t Image_GetThreadDataAlignment(void) {
+	return threadDataAlignment;
+}
@@ -0,0 +1,54 @@
+// Internal side of the image allocators. Every image allocation carries a
+// small prefix recording the allocator it came from so Image_Destroy can
+// hand it back without the (public, fixed) header having to know
+#ifndef WYRD_IMAGE_ALLOCATOR_HPP
+#define WYRD_IMAGE_ALLOCATOR_HPP
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image_impl_basic/allocator.h"
+#include <atomic>
+
+namespace Image {
+
+// header plus byteCount bytes from allocator, nullptr on failure. The header
+// is not filled in, the data is all zero if zeroed is set
+Image_ImageHeader *AllocateImage(Image_Allocator *allocator, size_t byteCount, bool zeroed);
+
+// the same from the calling threads current allocator
+Image_ImageHeader *AllocateImage(size_t byteCount, bool zeroed);
+
+// frees just this image, not any it links to
+void FreeImage(Image_ImageHeader const *image);
+
+// count images carved from one allocation of the calling threads current
+// allocator, images[i] with byteCounts[i] bytes of data (not cleared). Each
+// is freed on its own like any image, the allocation goes back with the last.
+// False, with nothing allocated, on failure
+bool AllocateImageGroup(size_t count, size_t const *byteCounts, Image_ImageHeader **images);
+
+// images whose memory doesn't come from an allocator (file mappings) place
+// their header themselves with at least ImagePrefixSize bytes before it.
+// FreeImage hands base to release instead of freeing anything
+size_t const ImagePrefixSize = 48;
+typedef void (*ExternalRelease)(void *base);
+void AdoptExternalImage(Image_ImageHeader *image, void *base, ExternalRelease release);
+
+// the release given to AdoptExternalImage, nullptr for allocated images
+ExternalRelease ExternalReleaseOf(Image_ImageHeader const *image);
+
+// every image starts with one reference, shared clones add more. Release is
+// true when it dropped the last one and the image should be freed
+void RetainImage(Image_ImageHeader const *image);
+bool ReleaseImage(Image_ImageHeader const *image);
+uint32_t ReferenceCountOf(Image_ImageHeader const *image);
+
+// where the level directory of the chain image heads is cached, it is freed
+// with the image. nullptr for arena images as a reset frees them without
+// Image_Destroy
+struct LevelDirectory;
+std::atomic<LevelDirectory *> *LevelDirectorySlotOf(Image_ImageHeader const *image);
+
+} // end namespace Image
+
+#endif //WYRD_IMAGE_ALLOCATOR_HPP
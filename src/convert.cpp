@@ -1,16 +1,50 @@
 #include "al2o3_platform/platform.h"
 #include "tiny_imageformat/tinyimageformat_base.h"
 #include "tiny_imageformat/tinyimageformat_query.h"
+#include "tiny_imageformat/tinyimageformat_encode.h"
 #include "gfx_image/image.h"
+#include "gfx_image/create.h"
 #include "gfx_image/utils.h"
+#include "gfx_image_impl_basic/allocator.h"
+#include "gfx_image_impl_basic/convert.h"
+#include "gfx_image_impl_basic/shared.h"
+#include "allocator.hpp"
+#include "convert_kernels.hpp"
+#include "convert_matrix.hpp"
+#include "levels.hpp"
+#include "parallel.hpp"
+#include "tiled.hpp"
+#include <atomic>
+#include <cfloat>
+#include <vector>
 
 namespace {
 typedef void (*ImageConvertFunc)(Image_ImageHeader const*src, TinyImageFormat newFormat, Image_ImageHeader const*dst);
 typedef bool (*ImageConvertOutOfPlaceFunc)(Image_ImageHeader const*src, TinyImageFormat newFormat, Image_ImageHeader const**dst);
 
+// same chain structure and layout as image but every link in newFormat, as
+// converters change the pixel size Image_CloneStructure can't be used. Not
+// cleared as every converter writes every pixel of every link
+Image_ImageHeader const *CloneStructureAs(Image_ImageHeader const *image, TinyImageFormat newFormat) {
+	auto dst = (Image_ImageHeader *) Image_CreateNoClear(image->width, image->height, image->depth, image->slices, newFormat);
+	if (dst == nullptr) {
+		return nullptr;
+	}
+	Image::InheritLayout(image, dst);
+	if (image->nextType != Image_NT_None) {
+		dst->nextImage = CloneStructureAs(image->nextImage, newFormat);
+		if (dst->nextImage == nullptr) {
+			Image_Destroy(dst);
+			return nullptr;
+		}
+		dst->nextType = image->nextType;
+	}
+	return dst;
+}
+
 #define DefineOutOfPlaceConvert(x) \
 bool x##OutOfPlace(Image_ImageHeader const*src, TinyImageFormat newFormat, Image_ImageHeader const**dst) {\
-  *dst = Image_CloneStructure(src); \
+  *dst = CloneStructureAs(src, newFormat); \
   if (!*dst) { return false; } \
   x(src, newFormat, *dst); \
   return true; \
@@ -26,291 +60,217 @@ bool SlowImageConvertOutOfPlace(Image_ImageHeader const*src, TinyImageFormat new
   return (*dst != nullptr);
 }
 
-void R8G8B8ToR8B8G8A8(Image_ImageHeader const*src, TinyImageFormat newFormat, Image_ImageHeader const * dest) {
+// runs kernel over every link of the src chain writing into the matching link
+// of dest, dest is src when converting in place
+template<typename Kernel>
+void ConvertChain(Image_ImageHeader const *src, TinyImageFormat newFormat, Image_ImageHeader const *dest, Kernel kernel) {
 	// this const cast smells wrong but needed because of inplace
-	auto dst = (Image_ImageHeader*)dest;
-  do {
-    ASSERT(TinyImageFormat_ChannelCount(src->format) == 3);
-    ASSERT(TinyImageFormat_ChannelCount(newFormat) == 4);
-    dst->format = newFormat;
-
-    // Fast path for RGB->RGBA8
-    auto sdata = (uint8_t const *) Image_RawDataPtr(src);
-    auto ddata = (uint8_t *) Image_RawDataPtr(dst);
-    size_t nPixels = Image_PixelCountOf(src);
-    do {
-      ddata[0] = sdata[0];
-      ddata[1] = sdata[1];
-      ddata[2] = sdata[2];
-      ddata[3] = 255;
-      sdata += 3;
-      ddata += 4;
-    } while (--nPixels);
-
-		if (src->nextType != Image_NT_None) {
-			dst->nextType = src->nextType;
-			src = src->nextImage;
-			dst = (Image_ImageHeader*)dst->nextImage;
-		} else {
-			if(dst->nextType != Image_NT_None) Image_Destroy(dst->nextImage);
-			dst->nextType = Image_NT_None;
-		}
-  } while (src->nextType != Image_NT_None);
+	auto dst = (Image_ImageHeader *) dest;
+	while (true) {
+		kernel(src, dst);
+		dst->format = newFormat;
 
+		if (src->nextType == Image_NT_None || src->nextImage == nullptr) {
+			break;
+		}
+		ASSERT(dst->nextImage);
+		dst->nextType = src->nextType;
+		src = src->nextImage;
+		dst = (Image_ImageHeader *) dst->nextImage;
+	}
+}
+
+// the byte a 1.0 alpha encodes to, 255 for UNORM/SRGB, 127 for SNORM and 1 for UINT/SINT
+uint8_t AlphaOneOf8BitFormat(TinyImageFormat format) {
+	float const one[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+	uint8_t pixel[4] = {0, 0, 0, 0xFF};
+	TinyImageFormat_EncodeOutput output { pixel };
+	TinyImageFormat_EncodeLogicalPixelsF(format, one, 1, &output);
+	return pixel[3];
+}
+
+void R8G8B8ToR8B8G8A8(Image_ImageHeader const*src, TinyImageFormat newFormat, Image_ImageHeader const * dest) {
+	ASSERT(TinyImageFormat_ChannelCount(src->format) == 3);
+	ASSERT(TinyImageFormat_ChannelCount(newFormat) == 4);
+	uint8_t const alpha = AlphaOneOf8BitFormat(newFormat);
+
+	// Fast path for RGB->RGBA8
+	ConvertChain(src, newFormat, dest, [alpha](Image_ImageHeader const *s, Image_ImageHeader *d) {
+		Image::SwizzleRGB8ToRGBA8((uint8_t const *) Image_RawDataPtr(s),
+															(uint8_t *) Image_RawDataPtr(d),
+															Image_PixelCountOf(s),
+															alpha);
+	});
 }
 DefineOutOfPlaceConvert(R8G8B8ToR8B8G8A8)
 
 void R8G8B8A8ToB8G8R8A8(Image_ImageHeader const*src, TinyImageFormat newFormat, Image_ImageHeader const * dest) {
-	// this const cast smells wrong but needed because of inplace
-	auto dst = (Image_ImageHeader*)dest;
-  do {
-    ASSERT(TinyImageFormat_ChannelCount(src->format) == 4);
-    ASSERT(TinyImageFormat_ChannelCount(newFormat) == 4);
-    dst->format = newFormat;
-
-    // Fast path for RGBA8->BGRA8 (just swizzle)
-    auto sdata = (uint8_t const*) Image_RawDataPtr(src);
-    auto ddata = (uint8_t *) Image_RawDataPtr(dst);
-    size_t nPixels = Image_PixelCountOf(src);
-    do {
-      uint8_t r = sdata[2];
-      uint8_t g = sdata[1];
-      uint8_t b = sdata[0];
-      uint8_t a = sdata[3];
-      ddata[0] = r;
-      ddata[1] = g;
-      ddata[2] = b;
-      ddata[3] = a;
-      sdata += 4;
-      ddata += 4;
-    } while (--nPixels);
-
-		if (src->nextType != Image_NT_None) {
-			dst->nextType = src->nextType;
-			src = src->nextImage;
-			dst = (Image_ImageHeader*)dst->nextImage;
-		} else {
-			if(dst->nextType != Image_NT_None) Image_Destroy(dst->nextImage);
-			dst->nextType = Image_NT_None;
-		}
-  } while (src->nextType != Image_NT_None);
-
+	ASSERT(TinyImageFormat_ChannelCount(src->format) == 4);
+	ASSERT(TinyImageFormat_ChannelCount(newFormat) == 4);
+
+	// Fast path for RGBA8->BGRA8 (just swizzle)
+	ConvertChain(src, newFormat, dest, [](Image_ImageHeader const *s, Image_ImageHeader *d) {
+		Image::SwizzleRGBA8ToBGRA8((uint8_t const *) Image_RawDataPtr(s),
+															 (uint8_t *) Image_RawDataPtr(d),
+															 Image_PixelCountOf(s));
+	});
 }
 DefineOutOfPlaceConvert(R8G8B8A8ToB8G8R8A8)
 
+template<ImageConvertFunc func>
+bool OutOfPlaceConvert(Image_ImageHeader const*src, TinyImageFormat newFormat, Image_ImageHeader const**dst) {
+	*dst = CloneStructureAs(src, newFormat);
+	if (!*dst) { return false; }
+	func(src, newFormat, *dst);
+	return true;
+}
+
+// pixels converted per block when the channel count changes and the row
+// goes via a small stack buffer
+uint32_t const ChannelRepackBlockSize = 256;
+
+// copies N1 channel pixels to N2 channel pixels, missing channels get 0
+// except alpha which gets 1 (the same rules as decoding a logical pixel)
+template<uint32_t N1, uint32_t N2, typename T>
+void RepackChannels(T const *src, T *dst, size_t pixelCount, T zero, T one) {
+	while (pixelCount--) {
+		for (uint32_t i = 0; i < N2; ++i) {
+			dst[i] = (i < N1) ? src[i] : ((i == 3) ? one : zero);
+		}
+		src += N1;
+		dst += N2;
+	}
+}
+
+template<uint32_t N1, uint32_t N2>
 void HalfNToFloatN(Image_ImageHeader const*src, TinyImageFormat newFormat, Image_ImageHeader const*dest) {
-	auto dst = (Image_ImageHeader*)dest;
-  do {
-    // Fast path for half->float
-    uint16_t const *sdata = (uint16_t *) Image_RawDataPtr(src);
-    float *ddata = (float *) Image_RawDataPtr(dst);
-    size_t nPixels = Image_PixelCountOf(src);
-    do {
-      uint32_t i = 0;
-      for (i = 0; i < TinyImageFormat_ChannelCount(src->format); i++) {
-        ddata[i] = Math_Half2Float(sdata[i]);
-      }
-
-      for (i = 0; i < TinyImageFormat_ChannelCount(newFormat); i++) {
-        ddata[i] = 0.0f;
-      }
-
-      if (TinyImageFormat_ChannelCount(newFormat) == 4 &&
-          TinyImageFormat_ChannelCount(src->format) < 4) {
-        ddata[i] = 1.0f;
-      }
-
-      sdata += sizeof(uint16_t) * TinyImageFormat_ChannelCount(src->format);
-      ddata += sizeof(float) * TinyImageFormat_ChannelCount(newFormat);
-    } while (--nPixels);
-
-		if (src->nextType != Image_NT_None) {
-			dst->nextType = src->nextType;
-			src = src->nextImage;
-			dst = (Image_ImageHeader*)dst->nextImage;
-		} else {
-			if(dst->nextType != Image_NT_None) Image_Destroy(dst->nextImage);
-			dst->nextType = Image_NT_None;
-		}
-  } while (src->nextType != Image_NT_None);
+	ASSERT(TinyImageFormat_ChannelCount(src->format) == N1);
+	ASSERT(TinyImageFormat_ChannelCount(newFormat) == N2);
+
+	// Fast path for half->float
+	ConvertChain(src, newFormat, dest, [](Image_ImageHeader const *s, Image_ImageHeader *d) {
+		auto sdata = (uint16_t const *) Image_RawDataPtr(s);
+		auto ddata = (float *) Image_RawDataPtr(d);
+		size_t const nPixels = Image_PixelCountOf(s);
+		if (N1 == N2) {
+			Image::HalfToFloat(sdata, ddata, nPixels * N1);
+			return;
+		}
 
+		float buffer[ChannelRepackBlockSize * N1];
+		for (size_t i = 0; i < nPixels; i += ChannelRepackBlockSize) {
+			size_t const count = (nPixels - i) < ChannelRepackBlockSize ? (nPixels - i) : ChannelRepackBlockSize;
+			Image::HalfToFloat(sdata + i * N1, buffer, count * N1);
+			RepackChannels<N1, N2>(buffer, ddata + i * N2, count, 0.0f, 1.0f);
+		}
+	});
 }
-DefineOutOfPlaceConvert(HalfNToFloatN)
 
+template<uint32_t N1, uint32_t N2>
 void FloatNToHalfN(Image_ImageHeader const*src, TinyImageFormat newFormat, Image_ImageHeader const*dest) {
-	auto dst = (Image_ImageHeader*)dest;
-  do {
-    // Fast path for float->half
-		auto sdata = (float const *) Image_RawDataPtr(src);
-		auto ddata = (uint16_t *) Image_RawDataPtr(dst);
-    size_t nPixels = Image_PixelCountOf(src);
-    do {
-      uint32_t i = 0;
-      for (i = 0; i < TinyImageFormat_ChannelCount(src->format); i++) {
-        ddata[i] = Math_Float2Half(sdata[i]);
-      }
-
-      for (i = 0; i < TinyImageFormat_ChannelCount(newFormat); i++) {
-        ddata[i] = Math_Float2Half(0.0f);
-      }
-      if (TinyImageFormat_ChannelCount(newFormat) == 4 &&
-          TinyImageFormat_ChannelCount(src->format) < 4) {
-        ddata[i] = Math_Float2Half(1.0f);
-      }
-
-      sdata += sizeof(uint16_t) * TinyImageFormat_ChannelCount(src->format);
-      ddata += sizeof(float) * TinyImageFormat_ChannelCount(newFormat);
-    } while (--nPixels);
-
-    if (src->nextType != Image_NT_None) {
-			dst->nextType = src->nextType;
-      src = src->nextImage;
-      dst = (Image_ImageHeader*)dst->nextImage;
-    } else {
-    	if(dst->nextType != Image_NT_None) Image_Destroy(dst->nextImage);
-			dst->nextType = Image_NT_None;
-		}
-  } while (src->nextType != Image_NT_None);
+	ASSERT(TinyImageFormat_ChannelCount(src->format) == N1);
+	ASSERT(TinyImageFormat_ChannelCount(newFormat) == N2);
+
+	// Fast path for float->half
+	ConvertChain(src, newFormat, dest, [](Image_ImageHeader const *s, Image_ImageHeader *d) {
+		auto sdata = (float const *) Image_RawDataPtr(s);
+		auto ddata = (uint16_t *) Image_RawDataPtr(d);
+		size_t const nPixels = Image_PixelCountOf(s);
+		if (N1 == N2) {
+			Image::FloatToHalf(sdata, ddata, nPixels * N1);
+			return;
+		}
+
+		float buffer[ChannelRepackBlockSize * N2];
+		for (size_t i = 0; i < nPixels; i += ChannelRepackBlockSize) {
+			size_t const count = (nPixels - i) < ChannelRepackBlockSize ? (nPixels - i) : ChannelRepackBlockSize;
+			RepackChannels<N1, N2>(sdata + i * N1, buffer, count, 0.0f, 1.0f);
+			Image::FloatToHalf(buffer, ddata + i * N2, count * N2);
+		}
+	});
+}
+
+void PlainChainConvert(Image::PlainConverter const &converter, Image_ImageHeader const *src, TinyImageFormat newFormat,
+											 Image_ImageHeader const *dest) {
+	ConvertChain(src, newFormat, dest, [&converter](Image_ImageHeader const *s, Image_ImageHeader *d) {
+		Image::ConvertPlainPixels(converter, Image_RawDataPtr(s), Image_RawDataPtr(d), Image_PixelCountOf(s));
+	});
+}
+
+// any other pair of plain formats, through the converter matrix loops
+void PlainImageConvert(Image_ImageHeader const*src, TinyImageFormat newFormat, Image_ImageHeader const*dest) {
+	Image::PlainConverter converter;
+	bool const found = Image::PlainConverterOf(src->format, newFormat, converter);
+	ASSERT(found);
+	(void) found;
+	PlainChainConvert(converter, src, newFormat, dest);
 }
-DefineOutOfPlaceConvert(FloatNToHalfN)
-
-#define IntegerTypeNToFloatN(t, n1, n2) \
-void t##ToFloat_##n1##_##n2(Image_ImageHeader const*src, TinyImageFormat newFormat, Image_ImageHeader const * dest) { \
-	auto dst = (Image_ImageHeader*)dest;\
-  do { \
-    auto sdata = (t const*) Image_RawDataPtr(src); \
-    auto ddata = (float*) Image_RawDataPtr(dst); \
-    size_t nPixels = Image_PixelCountOf(src); \
-    do { \
-      int i = 0; \
-      for (i = 0; i < n1; i++) { \
-        ddata[i] = (float)(sdata[i]); \
-      } \
-      for (i = 0; i < n2; i++) { \
-        ddata[i] = 0.0f; \
-      } \
-      if(n1 == 4 && n2 < 4) { \
-        ddata[i] = 1.0f; \
-      } \
-      sdata += sizeof(t) * n1; \
-      ddata += sizeof(float) * n2; \
-    } \
-    while (--nPixels); \
-		if (src->nextType != Image_NT_None) { \
-			dst->nextType = src->nextType; \
-			src = src->nextImage; \
-			dst = (Image_ImageHeader*)dst->nextImage; \
-		} else { \
-			if(dst->nextType != Image_NT_None) Image_Destroy(dst->nextImage); \
-			dst->nextType = Image_NT_None; \
-		} \
-	} while (src->nextType != Image_NT_None);\
-} \
-DefineOutOfPlaceConvert(t##ToFloat_##n1##_##n2)
-
-#define IntegerTypeToFloat(t) \
-  IntegerTypeNToFloatN(t, 1, 1) \
-  IntegerTypeNToFloatN(t, 1, 2) \
-  IntegerTypeNToFloatN(t, 1, 3) \
-  IntegerTypeNToFloatN(t, 1, 4) \
-  IntegerTypeNToFloatN(t, 2, 1) \
-  IntegerTypeNToFloatN(t, 2, 2) \
-  IntegerTypeNToFloatN(t, 2, 3) \
-  IntegerTypeNToFloatN(t, 2, 4) \
-  IntegerTypeNToFloatN(t, 3, 1) \
-  IntegerTypeNToFloatN(t, 3, 2) \
-  IntegerTypeNToFloatN(t, 3, 3) \
-  IntegerTypeNToFloatN(t, 3, 4) \
-  IntegerTypeNToFloatN(t, 4, 1) \
-  IntegerTypeNToFloatN(t, 4, 2) \
-  IntegerTypeNToFloatN(t, 4, 3) \
-  IntegerTypeNToFloatN(t, 4, 4)
-
-IntegerTypeToFloat(uint8_t);
-IntegerTypeToFloat(uint16_t);
-IntegerTypeToFloat(uint32_t);
-IntegerTypeToFloat(int8_t);
-IntegerTypeToFloat(int16_t);
-IntegerTypeToFloat(int32_t);
 
 #undef DefineOutOfPlaceConvert
-#undef IntegerTypeNToFloatN
-#undef IntegerTypeToFloat
-
-bool g_imageConvertTablesBuild = false;
-bool g_imageConvertCanInPlace[TinyImageFormat_Count][TinyImageFormat_Count];
-ImageConvertFunc g_imageConvertDDTable[TinyImageFormat_Count][TinyImageFormat_Count];
-ImageConvertOutOfPlaceFunc g_imageConvertOutOfPlaceDDTable[TinyImageFormat_Count][TinyImageFormat_Count];
-
-void BuildImageConvertTables() {
-  for (auto i = 0u; i < (unsigned int)TinyImageFormat_Count; ++i) {
-    for (auto j = 0u; j < (unsigned int)TinyImageFormat_Count; ++j) {
-      g_imageConvertCanInPlace[i][j] = false;
-      g_imageConvertDDTable[i][j] = &SlowImageConvert;
-      g_imageConvertOutOfPlaceDDTable[i][j] = &SlowImageConvertOutOfPlace;
-    }
-  }
 
-#define FDT(s, d, f, i) \
-  g_imageConvertDDTable[TinyImageFormat_##s][TinyImageFormat_##d] = f; \
-  g_imageConvertOutOfPlaceDDTable[TinyImageFormat_##s][TinyImageFormat_##d] = f##OutOfPlace; \
-  g_imageConvertCanInPlace[TinyImageFormat_##s][TinyImageFormat_##d] = i;
-
-#define FDT_SET(s, d, f, i) \
-  FDT(s##_UNORM, d##_UNORM, f, i); \
-  FDT(s##_SNORM, d##_SNORM, f, i); \
-  FDT(s##_UINT, d##_UINT, f, i); \
-  FDT(s##_SINT, d##_SINT, f, i); \
-  FDT(s##_SRGB, d##_SRGB, f, i);
-
-#define FDT_ITOF(t, s, d, n1, n2, inplace) \
-  g_imageConvertDDTable[TinyImageFormat_##s][TinyImageFormat_##d] = &t##ToFloat_##n1##_##n2; \
-  g_imageConvertOutOfPlaceDDTable[TinyImageFormat_##s][TinyImageFormat_##d] = &t##ToFloat_##n1##_##n2##OutOfPlace; \
-  g_imageConvertCanInPlace[TinyImageFormat_##s][TinyImageFormat_##d] = (inplace);
-
-#define FDT_ITOF_SET(t, s, d, n1, n2, w) \
-  FDT_ITOF(t, s##_UNORM, d##_SFLOAT, n1, n2, (w*n1) <= (32*n2)) \
-  FDT_ITOF(t, s##_SNORM, d##_SFLOAT, n1, n2, (w*n1) <= (32*n2)) \
-  FDT_ITOF(t, s##_UINT, d##_SFLOAT, n1, n2, (w*n1) <= (32*n2)) \
-  FDT_ITOF(t, s##_SINT, d##_SFLOAT, n1, n2, (w*n1) <= (32*n2)) \
-
-#define FDT_ITOF_WIDTH_SET(w) \
-  FDT_ITOF_SET(uint##w##_t, R##w, R32, 1, 1, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w##G##w, R32, 2, 1, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w##G##w##B##w, R32, 3, 1, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w##G##w##B##w##A##w, R32, 4, 1, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w, R32G32, 1, 2, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w##G##w, R32G32, 2, 2, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w##G##w##B##w, R32G32 , 3, 2, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w##G##w##B##w##A##w, R32G32, 4, 2, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w, R32G32B32, 1, 3, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w##G##w, R32G32B32, 2, 3, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w##G##w##B##w, R32G32B32, 3, 3, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w##G##w##B##w##A##w, R32G32B32, 4, 3, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w, R32G32B32A32, 1, 4, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w##G##w, R32G32B32A32, 2, 4, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w##G##w##B##w, R32G32B32A32, 3, 4, w) \
-  FDT_ITOF_SET(uint##w##_t, R##w##G##w##B##w##A##w, R32G32B32A32, 4, 4, w) \
-  FDT_ITOF_SET(int##w##_t, R##w, R32, 1, 1, w) \
-  FDT_ITOF_SET(int##w##_t, R##w##G##w, R32, 2, 1, w) \
-  FDT_ITOF_SET(int##w##_t, R##w##G##w##B##w, R32, 3, 1, w) \
-  FDT_ITOF_SET(int##w##_t, R##w##G##w##B##w##A##w, R32, 4, 1, w) \
-  FDT_ITOF_SET(int##w##_t, R##w, R32G32, 1, 2, w) \
-  FDT_ITOF_SET(int##w##_t, R##w##G##w, R32G32, 2, 2, w) \
-  FDT_ITOF_SET(int##w##_t, R##w##G##w##B##w, R32G32 , 3, 2, w) \
-  FDT_ITOF_SET(int##w##_t, R##w##G##w##B##w##A##w, R32G32, 4, 2, w) \
-  FDT_ITOF_SET(int##w##_t, R##w, R32G32B32, 1, 3, w) \
-  FDT_ITOF_SET(int##w##_t, R##w##G##w, R32G32B32, 2, 3, w) \
-  FDT_ITOF_SET(int##w##_t, R##w##G##w##B##w, R32G32B32, 3, 3, w) \
-  FDT_ITOF_SET(int##w##_t, R##w##G##w##B##w##A##w, R32G32B32, 4, 3, w) \
-  FDT_ITOF_SET(int##w##_t, R##w, R32G32B32A32, 1, 4, w) \
-  FDT_ITOF_SET(int##w##_t, R##w##G##w, R32G32B32A32, 2, 4, w) \
-  FDT_ITOF_SET(int##w##_t, R##w##G##w##B##w, R32G32B32A32, 3, 4, w) \
-  FDT_ITOF_SET(int##w##_t, R##w##G##w##B##w##A##w, R32G32B32A32, 4, 4, w)
-
-  FDT_ITOF_WIDTH_SET(8);
-  FDT_ITOF_WIDTH_SET(16);
+// the converters for one pair of formats
+struct ConvertDispatch {
+	TinyImageFormat src;
+	TinyImageFormat dst;
+	ImageConvertFunc convert;
+	ImageConvertOutOfPlaceFunc convertOutOfPlace;
+	bool canInPlace;
+	Image_ConvertKernel kernel;
+	// estimated cost in rough cycles per pixel
+	float cost;
+};
+
+#define FDT(s, d, f, i, c) \
+  {TinyImageFormat_##s, TinyImageFormat_##d, &f, &f##OutOfPlace, i, Image_CK_Fast, c},
+
+#define FDT_SET(s, d, f, i, c) \
+  FDT(s##_UNORM, d##_UNORM, f, i, c) \
+  FDT(s##_SNORM, d##_SNORM, f, i, c) \
+  FDT(s##_UINT, d##_UINT, f, i, c) \
+  FDT(s##_SINT, d##_SINT, f, i, c) \
+  FDT(s##_SRGB, d##_SRGB, f, i, c)
+
+// half <-> float both ways for a half format with nh channels and a float
+// format with nf channels, the float is always larger so never in place
+#define FDT_HALF_FLOAT(h, f, nh, nf) \
+  {TinyImageFormat_##h##_SFLOAT, TinyImageFormat_##f##_SFLOAT, \
+   &HalfNToFloatN<nh, nf>, &OutOfPlaceConvert<&HalfNToFloatN<nh, nf>>, false, \
+   Image_CK_Fast, HalfFloatCostOf(nh, nf)}, \
+  {TinyImageFormat_##f##_SFLOAT, TinyImageFormat_##h##_SFLOAT, \
+   &FloatNToHalfN<nf, nh>, &OutOfPlaceConvert<&FloatNToHalfN<nf, nh>>, false, \
+   Image_CK_Fast, HalfFloatCostOf(nh, nf)},
+
+// the SIMD half kernels and repacking channels through the stack buffer
+constexpr float HalfFloatCostOf(uint32_t nh, uint32_t nf) {
+	return 0.25f * (float) (nh > nf ? nh : nf) + (nh == nf ? 0.0f : 1.0f);
+}
 
+// the pairs with their own kernels. Every other pair is worked out per call,
+// plain formats by the converter matrix and the rest by decoding, so there is
+// no table to build on first use (or to race building) and nothing in .bss
+constexpr ConvertDispatch FastConverters[] = {
+  FDT_SET(R8G8B8, R8G8B8A8, R8G8B8ToR8B8G8A8, false, 0.5f)
+  FDT_SET(B8G8R8, B8G8R8A8, R8G8B8ToR8B8G8A8, false, 0.5f)
+  FDT_SET(R8G8B8A8, B8G8R8A8, R8G8B8A8ToB8G8R8A8, true, 0.25f)
+  FDT_SET(B8G8R8A8, R8G8B8A8, R8G8B8A8ToB8G8R8A8, true, 0.25f)
+
+  FDT_HALF_FLOAT(R16, R32, 1, 1)
+  FDT_HALF_FLOAT(R16, R32G32, 1, 2)
+  FDT_HALF_FLOAT(R16, R32G32B32, 1, 3)
+  FDT_HALF_FLOAT(R16, R32G32B32A32, 1, 4)
+  FDT_HALF_FLOAT(R16G16, R32, 2, 1)
+  FDT_HALF_FLOAT(R16G16, R32G32, 2, 2)
+  FDT_HALF_FLOAT(R16G16, R32G32B32, 2, 3)
+  FDT_HALF_FLOAT(R16G16, R32G32B32A32, 2, 4)
+  FDT_HALF_FLOAT(R16G16B16, R32, 3, 1)
+  FDT_HALF_FLOAT(R16G16B16, R32G32, 3, 2)
+  FDT_HALF_FLOAT(R16G16B16, R32G32B32, 3, 3)
+  FDT_HALF_FLOAT(R16G16B16, R32G32B32A32, 3, 4)
+  FDT_HALF_FLOAT(R16G16B16A16, R32, 4, 1)
+  FDT_HALF_FLOAT(R16G16B16A16, R32G32, 4, 2)
+  FDT_HALF_FLOAT(R16G16B16A16, R32G32B32, 4, 3)
+  FDT_HALF_FLOAT(R16G16B16A16, R32G32B32A32, 4, 4)
+};
 
 /* TODO
 *(uint32_t *)dest = Math_FloatRGBToRGBE8(rgba[0], rgba[1], rgba[2]);
@@ -341,13 +301,272 @@ destSize;
 } while (--nPixels);
 }*/
 
-#undef FDT_ITOF_WIDTH_SET
-#undef FDT_ITOF_SET
-#undef FDT_ITOF
+#undef FDT_HALF_FLOAT
 #undef FDT_SET
 #undef FDT
 
-  g_imageConvertTablesBuild = true;
+// the per pixel decode and encode of tinyimageformat
+float const DecodeCostPerPixel = 40.0f;
+// extra cost of writing a new image instead of converting in place, per byte
+// of a destination pixel
+float const NewImageCostPerByte = 0.25f;
+
+ConvertDispatch ConvertDispatchOf(TinyImageFormat src, TinyImageFormat dst) {
+	for (ConvertDispatch const &fast : FastConverters) {
+		if (fast.src == src && fast.dst == dst) {
+			return fast;
+		}
+	}
+
+	// pixels the same size can be converted in place
+	Image::PlainConverter converter;
+	if (Image::PlainConverterOf(src, dst, converter)) {
+		return {src, dst, &PlainImageConvert, &OutOfPlaceConvert<&PlainImageConvert>,
+						converter.srcPixelSize == converter.dstPixelSize, Image_CK_Matrix, converter.cost};
+	}
+	return {src, dst, &SlowImageConvert, &SlowImageConvertOutOfPlace, false, Image_CK_Decode, DecodeCostPerPixel};
+}
+
+Image_ConvertStep StepOf(ConvertDispatch const &dispatch, bool allowInPlace) {
+	Image_ConvertStep step;
+	step.from = dispatch.src;
+	step.to = dispatch.dst;
+	step.kernel = dispatch.kernel;
+	step.inPlace = allowInPlace && dispatch.canInPlace;
+	step.cost = dispatch.cost;
+	if (!step.inPlace) {
+		float const pixelBits = (float) TinyImageFormat_BitSizeOfBlock(dispatch.dst) /
+				(float) TinyImageFormat_PixelCountOfBlock(dispatch.dst);
+		step.cost += NewImageCostPerByte * pixelBits / 8.0f;
+	}
+	return step;
+}
+
+// a format and the cheapest run of hand written kernels from the source to
+// it (or from it to the destination)
+struct FastRoute {
+	TinyImageFormat format;
+	float cost;
+	bool done;
+	uint32_t stepCount;
+	Image_ConvertStep steps[Image_ConvertPlanMaxStepCount];
+};
+
+size_t const FastConverterCount = sizeof(FastConverters) / sizeof(FastConverters[0]);
+size_t const MaxFastRouteCount = FastConverterCount + 1;
+
+FastRoute *FindOrAddRoute(FastRoute *routes, size_t &routeCount, TinyImageFormat format) {
+	for (size_t i = 0; i < routeCount; ++i) {
+		if (routes[i].format == format) {
+			return &routes[i];
+		}
+	}
+	ASSERT(routeCount < MaxFastRouteCount);
+	FastRoute &route = routes[routeCount++];
+	route.format = format;
+	route.cost = FLT_MAX;
+	route.done = false;
+	route.stepCount = 0;
+	return &route;
+}
+
+// Dijkstra over the fast kernels, forwards from format or backwards to it. Only
+// the first step forward works on the source so only it needs allowInPlace.
+// Every format but the source and destination must lose nothing on the way
+// (see PlainIntermediateHolds) for a destination of channelCount channels
+size_t FastRoutesOf(TinyImageFormat format, bool forwards, bool allowInPlace, uint32_t channelCount,
+										TinyImageFormat destination, FastRoute *routes) {
+	size_t routeCount = 0;
+	FindOrAddRoute(routes, routeCount, format)->cost = 0.0f;
+	while (true) {
+		FastRoute *next = nullptr;
+		for (size_t i = 0; i < routeCount; ++i) {
+			if (!routes[i].done && (next == nullptr || routes[i].cost < next->cost)) {
+				next = &routes[i];
+			}
+		}
+		if (next == nullptr) {
+			break;
+		}
+		next->done = true;
+		FastRoute const from = *next;
+		if (from.stepCount == Image_ConvertPlanMaxStepCount - 1 || (forwards && from.format == destination)) {
+			continue;
+		}
+
+		for (ConvertDispatch const &fast : FastConverters) {
+			if ((forwards ? fast.src : fast.dst) != from.format) {
+				continue;
+			}
+			bool const holds = forwards ?
+					(fast.dst == destination || Image::PlainIntermediateHolds(fast.src, fast.dst, channelCount)) :
+					(from.stepCount == 0 || Image::PlainIntermediateHolds(fast.src, fast.dst, channelCount));
+			if (!holds) {
+				continue;
+			}
+			Image_ConvertStep const step = StepOf(fast, !forwards || from.stepCount > 0 || allowInPlace);
+			FastRoute *to = FindOrAddRoute(routes, routeCount, forwards ? fast.dst : fast.src);
+			if (to->done || from.cost + step.cost >= to->cost) {
+				continue;
+			}
+			to->cost = from.cost + step.cost;
+			to->stepCount = from.stepCount + 1;
+			if (forwards) {
+				memcpy(to->steps, from.steps, from.stepCount * sizeof(Image_ConvertStep));
+				to->steps[from.stepCount] = step;
+			} else {
+				to->steps[0] = step;
+				memcpy(to->steps + 1, from.steps, from.stepCount * sizeof(Image_ConvertStep));
+			}
+		}
+	}
+	return routeCount;
+}
+
+void AppendSteps(Image_ConvertPlan *plan, Image_ConvertStep const *steps, uint32_t stepCount) {
+	for (uint32_t i = 0; i < stepCount; ++i) {
+		plan->steps[plan->stepCount++] = steps[i];
+		plan->cost += steps[i].cost;
+	}
+}
+
+// a plan shared by the jobs of a batch with the same formats (and whether
+// they may convert in place), with the kernel of each step looked up once
+struct BatchPlan {
+	TinyImageFormat from;
+	TinyImageFormat to;
+	bool allowInPlace;
+	Image_ConvertPlan plan;
+	ConvertDispatch dispatches[Image_ConvertPlanMaxStepCount];
+	Image::PlainConverter converters[Image_ConvertPlanMaxStepCount];
+};
+
+// a batch has few distinct pairs so a linear search beats hashing
+size_t BatchPlanIndexOf(std::vector<BatchPlan> &plans, TinyImageFormat from, TinyImageFormat to, bool allowInPlace) {
+	for (size_t i = 0; i < plans.size(); ++i) {
+		if (plans[i].from == from && plans[i].to == to && plans[i].allowInPlace == allowInPlace) {
+			return i;
+		}
+	}
+	plans.emplace_back();
+	BatchPlan &batchPlan = plans.back();
+	batchPlan.from = from;
+	batchPlan.to = to;
+	batchPlan.allowInPlace = allowInPlace;
+	Image_PlanFastConvert(from, to, allowInPlace, &batchPlan.plan);
+	for (uint32_t i = 0; i < batchPlan.plan.stepCount; ++i) {
+		Image_ConvertStep const &step = batchPlan.plan.steps[i];
+		batchPlan.dispatches[i] = ConvertDispatchOf(step.from, step.to);
+		if (step.kernel == Image_CK_Matrix) {
+			bool const found = Image::PlainConverterOf(step.from, step.to, batchPlan.converters[i]);
+			ASSERT(found);
+			(void) found;
+		}
+	}
+	return plans.size() - 1;
+}
+
+void RunBatchStep(BatchPlan const &batchPlan, uint32_t stepIndex, Image_ImageHeader const *src,
+									Image_ImageHeader const *dst) {
+	TinyImageFormat const to = batchPlan.plan.steps[stepIndex].to;
+	if (batchPlan.plan.steps[stepIndex].kernel == Image_CK_Matrix) {
+		PlainChainConvert(batchPlan.converters[stepIndex], src, to, dst);
+	} else {
+		batchPlan.dispatches[stepIndex].convert(src, to, dst);
+	}
+}
+
+uint32_t const NoStep = ~0u;
+
+// the step that writes the result, any after it are in place on the result.
+// NoStep if every step is in place on the source
+uint32_t LastOutOfPlaceStepOf(Image_ConvertPlan const &plan) {
+	uint32_t last = NoStep;
+	for (uint32_t i = 0; i < plan.stepCount; ++i) {
+		if (!plan.steps[i].inPlace) {
+			last = i;
+		}
+	}
+	return last;
+}
+
+// the steps of one job, the last out of place one into its result made up
+// front. false if an intermediate image couldn't be made
+bool RunBatchJob(BatchPlan const &batchPlan, Image_ImageHeader const *src, Image_ImageHeader const *result) {
+	uint32_t const stepCount = batchPlan.plan.stepCount;
+	uint32_t const resultStep = LastOutOfPlaceStepOf(batchPlan.plan);
+	Image_ImageHeader const *image = src;
+	for (uint32_t i = 0; i < stepCount; ++i) {
+		Image_ConvertStep const &step = batchPlan.plan.steps[i];
+		if (step.inPlace) {
+			RunBatchStep(batchPlan, i, image, image);
+			continue;
+		}
+		Image_ImageHeader const *next = (i == resultStep) ? result : CloneStructureAs(image, step.to);
+		if (next == nullptr) {
+			if (image != src) {
+				Image_Destroy(image);
+			}
+			return false;
+		}
+		RunBatchStep(batchPlan, i, image, next);
+		if (image != src) {
+			Image_Destroy(image);
+		}
+		image = next;
+	}
+	return true;
+}
+
+// the link below link, nullptr at the end of the chain
+Image_ImageHeader const *NextLinkOf(Image_ImageHeader const *link) {
+	return link->nextType != Image_NT_None ? link->nextImage : nullptr;
+}
+
+// CloneStructureAs for every job that needs a result, all carved from one
+// allocation so a batch of small images costs one allocator call. False,
+// with no result made, if it couldn't be
+bool MakeBatchResults(Image_ConvertJob *jobs, size_t jobCount, std::vector<bool> const &needsResult) {
+	std::vector<size_t> byteCounts;
+	for (size_t j = 0; j < jobCount; ++j) {
+		if (!needsResult[j]) {
+			continue;
+		}
+		for (Image_ImageHeader const *link = jobs[j].image; link; link = NextLinkOf(link)) {
+			Image_ImageHeader header;
+			Image_FillHeader(link->width, link->height, link->depth, link->slices, jobs[j].format, &header);
+			byteCounts.push_back(header.dataSize);
+		}
+	}
+	if (byteCounts.empty()) {
+		return true;
+	}
+	std::vector<Image_ImageHeader *> images(byteCounts.size());
+	if (!Image::AllocateImageGroup(byteCounts.size(), byteCounts.data(), images.data())) {
+		return false;
+	}
+
+	size_t next = 0;
+	for (size_t j = 0; j < jobCount; ++j) {
+		if (!needsResult[j]) {
+			continue;
+		}
+		Image_ImageHeader *previous = nullptr;
+		for (Image_ImageHeader const *link = jobs[j].image; link; link = NextLinkOf(link)) {
+			Image_ImageHeader *dst = images[next++];
+			Image_FillHeader(link->width, link->height, link->depth, link->slices, jobs[j].format, dst);
+			Image::InheritLayout(link, dst);
+			if (previous) {
+				previous->nextImage = dst;
+			} else {
+				jobs[j].result = dst;
+			}
+			// nextImage is set by the next link
+			dst->nextType = NextLinkOf(link) ? link->nextType : Image_NT_None;
+			previous = dst;
+		}
+	}
+	return true;
 }
 
 } // end anon namespace
@@ -359,19 +578,174 @@ AL2O3_EXTERN_C Image_ImageHeader const * Image_FastConvert(Image_ImageHeader con
     return src;
   }
 
-  if (!g_imageConvertTablesBuild) {
-    BuildImageConvertTables();
+  // other references would see a shared image change under them and read
+  // only mappings can't be written
+  Image_ConvertPlan plan;
+  Image_PlanFastConvert(src->format, newFormat, allowInPlace && !Image_IsReadOnly(src), &plan);
+
+  // a chain converted in place keeps its directory, one converted out of place
+  // is built here so gets one
+  bool const recorded = Image::LevelDirectoryOf(src) != nullptr;
+
+  // intermediate images are ours so every step but the first may be in place
+  Image_ImageHeader const *image = src;
+  for (uint32_t i = 0; i < plan.stepCount; ++i) {
+    Image_ConvertStep const &step = plan.steps[i];
+    ConvertDispatch const dispatch = ConvertDispatchOf(step.from, step.to);
+    if (step.inPlace) {
+      dispatch.convert(image, step.to, image);
+      continue;
+    }
+    Image_ImageHeader const *next = nullptr;
+    bool const ret = dispatch.convertOutOfPlace(image, step.to, &next);
+    if (image != src) {
+      Image_Destroy(image);
+    }
+    if (!ret) { return nullptr; }
+    image = next;
   }
-
-  if (allowInPlace && g_imageConvertCanInPlace[src->format][newFormat]) {
-    g_imageConvertDDTable[src->format][newFormat](src, newFormat, src);
-    return src;
-  } else {
-    Image_ImageHeader const *dst;
-    bool ret = g_imageConvertOutOfPlaceDDTable[src->format][newFormat](src, newFormat, &dst);
-    if (ret) { return dst; }
-    else { return nullptr; }
+  if (image != src || recorded) {
+    Image::RecordLevelDirectory(image);
   }
+  return image;
 }
 
+AL2O3_EXTERN_C void Image_PlanFastConvert(TinyImageFormat from, TinyImageFormat to, bool allowInPlace,
+																					Image_ConvertPlan *plan) {
+	ASSERT(plan);
+	plan->stepCount = 0;
+	plan->cost = 0.0f;
+	if (from == to) {
+		if (!allowInPlace) {
+			Image_ConvertStep const copy = StepOf(ConvertDispatchOf(from, to), false);
+			AppendSteps(plan, &copy, 1);
+		}
+		return;
+	}
+
+	// the cheapest of hand written kernels from the source to some format,
+	// one step of any kernel to another, and hand written kernels from there to
+	// the destination. A route of only hand written kernels ends at the
+	// destination itself
+	FastRoute forwards[MaxFastRouteCount];
+	FastRoute backwards[MaxFastRouteCount];
+	uint32_t const channelCount = TinyImageFormat_ChannelCount(to);
+	size_t const forwardCount = FastRoutesOf(from, true, allowInPlace, channelCount, to, forwards);
+	size_t const backwardCount = FastRoutesOf(to, false, allowInPlace, channelCount, to, backwards);
+
+	float bestCost = FLT_MAX;
+	FastRoute const *bestHead = nullptr;
+	FastRoute const *bestTail = nullptr;
+	Image_ConvertStep bestMiddle{};
+	for (size_t f = 0; f < forwardCount; ++f) {
+		FastRoute const &head = forwards[f];
+		if (head.cost == FLT_MAX) {
+			continue;
+		}
+		if (head.format == to) {
+			if (head.cost < bestCost) {
+				bestCost = head.cost;
+				bestHead = &head;
+				bestTail = nullptr;
+			}
+			continue;
+		}
+		for (size_t b = 0; b < backwardCount; ++b) {
+			FastRoute const &tail = backwards[b];
+			if (tail.cost == FLT_MAX || tail.format == head.format ||
+					head.stepCount + 1 + tail.stepCount > Image_ConvertPlanMaxStepCount ||
+					(tail.stepCount > 0 && !Image::PlainIntermediateHolds(head.format, tail.format, channelCount))) {
+				continue;
+			}
+			Image_ConvertStep const middle = StepOf(ConvertDispatchOf(head.format, tail.format),
+																							head.stepCount > 0 || allowInPlace);
+			float const cost = head.cost + middle.cost + tail.cost;
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestHead = &head;
+				bestTail = &tail;
+				bestMiddle = middle;
+			}
+		}
+	}
+
+	ASSERT(bestHead);
+	AppendSteps(plan, bestHead->steps, bestHead->stepCount);
+	if (bestTail) {
+		AppendSteps(plan, &bestMiddle, 1);
+		AppendSteps(plan, bestTail->steps, bestTail->stepCount);
+	}
+
+	// the source is either converted in place or left alone, so a first step in
+	// place is only kept if every step is
+	for (uint32_t i = 1; i < plan->stepCount; ++i) {
+		if (plan->steps[0].inPlace && !plan->steps[i].inPlace) {
+			plan->cost -= plan->steps[0].cost;
+			plan->steps[0] = StepOf(ConvertDispatchOf(plan->steps[0].from, plan->steps[0].to), false);
+			plan->cost += plan->steps[0].cost;
+		}
+	}
+}
+
+
 
+AL2O3_EXTERN_C bool Image_FastConvertBatch(Image_ConvertJob *jobs, size_t jobCount, bool allowInPlace,
+																					 uint32_t threadCount) {
+	ASSERT(jobs || jobCount == 0);
+
+	// plans once per pair and every result made here from one allocation of
+	// this threads allocator, before any work is handed out
+	std::vector<BatchPlan> plans;
+	std::vector<size_t> planOfJob(jobCount);
+	std::vector<bool> recorded(jobCount);
+	std::vector<bool> needsResult(jobCount);
+	for (size_t j = 0; j < jobCount; ++j) {
+		Image_ConvertJob &job = jobs[j];
+		ASSERT(job.image);
+		recorded[j] = Image::LevelDirectoryOf(job.image) != nullptr;
+		planOfJob[j] = BatchPlanIndexOf(plans, job.image->format, job.format, allowInPlace && !Image_IsReadOnly(job.image));
+		job.result = job.image;
+		needsResult[j] = LastOutOfPlaceStepOf(plans[planOfJob[j]].plan) != NoStep;
+	}
+
+	// without one allocation big enough for all of them each gets its own
+	bool ok = true;
+	if (!MakeBatchResults(jobs, jobCount, needsResult)) {
+		for (size_t j = 0; j < jobCount; ++j) {
+			if (needsResult[j]) {
+				jobs[j].result = CloneStructureAs(jobs[j].image, jobs[j].format);
+				ok = ok && jobs[j].result != nullptr;
+			}
+		}
+	}
+
+	// intermediate images come from the same allocator as the results
+	Image_Allocator *const allocator = Image_GetThreadAllocator();
+	size_t const alignment = Image_GetThreadDataAlignment();
+	std::atomic<bool> failed(false);
+	Image::ParallelFor(Image::ResolveThreadCount(threadCount), jobCount, [&](size_t j, uint32_t) {
+		Image_ConvertJob &job = jobs[j];
+		if (job.result == nullptr) {
+			return;
+		}
+		Image_Allocator *const previousAllocator = Image_SetThreadAllocator(allocator);
+		size_t const previousAlignment = Image_SetThreadDataAlignment(alignment);
+		if (!RunBatchJob(plans[planOfJob[j]], job.image, job.result)) {
+			Image_Destroy(job.result);
+			job.result = nullptr;
+			failed = true;
+		}
+		Image_SetThreadDataAlignment(previousAlignment);
+		Image_SetThreadAllocator(previousAllocator);
+	});
+
+	// as Image_FastConvert, results built here and chains converted in place
+	// that had one get a directory
+	for (size_t j = 0; j < jobCount; ++j) {
+		Image_ConvertJob const &job = jobs[j];
+		if (job.result && (job.result != job.image || recorded[j])) {
+			Image::RecordLevelDirectory(job.result);
+		}
+	}
+	return ok && !failed;
+}
@@ -0,0 +1,434 @@
+#include "al2o3_platform/platform.h"
+#include "simd.hpp"
+#include "convert_kernels.hpp"
+
+namespace {
+using namespace Image;
+
+typedef void (*SwizzleRGB8ToRGBA8Func)(uint8_t const *src, uint8_t *dst, size_t pixelCount, uint8_t alpha);
+typedef void (*SwizzleRGBA8ToBGRA8Func)(uint8_t const *src, uint8_t *dst, size_t pixelCount);
+typedef void (*HalfToFloatFunc)(uint16_t const *src, float *dst, size_t count);
+typedef void (*FloatToHalfFunc)(float const *src, uint16_t *dst, size_t count);
+
+void SwizzleRGB8ToRGBA8_Scalar(uint8_t const *src, uint8_t *dst, size_t pixelCount, uint8_t alpha) {
+	while (pixelCount--) {
+		dst[0] = src[0];
+		dst[1] = src[1];
+		dst[2] = src[2];
+		dst[3] = alpha;
+		src += 3;
+		dst += 4;
+	}
+}
+
+void SwizzleRGBA8ToBGRA8_Scalar(uint8_t const *src, uint8_t *dst, size_t pixelCount) {
+	while (pixelCount--) {
+		uint8_t const r = src[2];
+		uint8_t const g = src[1];
+		uint8_t const b = src[0];
+		uint8_t const a = src[3];
+		dst[0] = r;
+		dst[1] = g;
+		dst[2] = b;
+		dst[3] = a;
+		src += 4;
+		dst += 4;
+	}
+}
+
+void HalfToFloat_Scalar(uint16_t const *src, float *dst, size_t count) {
+	while (count--) {
+		*dst++ = Math_Half2Float(*src++);
+	}
+}
+
+void FloatToHalf_Scalar(float const *src, uint16_t *dst, size_t count) {
+	while (count--) {
+		*dst++ = Math_Float2Half(*src++);
+	}
+}
+
+#if IMAGE_SIMD_X86
+IMAGE_SIMD_TARGET("ssse3")
+void SwizzleRGB8ToRGBA8_SSSE3(uint8_t const *src, uint8_t *dst, size_t pixelCount, uint8_t alpha) {
+	__m128i const shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	__m128i const alphaMask = _mm_set1_epi32((int) ((uint32_t) alpha << 24u));
+
+	// 16 pixels per iteration, 48 bytes in exactly 3 loads
+	while (pixelCount >= 16) {
+		__m128i const a = _mm_loadu_si128((__m128i const *) (src + 0));
+		__m128i const b = _mm_loadu_si128((__m128i const *) (src + 16));
+		__m128i const c = _mm_loadu_si128((__m128i const *) (src + 32));
+
+		__m128i const p0 = a;
+		__m128i const p1 = _mm_alignr_epi8(b, a, 12);
+		__m128i const p2 = _mm_alignr_epi8(c, b, 8);
+		__m128i const p3 = _mm_srli_si128(c, 4);
+
+		_mm_storeu_si128((__m128i *) (dst + 0), _mm_or_si128(_mm_shuffle_epi8(p0, shuffle), alphaMask));
+		_mm_storeu_si128((__m128i *) (dst + 16), _mm_or_si128(_mm_shuffle_epi8(p1, shuffle), alphaMask));
+		_mm_storeu_si128((__m128i *) (dst + 32), _mm_or_si128(_mm_shuffle_epi8(p2, shuffle), alphaMask));
+		_mm_storeu_si128((__m128i *) (dst + 48), _mm_or_si128(_mm_shuffle_epi8(p3, shuffle), alphaMask));
+
+		src += 48;
+		dst += 64;
+		pixelCount -= 16;
+	}
+	SwizzleRGB8ToRGBA8_Scalar(src, dst, pixelCount, alpha);
+}
+
+IMAGE_SIMD_TARGET("avx2")
+void SwizzleRGB8ToRGBA8_AVX2(uint8_t const *src, uint8_t *dst, size_t pixelCount, uint8_t alpha) {
+	// move the 2nd group of 4 pixels into the upper lane, as pshufb can't cross lanes
+	__m256i const permute = _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0);
+	__m256i const shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+																					 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	__m256i const alphaMask = _mm256_set1_epi32((int) ((uint32_t) alpha << 24u));
+
+	// 32 pixels per iteration, each 8 pixel load reads 32 bytes but only uses 24
+	// so keep 3 pixels in hand to make sure the last load is inside the image
+	while (pixelCount >= 32 + 3) {
+		for (int i = 0; i < 4; ++i) {
+			__m256i const v = _mm256_loadu_si256((__m256i const *) (src + i * 24));
+			__m256i const p = _mm256_permutevar8x32_epi32(v, permute);
+			_mm256_storeu_si256((__m256i *) (dst + i * 32), _mm256_or_si256(_mm256_shuffle_epi8(p, shuffle), alphaMask));
+		}
+		src += 96;
+		dst += 128;
+		pixelCount -= 32;
+	}
+	SwizzleRGB8ToRGBA8_SSSE3(src, dst, pixelCount, alpha);
+}
+
+IMAGE_SIMD_TARGET("ssse3")
+void SwizzleRGBA8ToBGRA8_SSSE3(uint8_t const *src, uint8_t *dst, size_t pixelCount) {
+	__m128i const shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+	// 16 pixels per iteration, all loads happen before the stores so in place is fine
+	while (pixelCount >= 16) {
+		__m128i const a = _mm_loadu_si128((__m128i const *) (src + 0));
+		__m128i const b = _mm_loadu_si128((__m128i const *) (src + 16));
+		__m128i const c = _mm_loadu_si128((__m128i const *) (src + 32));
+		__m128i const d = _mm_loadu_si128((__m128i const *) (src + 48));
+		_mm_storeu_si128((__m128i *) (dst + 0), _mm_shuffle_epi8(a, shuffle));
+		_mm_storeu_si128((__m128i *) (dst + 16), _mm_shuffle_epi8(b, shuffle));
+		_mm_storeu_si128((__m128i *) (dst + 32), _mm_shuffle_epi8(c, shuffle));
+		_mm_storeu_si128((__m128i *) (dst + 48), _mm_shuffle_epi8(d, shuffle));
+		src += 64;
+		dst += 64;
+		pixelCount -= 16;
+	}
+	SwizzleRGBA8ToBGRA8_Scalar(src, dst, pixelCount);
+}
+
+IMAGE_SIMD_TARGET("avx2")
+void SwizzleRGBA8ToBGRA8_AVX2(uint8_t const *src, uint8_t *dst, size_t pixelCount) {
+	__m256i const shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+																					 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+	// 32 pixels per iteration
+	while (pixelCount >= 32) {
+		__m256i const a = _mm256_loadu_si256((__m256i const *) (src + 0));
+		__m256i const b = _mm256_loadu_si256((__m256i const *) (src + 32));
+		__m256i const c = _mm256_loadu_si256((__m256i const *) (src + 64));
+		__m256i const d = _mm256_loadu_si256((__m256i const *) (src + 96));
+		_mm256_storeu_si256((__m256i *) (dst + 0), _mm256_shuffle_epi8(a, shuffle));
+		_mm256_storeu_si256((__m256i *) (dst + 32), _mm256_shuffle_epi8(b, shuffle));
+		_mm256_storeu_si256((__m256i *) (dst + 64), _mm256_shuffle_epi8(c, shuffle));
+		_mm256_storeu_si256((__m256i *) (dst + 96), _mm256_shuffle_epi8(d, shuffle));
+		src += 128;
+		dst += 128;
+		pixelCount -= 32;
+	}
+	SwizzleRGBA8ToBGRA8_SSSE3(src, dst, pixelCount);
+}
+
+// SSE2 versions of the classic bit twiddling conversions (F. Giesen), these
+// give the same results as the F16C instructions (bar NaN payloads) for CPUs
+// without them
+
+// 4 halfs in the low 16 bits of each lane to 4 floats
+IMAGE_SIMD_TARGET("sse2")
+inline __m128 HalfToFloat4_SSE2(__m128i h) {
+	__m128i const maskNoSign = _mm_set1_epi32(0x7fff);
+	__m128 const magic = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+	__m128i const wasInfNan = _mm_set1_epi32(0x7bff);
+	__m128 const expInfNan = _mm_castsi128_ps(_mm_set1_epi32(255 << 23));
+
+	__m128i const expMant = _mm_and_si128(maskNoSign, h);
+	__m128i const justSign = _mm_xor_si128(h, expMant);
+	// rebias the exponent (and fix denormals) with a single multiply
+	__m128 const scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMant, 13)), magic);
+	__m128i const isInfNan = _mm_cmpgt_epi32(expMant, wasInfNan);
+	__m128i const sign = _mm_slli_epi32(justSign, 16);
+	__m128 const infNanExp = _mm_and_ps(_mm_castsi128_ps(isInfNan), expInfNan);
+	return _mm_or_ps(scaled, _mm_or_ps(_mm_castsi128_ps(sign), infNanExp));
+}
+
+// 4 floats to 4 halfs in the low 16 bits of each lane, round to nearest even
+IMAGE_SIMD_TARGET("sse2")
+inline __m128i FloatToHalf4_SSE2(__m128 f) {
+	__m128i const f16Max = _mm_set1_epi32((127 + 16) << 23);
+	__m128i const nanBit = _mm_set1_epi32(0x200);
+	__m128i const infAsHalf = _mm_set1_epi32(0x7c00);
+	__m128i const minNormal = _mm_set1_epi32((127 - 14) << 23);
+	__m128i const subNormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+	__m128i const normalBias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+
+	__m128 const justSign = _mm_and_ps(_mm_castsi128_ps(_mm_set1_epi32((int) 0x80000000u)), f);
+	__m128 const absf = _mm_xor_ps(f, justSign);
+	__m128i const absfInt = _mm_castps_si128(absf);
+	__m128 const isNan = _mm_cmpunord_ps(absf, absf);
+	__m128i const isRegular = _mm_cmpgt_epi32(f16Max, absfInt);
+	__m128i const infOrNan = _mm_or_si128(_mm_and_si128(_mm_castps_si128(isNan), nanBit), infAsHalf);
+	__m128i const isSubNormal = _mm_cmpgt_epi32(minNormal, absfInt);
+
+	// result is a half denormal, let the float adder do the rounding
+	__m128 const subNorm1 = _mm_add_ps(absf, _mm_castsi128_ps(subNormMagic));
+	__m128i const subNorm2 = _mm_sub_epi32(_mm_castps_si128(subNorm1), subNormMagic);
+
+	// result is a normal half, bias towards rounding up when the mantissa is odd
+	__m128i const mantOdd = _mm_srai_epi32(_mm_slli_epi32(absfInt, 31 - 13), 31);
+	__m128i const rounded = _mm_sub_epi32(_mm_add_epi32(absfInt, normalBias), mantOdd);
+	__m128i const normal = _mm_srli_epi32(rounded, 13);
+
+	__m128i const nonSpecial = _mm_or_si128(_mm_and_si128(subNorm2, isSubNormal),
+																					_mm_andnot_si128(isSubNormal, normal));
+	__m128i const joined = _mm_or_si128(_mm_and_si128(nonSpecial, isRegular),
+																			_mm_andnot_si128(isRegular, infOrNan));
+	return _mm_or_si128(joined, _mm_srli_epi32(_mm_castps_si128(justSign), 16));
+}
+
+IMAGE_SIMD_TARGET("sse2")
+void HalfToFloat_SSE2(uint16_t const *src, float *dst, size_t count) {
+	__m128i const zero = _mm_setzero_si128();
+	while (count >= 8) {
+		__m128i const h = _mm_loadu_si128((__m128i const *) src);
+		_mm_storeu_ps(dst + 0, HalfToFloat4_SSE2(_mm_unpacklo_epi16(h, zero)));
+		_mm_storeu_ps(dst + 4, HalfToFloat4_SSE2(_mm_unpackhi_epi16(h, zero)));
+		src += 8;
+		dst += 8;
+		count -= 8;
+	}
+	if (count) {
+		// run the tail through the same code via a small buffer so results don't
+		// depend on where a value lands in the image
+		uint16_t in[8] = {};
+		float out[8];
+		memcpy(in, src, count * sizeof(uint16_t));
+		HalfToFloat_SSE2(in, out, 8);
+		memcpy(dst, out, count * sizeof(float));
+	}
+}
+
+IMAGE_SIMD_TARGET("sse2")
+void FloatToHalf_SSE2(float const *src, uint16_t *dst, size_t count) {
+	while (count >= 8) {
+		__m128i const lo = FloatToHalf4_SSE2(_mm_loadu_ps(src + 0));
+		__m128i const hi = FloatToHalf4_SSE2(_mm_loadu_ps(src + 4));
+		// sign extend so the signed saturating pack passes the 16 bits through untouched
+		__m128i const packed = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16),
+																					 _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+		_mm_storeu_si128((__m128i *) dst, packed);
+		src += 8;
+		dst += 8;
+		count -= 8;
+	}
+	if (count) {
+		float in[8] = {};
+		uint16_t out[8];
+		memcpy(in, src, count * sizeof(float));
+		FloatToHalf_SSE2(in, out, 8);
+		memcpy(dst, out, count * sizeof(uint16_t));
+	}
+}
+
+IMAGE_SIMD_TARGET("avx,f16c")
+void HalfToFloat_F16C(uint16_t const *src, float *dst, size_t count) {
+	while (count >= 16) {
+		__m256 const a = _mm256_cvtph_ps(_mm_loadu_si128((__m128i const *) (src + 0)));
+		__m256 const b = _mm256_cvtph_ps(_mm_loadu_si128((__m128i const *) (src + 8)));
+		_mm256_storeu_ps(dst + 0, a);
+		_mm256_storeu_ps(dst + 8, b);
+		src += 16;
+		dst += 16;
+		count -= 16;
+	}
+	while (count >= 8) {
+		_mm256_storeu_ps(dst, _mm256_cvtph_ps(_mm_loadu_si128((__m128i const *) src)));
+		src += 8;
+		dst += 8;
+		count -= 8;
+	}
+	if (count) {
+		uint16_t in[8] = {};
+		float out[8];
+		memcpy(in, src, count * sizeof(uint16_t));
+		_mm256_storeu_ps(out, _mm256_cvtph_ps(_mm_loadu_si128((__m128i const *) in)));
+		memcpy(dst, out, count * sizeof(float));
+	}
+}
+
+IMAGE_SIMD_TARGET("avx,f16c")
+void FloatToHalf_F16C(float const *src, uint16_t *dst, size_t count) {
+	while (count >= 16) {
+		__m128i const a = _mm256_cvtps_ph(_mm256_loadu_ps(src + 0), _MM_FROUND_TO_NEAREST_INT);
+		__m128i const b = _mm256_cvtps_ph(_mm256_loadu_ps(src + 8), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128((__m128i *) (dst + 0), a);
+		_mm_storeu_si128((__m128i *) (dst + 8), b);
+		src += 16;
+		dst += 16;
+		count -= 16;
+	}
+	while (count >= 8) {
+		_mm_storeu_si128((__m128i *) dst, _mm256_cvtps_ph(_mm256_loadu_ps(src), _MM_FROUND_TO_NEAREST_INT));
+		src += 8;
+		dst += 8;
+		count -= 8;
+	}
+	if (count) {
+		float in[8] = {};
+		uint16_t out[8];
+		memcpy(in, src, count * sizeof(float));
+		_mm_storeu_si128((__m128i *) out, _mm256_cvtps_ph(_mm256_loadu_ps(in), _MM_FROUND_TO_NEAREST_INT));
+		memcpy(dst, out, count * sizeof(uint16_t));
+	}
+}
+#endif
+
+#if IMAGE_SIMD_NEON
+void SwizzleRGB8ToRGBA8_NEON(uint8_t const *src, uint8_t *dst, size_t pixelCount, uint8_t alpha) {
+	uint8x16_t const alphaVec = vdupq_n_u8(alpha);
+	while (pixelCount >= 16) {
+		uint8x16x3_t const rgb = vld3q_u8(src);
+		uint8x16x4_t rgba;
+		rgba.val[0] = rgb.val[0];
+		rgba.val[1] = rgb.val[1];
+		rgba.val[2] = rgb.val[2];
+		rgba.val[3] = alphaVec;
+		vst4q_u8(dst, rgba);
+		src += 48;
+		dst += 64;
+		pixelCount -= 16;
+	}
+	SwizzleRGB8ToRGBA8_Scalar(src, dst, pixelCount, alpha);
+}
+
+void SwizzleRGBA8ToBGRA8_NEON(uint8_t const *src, uint8_t *dst, size_t pixelCount) {
+	while (pixelCount >= 16) {
+		uint8x16x4_t rgba = vld4q_u8(src);
+		uint8x16_t const r = rgba.val[0];
+		rgba.val[0] = rgba.val[2];
+		rgba.val[2] = r;
+		vst4q_u8(dst, rgba);
+		src += 64;
+		dst += 64;
+		pixelCount -= 16;
+	}
+	SwizzleRGBA8ToBGRA8_Scalar(src, dst, pixelCount);
+}
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+void HalfToFloat_NEON(uint16_t const *src, float *dst, size_t count) {
+	while (count >= 8) {
+		float16x8_t const h = vreinterpretq_f16_u16(vld1q_u16(src));
+		vst1q_f32(dst + 0, vcvt_f32_f16(vget_low_f16(h)));
+		vst1q_f32(dst + 4, vcvt_f32_f16(vget_high_f16(h)));
+		src += 8;
+		dst += 8;
+		count -= 8;
+	}
+	if (count) {
+		uint16_t in[8] = {};
+		float out[8];
+		memcpy(in, src, count * sizeof(uint16_t));
+		HalfToFloat_NEON(in, out, 8);
+		memcpy(dst, out, count * sizeof(float));
+	}
+}
+
+void FloatToHalf_NEON(float const *src, uint16_t *dst, size_t count) {
+	while (count >= 8) {
+		float16x4_t const lo = vcvt_f16_f32(vld1q_f32(src + 0));
+		float16x4_t const hi = vcvt_f16_f32(vld1q_f32(src + 4));
+		vst1q_u16(dst, vreinterpretq_u16_f16(vcombine_f16(lo, hi)));
+		src += 8;
+		dst += 8;
+		count -= 8;
+	}
+	if (count) {
+		float in[8] = {};
+		uint16_t out[8];
+		memcpy(in, src, count * sizeof(float));
+		FloatToHalf_NEON(in, out, 8);
+		memcpy(dst, out, count * sizeof(uint16_t));
+	}
+}
+#endif
+#endif
+
+SwizzleRGB8ToRGBA8Func SelectSwizzleRGB8ToRGBA8() {
+#if IMAGE_SIMD_X86
+	if (GetCpuFeatures().avx2) { return &SwizzleRGB8ToRGBA8_AVX2; }
+	if (GetCpuFeatures().ssse3) { return &SwizzleRGB8ToRGBA8_SSSE3; }
+#elif IMAGE_SIMD_NEON
+	return &SwizzleRGB8ToRGBA8_NEON;
+#endif
+	return &SwizzleRGB8ToRGBA8_Scalar;
+}
+
+SwizzleRGBA8ToBGRA8Func SelectSwizzleRGBA8ToBGRA8() {
+#if IMAGE_SIMD_X86
+	if (GetCpuFeatures().avx2) { return &SwizzleRGBA8ToBGRA8_AVX2; }
+	if (GetCpuFeatures().ssse3) { return &SwizzleRGBA8ToBGRA8_SSSE3; }
+#elif IMAGE_SIMD_NEON
+	return &SwizzleRGBA8ToBGRA8_NEON;
+#endif
+	return &SwizzleRGBA8ToBGRA8_Scalar;
+}
+
+HalfToFloatFunc SelectHalfToFloat() {
+#if IMAGE_SIMD_X86
+	if (GetCpuFeatures().f16c) { return &HalfToFloat_F16C; }
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	return &HalfToFloat_SSE2;
+#endif
+#elif IMAGE_SIMD_NEON && (defined(__aarch64__) || defined(_M_ARM64))
+	return &HalfToFloat_NEON;
+#endif
+	return &HalfToFloat_Scalar;
+}
+
+FloatToHalfFunc SelectFloatToHalf() {
+#if IMAGE_SIMD_X86
+	if (GetCpuFeatures().f16c) { return &FloatToHalf_F16C; }
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	return &FloatToHalf_SSE2;
+#endif
+#elif IMAGE_SIMD_NEON && (defined(__aarch64__) || defined(_M_ARM64))
+	return &FloatToHalf_NEON;
+#endif
+	return &FloatToHalf_Scalar;
+}
+
+} // end anon namespace
+
+void Image::SwizzleRGB8ToRGBA8(uint8_t const *src, uint8_t *dst, size_t pixelCount, uint8_t alpha) {
+	static SwizzleRGB8ToRGBA8Func const func = SelectSwizzleRGB8ToRGBA8();
+	func(src, dst, pixelCount, alpha);
+}
+
+void Image::SwizzleRGBA8ToBGRA8(uint8_t const *src, uint8_t *dst, size_t pixelCount) {
+	static SwizzleRGBA8ToBGRA8Func const func = SelectSwizzleRGBA8ToBGRA8();
+	func(src, dst, pixelCount);
+}
+
+void Image::HalfToFloat(uint16_t const *src, float *dst, size_t count) {
+	static HalfToFloatFunc const func = SelectHalfToFloat();
+	func(src, dst, count);
+}
+
+void Image::FloatToHalf(float const *src, uint16_t *dst, size_t count) {
+	static FloatToHalfFunc const func = SelectFloatToHalf();
+	func(src, dst, count);
+}
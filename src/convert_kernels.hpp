@@ -0,0 +1,25 @@
+// Row kernels used by the fast conversion paths, each picks the best
+// implementation for the running CPU on first use
+#ifndef WYRD_IMAGE_CONVERT_KERNELS_HPP
+#define WYRD_IMAGE_CONVERT_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Image {
+
+// expands 3 byte pixels to 4 bytes writing alpha into the new 4th byte
+void SwizzleRGB8ToRGBA8(uint8_t const *src, uint8_t *dst, size_t pixelCount, uint8_t alpha);
+
+// swaps bytes 0 and 2 of each 4 byte pixel, src and dst may be the same
+void SwizzleRGBA8ToBGRA8(uint8_t const *src, uint8_t *dst, size_t pixelCount);
+
+// converts count IEEE half floats to floats, exact for every input
+void HalfToFloat(uint16_t const *src, float *dst, size_t count);
+
+// converts count floats to IEEE half floats with round to nearest even
+void FloatToHalf(float const *src, uint16_t *dst, size_t count);
+
+} // end namespace Image
+
+#endif //WYRD_IMAGE_CONVERT_KERNELS_HPP
@@ -0,0 +1,438 @@
+#include "al2o3_platform/platform.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "tiny_imageformat/tinyimageformat_query.h"
+#include "convert_matrix.hpp"
+#include "format_info.hpp"
+#include "srgb.hpp"
+#include <array>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+enum class NumericClass {
+	UNorm,
+	SNorm,
+	UInt,
+	SInt,
+	SFloat,
+	SRGB,
+};
+
+// storage type and class of one channel value, half floats are stored as
+// uint16_t and double as themselves
+template<typename T, NumericClass C>
+struct Encoding {
+	using Storage = T;
+	static constexpr NumericClass Class = C;
+};
+
+using Encodings = std::tuple<
+		Encoding<uint8_t, NumericClass::UNorm>,
+		Encoding<int8_t, NumericClass::SNorm>,
+		Encoding<uint8_t, NumericClass::UInt>,
+		Encoding<int8_t, NumericClass::SInt>,
+		Encoding<uint8_t, NumericClass::SRGB>,
+		Encoding<uint16_t, NumericClass::UNorm>,
+		Encoding<int16_t, NumericClass::SNorm>,
+		Encoding<uint16_t, NumericClass::UInt>,
+		Encoding<int16_t, NumericClass::SInt>,
+		Encoding<uint16_t, NumericClass::SFloat>,
+		Encoding<uint32_t, NumericClass::UInt>,
+		Encoding<int32_t, NumericClass::SInt>,
+		Encoding<float, NumericClass::SFloat>,
+		Encoding<uint64_t, NumericClass::UInt>,
+		Encoding<int64_t, NumericClass::SInt>,
+		Encoding<double, NumericClass::SFloat>
+>;
+constexpr size_t EncodingCount = std::tuple_size<Encodings>::value;
+
+template<size_t I>
+using EncodingAt = std::tuple_element_t<I, Encodings>;
+
+// the channel orders, a channel count and whether red and blue are swapped
+constexpr uint32_t LayoutCount = 6;
+constexpr uint32_t LayoutChannelCount[LayoutCount] = {1, 2, 3, 3, 4, 4};
+constexpr bool LayoutIsBGR[LayoutCount] = {false, false, false, true, false, true};
+constexpr uint32_t FirstLayoutOf[5] = {0, 0, 1, 2, 4};
+
+// the values in between, double where a float can't hold every value of
+// either side exactly
+template<typename From, typename To>
+using WorkingTypeOf = std::conditional_t<
+		(sizeof(typename From::Storage) >= 4 && From::Class != NumericClass::SFloat) ||
+		(sizeof(typename To::Storage) >= 4 && To::Class != NumericClass::SFloat) ||
+		std::is_same<typename From::Storage, double>::value ||
+		std::is_same<typename To::Storage, double>::value,
+		double, float>;
+
+template<typename E>
+constexpr bool IsHalf() {
+	return E::Class == NumericClass::SFloat && std::is_same<typename E::Storage, uint16_t>::value;
+}
+
+template<typename W, typename E>
+W DecodeValue(typename E::Storage v, bool alpha) {
+	using T = typename E::Storage;
+	W const max = (W) std::numeric_limits<T>::max();
+	if constexpr (E::Class == NumericClass::SRGB) {
+		return alpha ? (W) v / max : (W) Image::SRGB8ToLinear(v);
+	} else if constexpr (E::Class == NumericClass::UNorm) {
+		return (W) v / max;
+	} else if constexpr (E::Class == NumericClass::SNorm) {
+		W const x = (W) v / max;
+		return x < W(-1) ? W(-1) : x;
+	} else if constexpr (IsHalf<E>()) {
+		return (W) Math_Half2Float(v);
+	} else {
+		return (W) v;
+	}
+}
+
+// round half away from zero, v must be in range of T
+template<typename T, typename W>
+T RoundTo(W v) {
+	return (T) (v < W(0) ? v - W(0.5) : v + W(0.5));
+}
+
+template<typename W, typename E>
+typename E::Storage EncodeValue(W v, bool alpha) {
+	using T = typename E::Storage;
+	W const max = (W) std::numeric_limits<T>::max();
+	if constexpr (IsHalf<E>()) {
+		return Math_Float2Half((float) v);
+	} else if constexpr (E::Class == NumericClass::SFloat) {
+		return (T) v;
+	} else if constexpr (E::Class == NumericClass::SRGB || E::Class == NumericClass::UNorm) {
+		if (E::Class == NumericClass::SRGB && !alpha) {
+			return Image::LinearToSRGB8((float) v);
+		}
+		if (!(v > W(0))) {
+			return 0;
+		}
+		return v >= W(1) ? std::numeric_limits<T>::max() : RoundTo<T>(v * max);
+	} else if constexpr (E::Class == NumericClass::SNorm) {
+		if (v != v) {
+			return 0;
+		}
+		if (v <= W(-1)) {
+			return -std::numeric_limits<T>::max();
+		}
+		return v >= W(1) ? std::numeric_limits<T>::max() : RoundTo<T>(v * max);
+	} else {
+		if (v != v) {
+			return 0;
+		}
+		// max of a 64 bit integer rounds up to a power of 2 as a double, so >=
+		if (v <= (W) std::numeric_limits<T>::lowest()) {
+			return std::numeric_limits<T>::lowest();
+		}
+		return v >= max ? std::numeric_limits<T>::max() : RoundTo<T>(v);
+	}
+}
+
+// what a missing alpha channel reads as
+template<typename E>
+typename E::Storage OneOf() {
+	using T = typename E::Storage;
+	if constexpr (IsHalf<E>()) {
+		return 0x3c00;
+	} else if constexpr (E::Class == NumericClass::UInt || E::Class == NumericClass::SInt ||
+			E::Class == NumericClass::SFloat) {
+		return (T) 1;
+	} else {
+		return std::numeric_limits<T>::max();
+	}
+}
+
+template<typename From, typename To>
+void ConvertValues(void const *src, void *dst, size_t pixelCount, uint32_t componentCount) {
+	using W = WorkingTypeOf<From, To>;
+	auto s = (typename From::Storage const *) src;
+	auto d = (typename To::Storage *) dst;
+
+	if constexpr (std::is_same<From, To>::value) {
+		if (src != dst) {
+			memcpy(dst, src, pixelCount * componentCount * sizeof(typename To::Storage));
+		}
+		return;
+	}
+
+	// only sRGB treats alpha (the 4th component) differently, everything
+	// else is one flat loop over the components
+	if constexpr (From::Class == NumericClass::SRGB || To::Class == NumericClass::SRGB) {
+		for (size_t i = 0; i < pixelCount; ++i) {
+			for (uint32_t c = 0; c < componentCount; ++c) {
+				d[c] = EncodeValue<W, To>(DecodeValue<W, From>(s[c], c == 3), c == 3);
+			}
+			s += componentCount;
+			d += componentCount;
+		}
+	} else {
+		size_t const count = pixelCount * componentCount;
+		for (size_t i = 0; i < count; ++i) {
+			d[i] = EncodeValue<W, To>(DecodeValue<W, From>(s[i], false), false);
+		}
+	}
+}
+
+// logical channel of physical channel pc
+constexpr uint32_t LogicalChannelOf(uint32_t pc, bool bgr) {
+	return (bgr && pc < 3) ? 2 - pc : pc;
+}
+
+// physical channel holding logical channel lc, channelCount if there isn't one
+constexpr uint32_t PhysicalChannelOf(uint32_t lc, uint32_t channelCount, bool bgr) {
+	return lc >= channelCount ? channelCount : LogicalChannelOf(lc, bgr);
+}
+
+template<typename E, uint32_t SrcLayout, uint32_t DstLayout>
+void ShuffleChannels(void const *src, void *dst, size_t pixelCount) {
+	using T = typename E::Storage;
+	constexpr uint32_t N1 = LayoutChannelCount[SrcLayout];
+	constexpr uint32_t N2 = LayoutChannelCount[DstLayout];
+	T const one = OneOf<E>();
+	auto s = (T const *) src;
+	auto d = (T *) dst;
+	for (size_t i = 0; i < pixelCount; ++i) {
+		T pixel[4];
+		for (uint32_t c = 0; c < N1; ++c) {
+			pixel[c] = s[c];
+		}
+		for (uint32_t c = 0; c < N2; ++c) {
+			uint32_t const lc = LogicalChannelOf(c, LayoutIsBGR[DstLayout]);
+			uint32_t const pc = PhysicalChannelOf(lc, N1, LayoutIsBGR[SrcLayout]);
+			d[c] = pc < N1 ? pixel[pc] : (lc == 3 ? one : (T) 0);
+		}
+		s += N1;
+		d += N2;
+	}
+}
+
+// rough cycles per component, scalar half and sRGB encoding cost the most
+template<typename E>
+constexpr float DecodeCostOf() {
+	if constexpr (E::Class == NumericClass::SRGB) {
+		return 2.0f;
+	} else if constexpr (IsHalf<E>()) {
+		return 4.0f;
+	} else if constexpr (E::Class == NumericClass::UNorm || E::Class == NumericClass::SNorm) {
+		return 1.0f;
+	} else {
+		return 0.5f;
+	}
+}
+
+template<typename E>
+constexpr float EncodeCostOf() {
+	if constexpr (E::Class == NumericClass::SRGB) {
+		return 8.0f;
+	} else if constexpr (IsHalf<E>()) {
+		return 6.0f;
+	} else if constexpr (E::Class == NumericClass::SFloat) {
+		return 0.5f;
+	} else {
+		return 2.0f;
+	}
+}
+
+float const CopyCostPerComponent = 0.125f;
+float const ShuffleCostPerPixel = 1.0f;
+
+using ValueTable = std::array<Image::PlainValueConvertFunc, EncodingCount * EncodingCount>;
+using ShuffleTable = std::array<Image::PlainShuffleFunc, EncodingCount * LayoutCount * LayoutCount>;
+
+template<size_t... I>
+constexpr ValueTable MakeValueTable(std::index_sequence<I...>) {
+	return {{&ConvertValues<EncodingAt<I / EncodingCount>, EncodingAt<I % EncodingCount>>...}};
+}
+
+template<size_t... I>
+constexpr ShuffleTable MakeShuffleTable(std::index_sequence<I...>) {
+	return {{&ShuffleChannels<EncodingAt<I / (LayoutCount * LayoutCount)>,
+													 (I / LayoutCount) % LayoutCount,
+													 I % LayoutCount>...}};
+}
+
+using CostTable = std::array<float, EncodingCount>;
+
+template<size_t... I>
+constexpr CostTable MakeDecodeCostTable(std::index_sequence<I...>) {
+	return {{DecodeCostOf<EncodingAt<I>>()...}};
+}
+
+template<size_t... I>
+constexpr CostTable MakeEncodeCostTable(std::index_sequence<I...>) {
+	return {{EncodeCostOf<EncodingAt<I>>()...}};
+}
+
+template<size_t... I>
+constexpr std::array<NumericClass, EncodingCount> MakeClassTable(std::index_sequence<I...>) {
+	return {{EncodingAt<I>::Class...}};
+}
+
+template<size_t... I>
+constexpr std::array<uint32_t, EncodingCount> MakeBitsTable(std::index_sequence<I...>) {
+	return {{(uint32_t) (sizeof(typename EncodingAt<I>::Storage) * 8)...}};
+}
+
+constexpr std::array<NumericClass, EncodingCount> EncodingClasses = MakeClassTable(std::make_index_sequence<EncodingCount>{});
+constexpr std::array<uint32_t, EncodingCount> EncodingBits = MakeBitsTable(std::make_index_sequence<EncodingCount>{});
+
+constexpr CostTable DecodeCosts = MakeDecodeCostTable(std::make_index_sequence<EncodingCount>{});
+constexpr CostTable EncodeCosts = MakeEncodeCostTable(std::make_index_sequence<EncodingCount>{});
+
+// indexed by [from encoding][to encoding] and [encoding][from layout][to layout]
+constexpr ValueTable ValueConverters = MakeValueTable(std::make_index_sequence<EncodingCount * EncodingCount>{});
+constexpr ShuffleTable ShuffleConverters = MakeShuffleTable(std::make_index_sequence<EncodingCount * LayoutCount * LayoutCount>{});
+
+// pixels per pass when a shuffle and a value conversion meet in a buffer
+size_t const ConvertBlockPixelCount = 256;
+
+template<size_t I = 0>
+bool EncodingIndexOf(uint32_t bits, NumericClass numericClass, uint32_t &index) {
+	if constexpr (I == EncodingCount) {
+		return false;
+	} else {
+		if (sizeof(typename EncodingAt<I>::Storage) * 8 == bits && EncodingAt<I>::Class == numericClass) {
+			index = (uint32_t) I;
+			return true;
+		}
+		return EncodingIndexOf<I + 1>(bits, numericClass, index);
+	}
+}
+
+NumericClass NumericClassOf(TinyImageFormat fmt) {
+	if (TinyImageFormat_IsSRGB(fmt)) {
+		return NumericClass::SRGB;
+	}
+	if (TinyImageFormat_IsFloat(fmt)) {
+		return NumericClass::SFloat;
+	}
+	if (TinyImageFormat_IsNormalised(fmt)) {
+		return TinyImageFormat_IsSigned(fmt) ? NumericClass::SNorm : NumericClass::UNorm;
+	}
+	return TinyImageFormat_IsSigned(fmt) ? NumericClass::SInt : NumericClass::UInt;
+}
+
+struct MatrixFormat {
+	uint32_t encoding;
+	uint32_t layout;
+	uint32_t componentCount;
+	uint32_t pixelSize;
+};
+
+bool MatrixFormatOf(TinyImageFormat fmt, MatrixFormat &out) {
+	Image::PlainLayout const plain = Image::PlainLayoutOf(fmt);
+	if (!plain.plain || plain.componentCount == 0 || plain.componentCount > 4 ||
+			!EncodingIndexOf(plain.bits, NumericClassOf(fmt), out.encoding)) {
+		return false;
+	}
+
+	// the physical order must be one of the layouts
+	bool const bgr = plain.componentCount >= 3 &&
+			TinyImageFormat_PhysicalChannelToLogical(fmt, 0) == TinyImageFormat_LC_Blue;
+	for (uint32_t pc = 0; pc < plain.componentCount; ++pc) {
+		if ((uint32_t) TinyImageFormat_PhysicalChannelToLogical(fmt, (int) pc) != LogicalChannelOf(pc, bgr)) {
+			return false;
+		}
+	}
+	out.componentCount = plain.componentCount;
+	out.layout = FirstLayoutOf[plain.componentCount] + (bgr ? 1 : 0);
+	out.pixelSize = plain.bits / 8 * plain.componentCount;
+	ASSERT(LayoutChannelCount[out.layout] == out.componentCount && LayoutIsBGR[out.layout] == bgr);
+	return true;
+}
+
+} // end anon namespace
+
+namespace Image {
+
+bool PlainConverterOf(TinyImageFormat srcFormat, TinyImageFormat dstFormat, PlainConverter &converter) {
+	MatrixFormat src;
+	MatrixFormat dst;
+	if (!MatrixFormatOf(srcFormat, src) || !MatrixFormatOf(dstFormat, dst)) {
+		return false;
+	}
+
+	converter.values = ValueConverters[src.encoding * EncodingCount + dst.encoding];
+	converter.shuffleFirst = dst.componentCount < src.componentCount;
+	converter.srcComponentCount = src.componentCount;
+	converter.dstComponentCount = dst.componentCount;
+	converter.srcPixelSize = src.pixelSize;
+	converter.dstPixelSize = dst.pixelSize;
+	converter.shuffle = nullptr;
+	if (src.layout != dst.layout) {
+		// shuffle on the side with fewer channels
+		uint32_t const encoding = converter.shuffleFirst ? src.encoding : dst.encoding;
+		converter.shuffle = ShuffleConverters[(encoding * LayoutCount + src.layout) * LayoutCount + dst.layout];
+	}
+
+	uint32_t const valueCount = converter.shuffleFirst ? dst.componentCount : src.componentCount;
+	converter.cost = src.encoding == dst.encoding ?
+			valueCount * CopyCostPerComponent :
+			valueCount * (DecodeCosts[src.encoding] + EncodeCosts[dst.encoding]);
+	if (converter.shuffle) {
+		converter.cost += ShuffleCostPerPixel;
+	}
+	return true;
+}
+
+bool PlainIntermediateHolds(TinyImageFormat from, TinyImageFormat intermediate, uint32_t channelCount) {
+	MatrixFormat src;
+	MatrixFormat mid;
+	if (!MatrixFormatOf(from, src) || !MatrixFormatOf(intermediate, mid)) {
+		return false;
+	}
+	uint32_t const needed = src.componentCount < channelCount ? src.componentCount : channelCount;
+	if (mid.componentCount < needed) {
+		return false;
+	}
+	if (src.encoding == mid.encoding) {
+		return true;
+	}
+
+	NumericClass const srcClass = EncodingClasses[src.encoding];
+	NumericClass const midClass = EncodingClasses[mid.encoding];
+	uint32_t const srcBits = EncodingBits[src.encoding];
+	uint32_t const midBits = EncodingBits[mid.encoding];
+	if (midClass == NumericClass::SFloat && midBits == 32) {
+		return srcBits <= 16;
+	}
+	if (midClass == NumericClass::SFloat && midBits == 64) {
+		return srcBits <= 32 || srcClass == NumericClass::SFloat;
+	}
+	// widening integers, or unorm where 8 bit codes are exact 16 bit ones
+	return srcClass == midClass && midBits >= srcBits &&
+			(srcClass == NumericClass::UInt || srcClass == NumericClass::SInt || srcClass == NumericClass::UNorm);
+}
+
+void ConvertPlainPixels(PlainConverter const &converter, void const *src, void *dst, size_t pixelCount) {
+	if (converter.shuffle == nullptr) {
+		converter.values(src, dst, pixelCount, converter.srcComponentCount);
+		return;
+	}
+
+	// 4 components of up to 8 bytes, a whole source block is read before its
+	// destination block is written so in place works
+	uint64_t block[ConvertBlockPixelCount * 4];
+	auto s = (uint8_t const *) src;
+	auto d = (uint8_t *) dst;
+	for (size_t i = 0; i < pixelCount; i += ConvertBlockPixelCount) {
+		size_t const count = (pixelCount - i) < ConvertBlockPixelCount ? (pixelCount - i) : ConvertBlockPixelCount;
+		if (converter.shuffleFirst) {
+			converter.shuffle(s, block, count);
+			converter.values(block, d, count, converter.dstComponentCount);
+		} else {
+			converter.values(s, block, count, converter.srcComponentCount);
+			converter.shuffle(block, d, count);
+		}
+		s += count * converter.srcPixelSize;
+		d += count * converter.dstPixelSize;
+	}
+}
+
+} // end namespace Image
@@ -0,0 +1,53 @@
+// Conversions between plain formats (see PlainLayoutOf) of different
+// encodings. Every pair of value encodings and every pair of channel layouts
+// has its own template generated loop, with bit widths, numeric class and
+// swizzle fixed at compile time, so only the loops for a pair of formats are
+// picked at run time
+#ifndef WYRD_IMAGE_CONVERT_MATRIX_HPP
+#define WYRD_IMAGE_CONVERT_MATRIX_HPP
+
+#include "al2o3_platform/platform.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+
+namespace Image {
+
+// converts the values of pixelCount pixels of componentCount components from
+// one encoding to another, in place when the destination values are no larger
+typedef void (*PlainValueConvertFunc)(void const *src, void *dst, size_t pixelCount, uint32_t componentCount);
+
+// reorders, drops or adds channels of pixelCount pixels of one encoding
+typedef void (*PlainShuffleFunc)(void const *src, void *dst, size_t pixelCount);
+
+struct PlainConverter {
+	PlainValueConvertFunc values;
+	// nullptr when both formats have the same channels in the same order
+	PlainShuffleFunc shuffle;
+	// shuffle before converting the values, when the destination has fewer
+	// channels, otherwise after
+	bool shuffleFirst;
+	uint32_t srcComponentCount;
+	uint32_t dstComponentCount;
+	uint32_t srcPixelSize;
+	uint32_t dstPixelSize;
+	// estimated cost in rough cycles per pixel
+	float cost;
+};
+
+// false if either format isn't plain with an encoding and channel order the
+// matrix has loops for (R, RG, RGB, BGR, RGBA or BGRA)
+bool PlainConverterOf(TinyImageFormat srcFormat, TinyImageFormat dstFormat, PlainConverter &converter);
+
+// true if converting through intermediate, from from and on to a format
+// with channelCount channels, gives the same result as converting directly
+// (bar rounding): intermediate has at least the channels needed and holds
+// every value of from, e.g. half or 8 bit formats through float
+bool PlainIntermediateHolds(TinyImageFormat from, TinyImageFormat intermediate, uint32_t channelCount);
+
+// converts pixelCount pixels the same as decoding to logical pixels and
+// encoding them again. src and dst may be the same memory if the destination
+// pixels are no larger than the source ones
+void ConvertPlainPixels(PlainConverter const &converter, void const *src, void *dst, size_t pixelCount);
+
+} // end namespace Image
+
+#endif //WYRD_IMAGE_CONVERT_MATRIX_HPP
@@ -0,0 +1,310 @@
+#include "al2o3_platform/platform.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "tiny_imageformat/tinyimageformat_query.h"
+#include "tiny_imageformat/tinyimageformat_decode.h"
+#include "tiny_imageformat/tinyimageformat_encode.h"
+#include "gfx_image/image.h"
+#include "convert_kernels.hpp"
+#include "copy.hpp"
+#include "format_info.hpp"
+#include "view.hpp"
+#include <cstring>
+#include <vector>
+
+namespace {
+
+bool SameEncoding(TinyImageFormat a, TinyImageFormat b) {
+	return TinyImageFormat_IsFloat(a) == TinyImageFormat_IsFloat(b) &&
+			TinyImageFormat_IsSigned(a) == TinyImageFormat_IsSigned(b) &&
+			TinyImageFormat_IsNormalised(a) == TinyImageFormat_IsNormalised(b) &&
+			TinyImageFormat_IsSRGB(a) == TinyImageFormat_IsSRGB(b);
+}
+
+bool SourceIs(Image::CopyPlan const &plan, int32_t s0, int32_t s1, int32_t s2, int32_t s3) {
+	return plan.source[0] == s0 && plan.source[1] == s1 && plan.source[2] == s2 && plan.source[3] == s3;
+}
+
+// decode rows go through a per thread buffer that only ever grows, so copies
+// don't allocate (or use stack proportional to the width) per row
+template<typename T>
+T *RowScratch(size_t count) {
+	thread_local std::vector<T> scratch;
+	if (scratch.size() < count) {
+		scratch.resize(count);
+	}
+	return scratch.data();
+}
+
+template<typename T>
+void ShuffleComponents(Image::CopyPlan const &plan, T const *src, T *dst, size_t pixelCount) {
+	uint32_t const srcCount = plan.srcComponentCount;
+	uint32_t const dstCount = plan.dstComponentCount;
+	T constant[4];
+	memcpy(constant, plan.constant, sizeof(T) * dstCount);
+
+	for (size_t i = 0; i < pixelCount; ++i) {
+		for (uint32_t c = 0; c < dstCount; ++c) {
+			int32_t const s = plan.source[c];
+			dst[c] = s >= 0 ? src[s] : constant[c];
+		}
+		src += srcCount;
+		dst += dstCount;
+	}
+}
+
+// the direct kinds work on any contiguous run of pixels
+void CopyPixelRange(Image::CopyPlan const &plan, uint8_t const *src, uint8_t *dst, size_t pixelCount) {
+	using namespace Image;
+	switch (plan.kind) {
+	case CopyKind::RGBA8ToBGRA8: SwizzleRGBA8ToBGRA8(src, dst, pixelCount);
+		break;
+	case CopyKind::RGB8ToRGBA8: SwizzleRGB8ToRGBA8(src, dst, pixelCount, plan.constant[3]);
+		break;
+	case CopyKind::Shuffle:
+		switch (plan.componentBytes) {
+		case 1: ShuffleComponents(plan, (uint8_t const *) src, (uint8_t *) dst, pixelCount);
+			break;
+		case 2: ShuffleComponents(plan, (uint16_t const *) src, (uint16_t *) dst, pixelCount);
+			break;
+		case 4: ShuffleComponents(plan, (uint32_t const *) src, (uint32_t *) dst, pixelCount);
+			break;
+		case 8: ShuffleComponents(plan, (uint64_t const *) src, (uint64_t *) dst, pixelCount);
+			break;
+		default: ASSERT(false);
+			break;
+		}
+		break;
+	case CopyKind::PlainConvert: ConvertPlainPixels(plan.converter, src, dst, pixelCount);
+		break;
+	default: ASSERT(false);
+		break;
+	}
+}
+
+size_t PageByteOffset(Image_ImageHeader const *image, uint32_t z, uint32_t w) {
+	return ((size_t) w * image->depth + z) * Image_ByteCountPerPageOf(image);
+}
+
+size_t PixelSizeOf(Image_ImageHeader const *image) {
+	return TinyImageFormat_BitSizeOfBlock(image->format) / 8;
+}
+
+} // end anon namespace
+
+namespace Image {
+
+CopyPlan PlanCopy(TinyImageFormat srcFormat, TinyImageFormat dstFormat) {
+	CopyPlan plan = {};
+	if (srcFormat == dstFormat) {
+		plan.kind = CopyKind::Memcpy;
+		return plan;
+	}
+
+	PlainLayout const srcLayout = PlainLayoutOf(srcFormat);
+	PlainLayout const dstLayout = PlainLayoutOf(dstFormat);
+	if (srcLayout.plain && dstLayout.plain && srcLayout.bits == dstLayout.bits && dstLayout.componentCount <= 4 &&
+			SameEncoding(srcFormat, dstFormat) && TinyImageFormat_CanEncodeLogicalPixelsF(dstFormat)) {
+		plan.componentBytes = srcLayout.bits / 8;
+		plan.srcComponentCount = srcLayout.componentCount;
+		plan.dstComponentCount = dstLayout.componentCount;
+
+		bool identity = srcLayout.componentCount == dstLayout.componentCount;
+		for (uint32_t i = 0; i < 4; ++i) {
+			plan.source[i] = -1;
+			if (i >= dstLayout.componentCount) {
+				continue;
+			}
+			TinyImageFormat_LogicalChannel const lc = TinyImageFormat_PhysicalChannelToLogical(dstFormat, (int) i);
+			if (lc >= 0) {
+				TinyImageFormat_PhysicalChannel const pc = TinyImageFormat_LogicalChannelToPhysical(srcFormat, lc);
+				plan.source[i] = pc >= 0 ? (int32_t) pc : -1;
+			}
+			identity = identity && plan.source[i] == (int32_t) i;
+		}
+		if (identity) {
+			plan.kind = CopyKind::Memcpy;
+			return plan;
+		}
+
+		float const zeroZeroZeroOne[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+		TinyImageFormat_EncodeOutput output{plan.constant};
+		TinyImageFormat_EncodeLogicalPixelsF(dstFormat, zeroZeroZeroOne, 1, &output);
+
+		plan.kind = CopyKind::Shuffle;
+		if (plan.componentBytes == 1 && plan.dstComponentCount == 4) {
+			if (plan.srcComponentCount == 4 && SourceIs(plan, 2, 1, 0, 3)) {
+				plan.kind = CopyKind::RGBA8ToBGRA8;
+			} else if (plan.srcComponentCount == 3 && SourceIs(plan, 0, 1, 2, -1)) {
+				plan.kind = CopyKind::RGB8ToRGBA8;
+			}
+		}
+		return plan;
+	}
+
+	if (PlainConverterOf(srcFormat, dstFormat, plan.converter)) {
+		plan.kind = CopyKind::PlainConvert;
+	} else if (TinyImageFormat_CanDecodeLogicalPixelsF(srcFormat) && TinyImageFormat_CanEncodeLogicalPixelsF(dstFormat)) {
+		plan.kind = CopyKind::DecodeF;
+	} else if (TinyImageFormat_CanDecodeLogicalPixelsD(srcFormat) && TinyImageFormat_CanEncodeLogicalPixelsD(dstFormat)) {
+		plan.kind = CopyKind::DecodeD;
+	} else {
+		plan.kind = CopyKind::Unsupported;
+	}
+	return plan;
+}
+
+void CopyPages(CopyPlan const &plan,
+							 Image_ImageHeader const *src, uint32_t sz, uint32_t sw,
+							 Image_ImageHeader const *dst, uint32_t dz, uint32_t dw,
+							 uint32_t pageCount) {
+	ASSERT(dst->width == src->width);
+	ASSERT(dst->height == src->height);
+
+	switch (plan.kind) {
+	case CopyKind::Memcpy: {
+		size_t const byteCount = pageCount * Image_ByteCountPerPageOf(src);
+		memcpy(((uint8_t *) Image_RawDataPtr(dst)) + PageByteOffset(dst, dz, dw),
+					 ((uint8_t const *) Image_RawDataPtr(src)) + PageByteOffset(src, sz, sw),
+					 byteCount);
+		break;
+	}
+	case CopyKind::RGBA8ToBGRA8:
+	case CopyKind::RGB8ToRGBA8:
+	case CopyKind::Shuffle:
+	case CopyKind::PlainConvert: {
+		size_t const pixelCount = pageCount * Image_PixelCountPerPageOf(src);
+		CopyPixelRange(plan,
+									 ((uint8_t const *) Image_RawDataPtr(src)) + Image_CalculateIndex(src, 0, 0, sz, sw) * PixelSizeOf(src),
+									 ((uint8_t *) Image_RawDataPtr(dst)) + Image_CalculateIndex(dst, 0, 0, dz, dw) * PixelSizeOf(dst),
+									 pixelCount);
+		break;
+	}
+	default: {
+		uint32_t const rowCount = src->height / TinyImageFormat_HeightOfBlock(src->format);
+		uint32_t const srcPage = sw * src->depth + sz;
+		uint32_t const dstPage = dw * dst->depth + dz;
+		for (uint32_t p = 0; p < pageCount; ++p) {
+			CopyRows(plan,
+							 src, 0, (srcPage + p) % src->depth, (srcPage + p) / src->depth,
+							 dst, 0, (dstPage + p) % dst->depth, (dstPage + p) / dst->depth,
+							 rowCount);
+		}
+		break;
+	}
+	}
+}
+
+void CopyRows(CopyPlan const &plan,
+							Image_ImageHeader const *src, uint32_t sy, uint32_t sz, uint32_t sw,
+							Image_ImageHeader const *dst, uint32_t dy, uint32_t dz, uint32_t dw,
+							uint32_t rowCount) {
+	ASSERT(dst->width == src->width);
+
+	switch (plan.kind) {
+	case CopyKind::Memcpy: {
+		size_t const rowBytes = Image_ByteCountPerRowOf(src);
+		memcpy(((uint8_t *) Image_RawDataPtr(dst)) + PageByteOffset(dst, dz, dw) + dy * rowBytes,
+					 ((uint8_t const *) Image_RawDataPtr(src)) + PageByteOffset(src, sz, sw) + sy * rowBytes,
+					 rowCount * rowBytes);
+		break;
+	}
+	case CopyKind::RGBA8ToBGRA8:
+	case CopyKind::RGB8ToRGBA8:
+	case CopyKind::Shuffle:
+	case CopyKind::PlainConvert: {
+		CopyPixelRange(plan,
+									 ((uint8_t const *) Image_RawDataPtr(src)) + Image_CalculateIndex(src, 0, sy, sz, sw) * PixelSizeOf(src),
+									 ((uint8_t *) Image_RawDataPtr(dst)) + Image_CalculateIndex(dst, 0, dy, dz, dw) * PixelSizeOf(dst),
+									 (size_t) rowCount * src->width);
+		break;
+	}
+	case CopyKind::DecodeF:
+	case CopyKind::DecodeD: {
+		uint32_t const widthOfBlock = TinyImageFormat_WidthOfBlock(src->format);
+		uint32_t const pixelCountOfBlock = TinyImageFormat_PixelCountOfBlock(src->format);
+		size_t const rowBufferCount = (size_t) (src->width / widthOfBlock) * pixelCountOfBlock * 4;
+		for (uint32_t r = 0; r < rowCount; ++r) {
+			size_t const srcIndex = Image_CalculateIndex(src, 0, sy + r, sz, sw);
+			size_t const dstIndex = Image_CalculateIndex(dst, 0, dy + r, dz, dw);
+			if (plan.kind == CopyKind::DecodeF) {
+				float *rowBuffer = RowScratch<float>(rowBufferCount);
+				Image_GetRowAtF(src, rowBuffer, srcIndex);
+				Image_SetRowAtF(dst, rowBuffer, dstIndex);
+			} else {
+				double *rowBuffer = RowScratch<double>(rowBufferCount);
+				Image_GetRowAtD(src, rowBuffer, srcIndex);
+				Image_SetRowAtD(dst, rowBuffer, dstIndex);
+			}
+		}
+		break;
+	}
+	case CopyKind::Unsupported:
+		// TODO better error
+		// we can't decode and/or encode between these formats so die
+		ASSERT(false);
+		break;
+	}
+}
+
+bool CopyView(CopyPlan const &plan, Image_View const &src, Image_View const &dst) {
+	ASSERT(src.width == dst.width);
+	ASSERT(src.height == dst.height);
+	ASSERT(src.depth == dst.depth);
+	ASSERT(src.slices == dst.slices);
+
+	size_t const rowCount = RowCountOf(src);
+	bool const contiguous = IsContiguous(src) && IsContiguous(dst);
+	switch (plan.kind) {
+	case CopyKind::Memcpy: {
+		size_t const rowBytes = BlocksPerRowOf(src) * BlockSizeOf(src);
+		if (contiguous) {
+			memcpy(dst.data, src.data, rowCount * rowBytes);
+		} else {
+			for (size_t r = 0; r < rowCount; ++r) {
+				memcpy(RowPtrOf(dst, r), RowPtrOf(src, r), rowBytes);
+			}
+		}
+		return true;
+	}
+	case CopyKind::RGBA8ToBGRA8:
+	case CopyKind::RGB8ToRGBA8:
+	case CopyKind::Shuffle:
+	case CopyKind::PlainConvert:
+		if (contiguous) {
+			CopyPixelRange(plan, (uint8_t const *) src.data, (uint8_t *) dst.data, PixelCountOf(src));
+		} else {
+			for (size_t r = 0; r < rowCount; ++r) {
+				CopyPixelRange(plan, RowPtrOf(src, r), RowPtrOf(dst, r), src.width);
+			}
+		}
+		return true;
+	case CopyKind::DecodeF:
+	case CopyKind::DecodeD: {
+		// rows of differently shaped blocks don't hold the same pixels
+		if (TinyImageFormat_WidthOfBlock(src.format) != TinyImageFormat_WidthOfBlock(dst.format) ||
+				TinyImageFormat_HeightOfBlock(src.format) != TinyImageFormat_HeightOfBlock(dst.format)) {
+			return false;
+		}
+		uint32_t const blockCount = BlocksPerRowOf(src);
+		size_t const rowBufferCount = (size_t) blockCount * TinyImageFormat_PixelCountOfBlock(src.format) * 4;
+		for (size_t r = 0; r < rowCount; ++r) {
+			TinyImageFormat_FetchInput input{RowPtrOf(src, r)};
+			TinyImageFormat_EncodeOutput output{RowPtrOf(dst, r)};
+			if (plan.kind == CopyKind::DecodeF) {
+				float *rowBuffer = RowScratch<float>(rowBufferCount);
+				TinyImageFormat_DecodeLogicalPixelsF(src.format, &input, blockCount, rowBuffer);
+				TinyImageFormat_EncodeLogicalPixelsF(dst.format, rowBuffer, BlocksPerRowOf(dst), &output);
+			} else {
+				double *rowBuffer = RowScratch<double>(rowBufferCount);
+				TinyImageFormat_DecodeLogicalPixelsD(src.format, &input, blockCount, rowBuffer);
+				TinyImageFormat_EncodeLogicalPixelsD(dst.format, rowBuffer, BlocksPerRowOf(dst), &output);
+			}
+		}
+		return true;
+	}
+	case CopyKind::Unsupported: break;
+	}
+	return false;
+}
+
+} // end namespace Image
@@ -0,0 +1,72 @@
+// Copy engine behind the Image_Copy* functions. The format pair is classified
+// once into a plan that picks a memcpy, a direct channel shuffle, a converter
+// matrix loop or the decode and encode fallback, which is then applied to any
+// number of rows
+#ifndef WYRD_IMAGE_COPY_HPP
+#define WYRD_IMAGE_COPY_HPP
+
+#include "al2o3_platform/platform.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "gfx_image/image.h"
+#include "gfx_image_impl_basic/view.h"
+#include "convert_matrix.hpp"
+
+namespace Image {
+
+enum class CopyKind {
+	// identical storage
+	Memcpy,
+	// 8 bit red and blue swap
+	RGBA8ToBGRA8,
+	// 8 bit 3 channels to 4 with a constant alpha
+	RGB8ToRGBA8,
+	// any other channel subset or swizzle between formats with the same encoding
+	Shuffle,
+	// plain formats of different encodings, the converter matrix loops
+	PlainConvert,
+	// decode to float then encode
+	DecodeF,
+	// decode to double then encode, for formats floats can't hold
+	DecodeD,
+	// neither format can be decoded or encoded
+	Unsupported,
+};
+
+struct CopyPlan {
+	CopyKind kind;
+	uint32_t componentBytes;
+	uint32_t srcComponentCount;
+	uint32_t dstComponentCount;
+	// source component of each destination component, -1 takes the constant
+	int32_t source[4];
+	// {0, 0, 0, 1} encoded in the destination format, what missing channels
+	// read as, the same values the decode path would produce
+	uint8_t constant[32];
+	// the loops for PlainConvert
+	PlainConverter converter;
+};
+
+CopyPlan PlanCopy(TinyImageFormat srcFormat, TinyImageFormat dstFormat);
+
+// copies pageCount consecutive pages, in z then slice order, starting at page
+// (sz, sw) of src to the pages starting at (dz, dw) of dst. Both must have
+// the same width and height
+void CopyPages(CopyPlan const &plan,
+							 Image_ImageHeader const *src, uint32_t sz, uint32_t sw,
+							 Image_ImageHeader const *dst, uint32_t dz, uint32_t dw,
+							 uint32_t pageCount);
+
+// copies rowCount rows (of blocks) starting at row sy of page (sz, sw) of
+// src to rows starting at dy of page (dz, dw) of dst
+void CopyRows(CopyPlan const &plan,
+							Image_ImageHeader const *src, uint32_t sy, uint32_t sz, uint32_t sw,
+							Image_ImageHeader const *dst, uint32_t dy, uint32_t dz, uint32_t dw,
+							uint32_t rowCount);
+
+// copies every pixel of src to dst, views of the same extent. False for
+// an Unsupported plan
+bool CopyView(CopyPlan const &plan, Image_View const &src, Image_View const &dst);
+
+} // end namespace Image
+
+#endif //WYRD_IMAGE_COPY_HPP
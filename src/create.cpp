@@ -4,25 +4,18 @@
 #include "tiny_imageformat/tinyimageformat_query.h"
 #include "gfx_image/image.h"
 #include "gfx_image/create.h"
+#include "gfx_image_impl_basic/allocator.h"
+#include "allocator.hpp"
 
-AL2O3_EXTERN_C Image_ImageHeader const *Image_Create(uint32_t width,
-																										 uint32_t height,
-																										 uint32_t depth,
-																										 uint32_t slices,
-																										 TinyImageFormat format) {
-	auto image = Image_CreateNoClear(width, height, depth, slices, format);
-	if (image) {
-		memset(Image_RawDataPtr(image), 0, image->dataSize);
-	}
+namespace {
 
-	return image;
-}
-
-AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateNoClear(uint32_t width,
-																														uint32_t height,
-																														uint32_t depth,
-																														uint32_t slices,
-																														TinyImageFormat format) {
+Image_ImageHeader const *CreateFrom(Image_Allocator *allocator,
+																		uint32_t width,
+																		uint32_t height,
+																		uint32_t depth,
+																		uint32_t slices,
+																		TinyImageFormat format,
+																		bool clear) {
 	if(width == 0)return nullptr;
 	if (format == TinyImageFormat_UNDEFINED) return nullptr;
 	if(height == 0) height = 1;
@@ -32,13 +25,50 @@ AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateNoClear(uint32_t width,
 	Image_ImageHeader tmp;
 	Image_FillHeader(width, height, depth, slices, format, &tmp);
 
-	auto *image = (Image_ImageHeader *) MEMORY_MALLOC(sizeof(Image_ImageHeader) + tmp.dataSize);
+	auto *image = Image::AllocateImage(allocator, tmp.dataSize, clear);
 	if (!image) { return nullptr; }
 
 	memcpy(image, &tmp, sizeof(Image_ImageHeader));
 
 	return image;
 }
+
+} // end anon namespace
+
+AL2O3_EXTERN_C Image_ImageHeader const *Image_Create(uint32_t width,
+																										 uint32_t height,
+																										 uint32_t depth,
+																										 uint32_t slices,
+																										 TinyImageFormat format) {
+	return Image_CreateWithAllocator(Image_GetThreadAllocator(), width, height, depth, slices, format);
+}
+
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateNoClear(uint32_t width,
+																														uint32_t height,
+																														uint32_t depth,
+																														uint32_t slices,
+																														TinyImageFormat format) {
+	return CreateFrom(Image_GetThreadAllocator(), width, height, depth, slices, format, false);
+}
+
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateWithAllocator(Image_Allocator *allocator,
+																																	uint32_t width,
+																																	uint32_t height,
+																																	uint32_t depth,
+																																	uint32_t slices,
+																																	TinyImageFormat format) {
+	return CreateFrom(allocator, width, height, depth, slices, format, true);
+}
+
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateNoClearWithAllocator(Image_Allocator *allocator,
+																																				 uint32_t width,
+																																				 uint32_t height,
+																																				 uint32_t depth,
+																																				 uint32_t slices,
+																																				 TinyImageFormat format) {
+	return CreateFrom(allocator, width, height, depth, slices, format, false);
+}
+
 AL2O3_EXTERN_C void Image_FillHeader(uint32_t width,
 																		 uint32_t height,
 																		 uint32_t depth,
@@ -81,7 +111,7 @@ AL2O3_EXTERN_C Image_ImageHeader const* Image_CreateHeaderOnly(	uint32_t width,
 																																 uint32_t depth,
 																																 uint32_t slices,
 																																 TinyImageFormat format) {
-	auto *image = (Image_ImageHeader *) MEMORY_MALLOC(sizeof(Image_ImageHeader));
+	auto *image = Image::AllocateImage(0, false);
 	if (!image) { return nullptr; }
 	Image_FillHeader(width, height, depth, slices, format, image);
 
@@ -89,14 +119,15 @@ AL2O3_EXTERN_C Image_ImageHeader const* Image_CreateHeaderOnly(	uint32_t width,
 }
 
 AL2O3_EXTERN_C void Image_Destroy(Image_ImageHeader const *image) {
-	if(!image) return;
-
-	// recursively free next in image chain
-	if(image->nextType != Image_NT_None) {
-		Image_Destroy(image->nextImage);
+	// each link of a shared chain holds its own reference, a link is freed
+	// with its last one
+	while(image) {
+		Image_ImageHeader const *next = image->nextType != Image_NT_None ? image->nextImage : nullptr;
+		if(Image::ReleaseImage(image)) {
+			Image::FreeImage(image);
+		}
+		image = next;
 	}
-
-	MEMORY_FREE((Image_ImageHeader*)image);
 }
 
 AL2O3_EXTERN_C Image_ImageHeader const * Image_Create1D(uint32_t width, enum TinyImageFormat format) {
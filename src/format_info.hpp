@@ -0,0 +1,48 @@
+// Format queries shared by the kernels that walk stored pixels directly
+#ifndef WYRD_IMAGE_FORMAT_INFO_HPP
+#define WYRD_IMAGE_FORMAT_INFO_HPP
+
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "tiny_imageformat/tinyimageformat_query.h"
+
+namespace Image {
+
+// formats stored as componentCount channels all of the same bit width with no
+// blocks, packing or palette, i.e. a plain array of 8, 16, 32 or 64 bit values
+struct PlainLayout {
+	bool plain;
+	uint32_t bits;
+	uint32_t componentCount;
+};
+
+inline PlainLayout PlainLayoutOf(TinyImageFormat fmt) {
+	PlainLayout layout = {false, 0, 0};
+	if (TinyImageFormat_IsCompressed(fmt) || TinyImageFormat_IsCLUT(fmt) ||
+			TinyImageFormat_PixelCountOfBlock(fmt) != 1) {
+		return layout;
+	}
+
+	uint32_t const channelCount = TinyImageFormat_ChannelCount(fmt);
+	uint32_t bits = 0;
+	for (uint32_t i = 0; i < channelCount; ++i) {
+		TinyImageFormat_LogicalChannel const lc = TinyImageFormat_PhysicalChannelToLogical(fmt, (int) i);
+		uint32_t const channelBits = TinyImageFormat_ChannelBitWidth(fmt, lc);
+		if (i == 0) {
+			bits = channelBits;
+		} else if (channelBits != bits) {
+			return layout;
+		}
+	}
+	if (bits == 0 || (bits & 7) != 0 || TinyImageFormat_BitSizeOfBlock(fmt) != bits * channelCount) {
+		return layout;
+	}
+
+	layout.plain = true;
+	layout.bits = bits;
+	layout.componentCount = channelCount;
+	return layout;
+}
+
+} // end namespace Image
+
+#endif //WYRD_IMAGE_FORMAT_INFO_HPP
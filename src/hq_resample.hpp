@@ -5,6 +5,7 @@
 #include <cmath>
 #include <cstring>
 #include <algorithm>
+#include <vector>
 
 namespace Image {
 
@@ -33,6 +34,76 @@ void hq_resample(const unsigned int _channelCount,
                  const real _clampLow = real(0),
                  const real _clampHigh = real(1));
 
+// the 4 source indices and filter weights for one destination column or row
+template<typename real = float>
+struct hq_taps {
+  int index[4];
+  real weight[4];
+};
+
+// Separable version of hq_resample. The filter weights and clamped source
+// indices only depend on the destination column (horizontal) or row
+// (vertical), so are computed once per resize. Source rows are filtered
+// horizontally into a 4 row rolling window, each destination row is then a
+// weighted sum of 4 contiguous window rows. Gives the same results as
+// evaluating the filter per pixel.
+template<typename real = float>
+class hq_resampler {
+public:
+  hq_resampler(const unsigned int _channelCount,
+               const unsigned int _srcWidth,
+               const unsigned int _srcHeight,
+               const unsigned int _dstWidth,
+               const unsigned int _dstHeight,
+               const real _b = real(1) / real(3),
+               const real _c = real(1) / real(3),
+               const real _clampLow = real(0),
+               const real _clampHigh = real(1));
+
+  // resample destination rows [_dstRowBegin, _dstRowEnd) into _dstData, which
+  // receives them packed from its start. Is const so may be called from
+  // several threads at once, each row is the same whichever band it is in
+  void resample(const real *_srcData, real *_dstData,
+                const unsigned int _dstRowBegin, const unsigned int _dstRowEnd) const;
+
+  void resample(const real *_srcData, real *_dstData) const {
+    resample(_srcData, _dstData, 0, dstHeight);
+  }
+
+  // the 4 taps of each destination position along one axis, public so other
+  // axes (the depth of a volume) can be filtered with the same weights
+  static void build_taps(std::vector<hq_taps<real>> &_taps,
+                         const unsigned int _srcSize, const unsigned int _dstSize,
+                         const real _b, const real _c);
+
+private:
+  template<unsigned int channelCount>
+  void resample_rows(const real *_srcData, real *_dstData,
+                     const unsigned int _dstRowBegin, const unsigned int _dstRowEnd) const;
+
+  real clamp(real _v) const {
+    // this will pass unless clampLow is a NAN
+    if (clampLow == clampLow) {
+      _v = std::max(_v, clampLow);
+    }
+    // this will pass unless clampHigh is a NAN
+    if (clampHigh == clampHigh) {
+      _v = std::min(_v, clampHigh);
+    }
+    return _v;
+  }
+
+  unsigned int channelCount;
+  unsigned int srcWidth;
+  unsigned int srcHeight;
+  unsigned int dstWidth;
+  unsigned int dstHeight;
+  real clampLow;
+  real clampHigh;
+  std::vector<hq_taps<real>> xTaps;
+  std::vector<hq_taps<real>> yTaps;
+};
+
 // ------------------------------------------------------ MitchellNetravali ---
 // Mitchell Netravali reconstruction filter
 template<typename real>
@@ -67,6 +138,112 @@ real hq_interpolate(real x, real y0, real y1, real y2, real y3, real _b, real _c
   return r;
 }
 
+// ------------------------------------------------------------- resampler ---
+template<typename real>
+hq_resampler<real>::hq_resampler(const unsigned int _channelCount,
+                                 const unsigned int _srcWidth, const unsigned int _srcHeight,
+                                 const unsigned int _dstWidth, const unsigned int _dstHeight,
+                                 const real _b, const real _c, const real _clampLow, const real _clampHigh) :
+    channelCount(_channelCount),
+    srcWidth(_srcWidth),
+    srcHeight(_srcHeight),
+    dstWidth(_dstWidth),
+    dstHeight(_dstHeight),
+    clampLow(_clampLow),
+    clampHigh(_clampHigh) {
+  build_taps(xTaps, _srcWidth, _dstWidth, _b, _c);
+  build_taps(yTaps, _srcHeight, _dstHeight, _b, _c);
+}
+
+template<typename real>
+void hq_resampler<real>::build_taps(std::vector<hq_taps<real>> &_taps,
+                                    const unsigned int _srcSize, const unsigned int _dstSize,
+                                    const real _b, const real _c) {
+  using namespace std;
+
+  const real scale = _srcSize / (real) _dstSize;
+  _taps.resize(_dstSize);
+  for (unsigned int i = 0; i < _dstSize; ++i) {
+    const int src = (int) floor(((real) i) * scale);
+    for (int k = 0; k < 4; ++k) {
+      _taps[i].index[k] = min(max(0, src + k - 2), (int) _srcSize - 1);
+    }
+    const real x = (real) i / (real) _dstSize;
+    _taps[i].weight[0] = MitchellNetravali<real>(x - 2, _b, _c);
+    _taps[i].weight[1] = MitchellNetravali<real>(x - 1, _b, _c);
+    _taps[i].weight[2] = MitchellNetravali<real>(x + 0, _b, _c);
+    _taps[i].weight[3] = MitchellNetravali<real>(x + 1, _b, _c);
+  }
+}
+
+template<typename real>
+void hq_resampler<real>::resample(const real *_srcData, real *_dstData,
+                                  const unsigned int _dstRowBegin, const unsigned int _dstRowEnd) const {
+  // fixed channel counts let the compiler unroll and vectorise the inner loops
+  switch (channelCount) {
+    case 1: resample_rows<1>(_srcData, _dstData, _dstRowBegin, _dstRowEnd);
+      break;
+    case 2: resample_rows<2>(_srcData, _dstData, _dstRowBegin, _dstRowEnd);
+      break;
+    case 3: resample_rows<3>(_srcData, _dstData, _dstRowBegin, _dstRowEnd);
+      break;
+    case 4: resample_rows<4>(_srcData, _dstData, _dstRowBegin, _dstRowEnd);
+      break;
+    default: resample_rows<0>(_srcData, _dstData, _dstRowBegin, _dstRowEnd);
+      break;
+  }
+}
+
+template<typename real>
+template<unsigned int fixedChannelCount>
+void hq_resampler<real>::resample_rows(const real *_srcData, real *_dstData,
+                                       const unsigned int _dstRowBegin, const unsigned int _dstRowEnd) const {
+  // 0 is any channel count
+  const unsigned int C = fixedChannelCount ? fixedChannelCount : channelCount;
+  const size_t rowSize = (size_t) dstWidth * C;
+
+  // the horizontally filtered source rows, any 4 consecutive source rows land
+  // in different slots so the current taps never evict each other
+  std::vector<real> window(rowSize * 4);
+  int windowRow[4] = {-1, -1, -1, -1};
+
+  for (unsigned int j = _dstRowBegin; j < _dstRowEnd; ++j) {
+    const hq_taps<real> &yt = yTaps[j];
+    const real *rows[4];
+
+    for (int k = 0; k < 4; ++k) {
+      const int srcRow = yt.index[k];
+      real *row = window.data() + (size_t) (srcRow & 3) * rowSize;
+      rows[k] = row;
+      if (windowRow[srcRow & 3] == srcRow) {
+        continue;
+      }
+      windowRow[srcRow & 3] = srcRow;
+
+      // horizontal pass
+      const real *srcLine = _srcData + (size_t) srcRow * srcWidth * C;
+      for (unsigned int i = 0; i < dstWidth; ++i) {
+        const hq_taps<real> &xt = xTaps[i];
+        const real *s0 = srcLine + (size_t) xt.index[0] * C;
+        const real *s1 = srcLine + (size_t) xt.index[1] * C;
+        const real *s2 = srcLine + (size_t) xt.index[2] * C;
+        const real *s3 = srcLine + (size_t) xt.index[3] * C;
+        real *d = row + (size_t) i * C;
+        for (unsigned int c = 0; c < C; ++c) {
+          d[c] = clamp(xt.weight[0] * s0[c] + xt.weight[1] * s1[c] + xt.weight[2] * s2[c] + xt.weight[3] * s3[c]);
+        }
+      }
+    }
+
+    // vertical pass, all 4 rows are contiguous so this is a simple stream
+    real *dstLine = _dstData + (size_t) (j - _dstRowBegin) * rowSize;
+    for (size_t e = 0; e < rowSize; ++e) {
+      dstLine[e] = clamp(yt.weight[0] * rows[0][e] + yt.weight[1] * rows[1][e] +
+          yt.weight[2] * rows[2][e] + yt.weight[3] * rows[3][e]);
+    }
+  }
+}
+
 // ------------------------------------------------------------------ scale ---
 template<typename real>
 void hq_resample(const unsigned int _channelCount,
@@ -79,77 +256,12 @@ void hq_resample(const unsigned int _channelCount,
     memcpy(_dstData, _srcData, _srcWidth * _srcHeight * sizeof(real) * _channelCount);
     return;
   }
-  const real xscale = _srcWidth / (real) _dstWidth;
-  const real yscale = _srcHeight / (real) _dstHeight;
-
-  for (unsigned int j = 0; j < _dstHeight; ++j) {
-    for (unsigned int i = 0; i < _dstWidth; ++i) {
-      // genereate indices
-      const real rSrcI = ((real) i) * xscale;
-      const real rSrcJ = ((real) j) * yscale;
-      const int srcI = (int) floor(rSrcI);
-      const int srcJ = (int) floor(rSrcJ);
-      int i0 = min(max(0, srcI - 2), (int) _srcWidth - 1);
-      int i1 = min(max(0, srcI - 1), (int) _srcWidth - 1);
-      int i2 = min(max(0, srcI + 0), (int) _srcWidth - 1);
-      int i3 = min(max(0, srcI + 1), (int) _srcWidth - 1);
-      int j0 = min(max(0, srcJ - 2), (int) _srcHeight - 1);
-      int j1 = min(max(0, srcJ - 1), (int) _srcHeight - 1);
-      int j2 = min(max(0, srcJ + 0), (int) _srcHeight - 1);
-      int j3 = min(max(0, srcJ + 1), (int) _srcHeight - 1);
-
-      for (unsigned int c = 0; c < _channelCount; ++c) {
-        real t0 = hq_interpolate<real>((real) i / (real) _dstWidth,
-                                       _srcData[(((j0 * _srcWidth) + i0) * _channelCount) + c],
-                                       _srcData[(((j0 * _srcWidth) + i1) * _channelCount) + c],
-                                       _srcData[(((j0 * _srcWidth) + i2) * _channelCount) + c],
-                                       _srcData[(((j0 * _srcWidth) + i3) * _channelCount) + c],
-                                       _b, _c);
-        real t1 = hq_interpolate<real>((real) i / (real) _dstWidth,
-                                       _srcData[(((j1 * _srcWidth) + i0) * _channelCount) + c],
-                                       _srcData[(((j1 * _srcWidth) + i1) * _channelCount) + c],
-                                       _srcData[(((j1 * _srcWidth) + i2) * _channelCount) + c],
-                                       _srcData[(((j1 * _srcWidth) + i3) * _channelCount) + c],
-                                       _b, _c);
-        real t2 = hq_interpolate<real>((real) i / (real) _dstWidth,
-                                       _srcData[(((j2 * _srcWidth) + i0) * _channelCount) + c],
-                                       _srcData[(((j2 * _srcWidth) + i1) * _channelCount) + c],
-                                       _srcData[(((j2 * _srcWidth) + i2) * _channelCount) + c],
-                                       _srcData[(((j2 * _srcWidth) + i3) * _channelCount) + c],
-                                       _b, _c);
-        real t3 = hq_interpolate<real>((real) i / (real) _dstWidth,
-                                       _srcData[(((j3 * _srcWidth) + i0) * _channelCount) + c],
-                                       _srcData[(((j3 * _srcWidth) + i1) * _channelCount) + c],
-                                       _srcData[(((j3 * _srcWidth) + i2) * _channelCount) + c],
-                                       _srcData[(((j3 * _srcWidth) + i3) * _channelCount) + c],
-                                       _b, _c);
-        // this will pass unless _clampLow is a NAN
-        if (_clampLow == _clampLow) {
-          t0 = std::max(t0, _clampLow);
-          t1 = std::max(t1, _clampLow);
-          t2 = std::max(t2, _clampLow);
-          t3 = std::max(t3, _clampLow);
-        }
-        // this will pass unless _clampHigh is a NAN
-        if (_clampHigh == _clampHigh) {
-          t0 = std::min(t0, _clampHigh);
-          t1 = std::min(t1, _clampHigh);
-          t2 = std::min(t2, _clampHigh);
-          t3 = std::min(t3, _clampHigh);
-        }
 
-        real y = hq_interpolate<real>((real) j / (real) _dstHeight,
-                                      t0, t1, t2, t3, _b, _c);
-        if (_clampLow == _clampLow) {
-          y = std::max(y, _clampLow);
-        }
-        if (_clampHigh == _clampHigh) {
-          y = std::min(y, _clampHigh);
-        }
-        _dstData[(((j * _dstWidth) + i) * _channelCount) + c] = y;
-      }
-    }
-  }
+  hq_resampler<real> const resampler(_channelCount,
+                                     _srcWidth, _srcHeight,
+                                     _dstWidth, _dstHeight,
+                                     _b, _c, _clampLow, _clampHigh);
+  resampler.resample(_srcData, _dstData);
 }
 }
 
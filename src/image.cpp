@@ -4,63 +4,71 @@
 #include "tiny_imageformat/tinyimageformat_decode.h"
 #include "tiny_imageformat/tinyimageformat_encode.h"
 #include "gfx_image/image.h"
+#include "gfx_image_impl_basic/mapped.h"
+#include "levels.hpp"
 
+// chains look their links up in the level directory, the walks are for lone
+// images and chains without a recorded one
 AL2O3_EXTERN_C size_t Image_ByteCountOfImageChainOf(Image_ImageHeader const *image) {
-
-	size_t total = Image_ByteCountOf(image);
-
-	if(Image_HasPackedMipMaps(image)) {
-		return total;
+	// every packed level is in the one allocation
+	if (Image_HasPackedMipMaps(image)) {
+		return image->dataSize;
 	}
-
-	if(image->nextType != Image_NT_None && image->nextImage != nullptr) {
-		total += Image_ByteCountOfImageChainOf(image->nextImage);
+	if (Image::LevelDirectory const *directory = Image::LevelDirectoryOf(image)) {
+		return directory->chainByteCount;
 	}
 
+	size_t total = 0;
+	for (; image; image = image->nextType != Image_NT_None ? image->nextImage : nullptr) {
+		total += Image_ByteCountOf(image);
+	}
 	return total;
 }
+
 AL2O3_EXTERN_C size_t Image_LinkedImageCountOf(Image_ImageHeader const *image) {
-  size_t count = 1;
+	if (Image::LevelDirectory const *directory = Image::LevelDirectoryOf(image)) {
+		return directory->linkCount;
+	}
 
+	size_t count = 1;
 	while (image && image->nextImage != nullptr) {
-    count++;
-    image = image->nextImage;
-  }
-
-  return count;
+		count++;
+		image = image->nextImage;
+	}
+	return count;
 }
 
 AL2O3_EXTERN_C size_t Image_MipMapCountOf(Image_ImageHeader const *image) {
-	size_t count = 1;
-
-	if(Image_HasPackedMipMaps(image)) {
+	if (Image_HasPackedMipMaps(image)) {
 		return image->packedMipMapCount;
 	}
+	if (Image::LevelDirectory const *directory = Image::LevelDirectoryOf(image)) {
+		return directory->mipMapCount;
+	}
 
+	size_t count = 1;
 	while (image && image->nextType == Image_NT_MipMap && image->nextImage != nullptr) {
 		count++;
 		image = image->nextImage;
 	}
-
 	return count;
 }
 
 AL2O3_EXTERN_C Image_ImageHeader const *Image_LinkedImageOf(Image_ImageHeader const *image, size_t const index) {
-  size_t count = 0;
-
-  if(index > 0) {
-		ASSERT(Image_HasPackedMipMaps(image) == false)
+	if (index == 0) {
+		return image;
+	}
+	ASSERT(Image_HasPackedMipMaps(image) == false);
+	if (Image::LevelDirectory const *directory = Image::LevelDirectoryOf(image)) {
+		return index < directory->linkCount ? directory->levels[index].image : nullptr;
 	}
 
-  do {
-    if (count == index) {
-      return image;
-    }
-    count++;
-    image = image->nextImage;
-  }  while (image);
-
-return nullptr;
+	for (size_t count = 0; image; ++count, image = image->nextImage) {
+		if (count == index) {
+			return image;
+		}
+	}
+	return nullptr;
 }
 
 AL2O3_EXTERN_C bool Image_GetBlocksAtF(Image_ImageHeader const *image, float *pixels, size_t blockCount, size_t index) {
@@ -86,6 +94,8 @@ AL2O3_EXTERN_C bool Image_SetBlocksAtF(Image_ImageHeader const *image, float con
 	ASSERT(pixels);
 
 	if(!TinyImageFormat_CanEncodeLogicalPixelsF(image->format)) return false;
+	// its pages would fault
+	if(image->flags & Image_Flag_ReadOnly) return false;
 
 	uint32_t const pixelCount = TinyImageFormat_PixelCountOfBlock(image->format);
 
@@ -148,6 +158,8 @@ AL2O3_EXTERN_C bool Image_SetBlocksAtD(Image_ImageHeader const *image, double co
 	ASSERT(pixels);
 
 	if(!TinyImageFormat_CanEncodeLogicalPixelsD(image->format)) return false;
+	// its pages would fault
+	if(image->flags & Image_Flag_ReadOnly) return false;
 
 	uint32_t const pixelCount = TinyImageFormat_PixelCountOfBlock(image->format);
 
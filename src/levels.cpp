@@ -0,0 +1,210 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image_impl_basic/levels.h"
+#include "allocator.hpp"
+#include "levels.hpp"
+#include "mipmap.hpp"
+
+namespace {
+
+Image_LevelInfo LevelInfoOf(Image_ImageHeader const *image, Image_ImageHeader const *level, void *data, size_t offset) {
+	Image_LevelInfo info;
+	info.image = image;
+	info.data = data;
+	info.format = level->format;
+	info.width = level->width;
+	info.height = level->height;
+	info.depth = level->depth;
+	info.slices = level->slices;
+	info.offset = offset;
+	info.byteCount = Image_ByteCountOf(level);
+	return info;
+}
+
+Image_LevelInfo LevelInfoOfEntry(Image::LevelEntry const &entry) {
+	Image_ImageHeader const *image = entry.image;
+	if (!Image_HasPackedMipMaps(image)) {
+		return LevelInfoOf(image, image, Image_RawDataPtr(image), entry.offset);
+	}
+	Image_ImageHeader level;
+	Image_FillHeader(entry.width, entry.height, entry.depth, image->slices, image->format, &level);
+	return LevelInfoOf(image, &level, ((uint8_t *) Image_RawDataPtr(image)) + entry.offset, entry.offset);
+}
+
+// the link below link, nullptr at the end of the chain
+Image_ImageHeader const *NextLinkOf(Image_ImageHeader const *link) {
+	return link->nextType != Image_NT_None ? link->nextImage : nullptr;
+}
+
+// one walk of the links records everything the lookups need
+Image::LevelDirectory *BuildLevelDirectory(Image_ImageHeader const *image) {
+	using namespace Image;
+	uint32_t linkCount = 0;
+	for (Image_ImageHeader const *link = image; link; link = NextLinkOf(link)) {
+		++linkCount;
+	}
+	bool const packed = Image_HasPackedMipMaps(image);
+	uint32_t const levelCount = packed ? image->packedMipMapCount : linkCount;
+	auto directory = (LevelDirectory *) MEMORY_MALLOC(sizeof(LevelDirectory) + (levelCount - 1) * sizeof(LevelEntry));
+	if (!directory) {
+		return nullptr;
+	}
+	directory->headNext = image->nextImage;
+	directory->headDataSize = image->dataSize;
+	directory->headFormat = image->format;
+	directory->lastLink = image;
+	directory->linkCount = linkCount;
+	directory->retired = nullptr;
+	directory->levelCount = levelCount;
+
+	size_t offset = 0;
+	if (packed) {
+		// packed levels follow each other in one allocation, level 0 first
+		Image_ImageHeader level;
+		Image_FillHeader(image->width, image->height, image->depth, image->slices, image->format, &level);
+		for (uint32_t i = 0; i < levelCount; ++i) {
+			directory->levels[i] = {image, offset, level.width, level.height, level.depth};
+			offset += Image_ByteCountOf(&level);
+			Image_FillHeader(HalveDimension(level.width), HalveDimension(level.height), HalveDimension(level.depth),
+											 level.slices, level.format, &level);
+		}
+		directory->mipMapCount = levelCount;
+	} else {
+		directory->mipMapCount = 1;
+		bool mipMaps = true;
+		uint32_t i = 0;
+		for (Image_ImageHeader const *link = image; link; link = NextLinkOf(link), ++i) {
+			directory->levels[i] = {link, offset, 0, 0, 0};
+			directory->lastLink = link;
+			offset += Image_ByteCountOf(link);
+			mipMaps = mipMaps && link->nextType == Image_NT_MipMap && link->nextImage;
+			directory->mipMapCount += mipMaps ? 1 : 0;
+		}
+	}
+	directory->chainByteCount = offset;
+	return directory;
+}
+
+// directory still describes the chain image heads. The head is compared and
+// the links walked from it to check the chain still ends where it did, only
+// links still in the chain are read as one unlinked since may have been
+// freed. Relinking in between needs Image_ResetLevelDirectory
+bool MatchesChain(Image::LevelDirectory const *directory, Image_ImageHeader const *image) {
+	if (!directory || directory->headNext != image->nextImage || directory->headDataSize != image->dataSize ||
+			directory->headFormat != image->format) {
+		return false;
+	}
+	uint32_t linkCount = 1;
+	Image_ImageHeader const *link = image;
+	for (; NextLinkOf(link); link = NextLinkOf(link)) {
+		if (++linkCount > directory->linkCount) {
+			return false;
+		}
+	}
+	return linkCount == directory->linkCount && link == directory->lastLink;
+}
+
+} // end anon namespace
+
+Image::LevelDirectory const *Image::LevelDirectoryOf(Image_ImageHeader const *image) {
+	ASSERT(image);
+	if (!NextLinkOf(image) && !Image_HasPackedMipMaps(image)) {
+		return nullptr;
+	}
+	std::atomic<LevelDirectory *> *slot = LevelDirectorySlotOf(image);
+	if (!slot) {
+		return nullptr;
+	}
+	LevelDirectory const *current = slot->load(std::memory_order_acquire);
+	return MatchesChain(current, image) ? current : nullptr;
+}
+
+Image::LevelDirectory const *Image::RecordLevelDirectory(Image_ImageHeader const *image) {
+	ASSERT(image);
+	if (!NextLinkOf(image) && !Image_HasPackedMipMaps(image)) {
+		return nullptr;
+	}
+	std::atomic<LevelDirectory *> *slot = LevelDirectorySlotOf(image);
+	if (!slot) {
+		return nullptr;
+	}
+	LevelDirectory *current = slot->load(std::memory_order_acquire);
+	if (MatchesChain(current, image)) {
+		return current;
+	}
+
+	// built without a lock, if another thread installs one first use that
+	LevelDirectory *built = BuildLevelDirectory(image);
+	if (!built) {
+		return nullptr;
+	}
+	built->retired = current;
+	if (!slot->compare_exchange_strong(current, built, std::memory_order_acq_rel, std::memory_order_acquire)) {
+		built->retired = nullptr;
+		FreeLevelDirectory(built);
+		return current;
+	}
+	return built;
+}
+
+void Image::FreeLevelDirectory(LevelDirectory *directory) {
+	while (directory) {
+		LevelDirectory *retired = directory->retired;
+		MEMORY_FREE(directory);
+		directory = retired;
+	}
+}
+
+AL2O3_EXTERN_C size_t Image_LevelCountOf(Image_ImageHeader const *image) {
+	ASSERT(image);
+	if (Image_HasPackedMipMaps(image)) {
+		return image->packedMipMapCount;
+	}
+	return Image_LinkedImageCountOf(image);
+}
+
+AL2O3_EXTERN_C Image_LevelInfo Image_LevelInfoOf(Image_ImageHeader const *image, size_t level) {
+	ASSERT(image);
+	if (level == 0) {
+		return LevelInfoOf(image, image, Image_RawDataPtr(image), 0);
+	}
+	Image_LevelInfo const missing = {};
+	if (Image::LevelDirectory const *directory = Image::LevelDirectoryOf(image)) {
+		return level < directory->levelCount ? LevelInfoOfEntry(directory->levels[level]) : missing;
+	}
+
+	// chains without a recorded directory are walked to the level
+	size_t offset = 0;
+	if (Image_HasPackedMipMaps(image)) {
+		if (level >= image->packedMipMapCount) {
+			return missing;
+		}
+		Image_ImageHeader header;
+		Image_FillHeader(image->width, image->height, image->depth, image->slices, image->format, &header);
+		for (size_t i = 0; i < level; ++i) {
+			offset += Image_ByteCountOf(&header);
+			Image_FillHeader(Image::HalveDimension(header.width), Image::HalveDimension(header.height),
+											 Image::HalveDimension(header.depth), header.slices, header.format, &header);
+		}
+		return LevelInfoOf(image, &header, ((uint8_t *) Image_RawDataPtr(image)) + offset, offset);
+	}
+	Image_ImageHeader const *link = image;
+	for (size_t i = 0; i < level; ++i) {
+		if (!NextLinkOf(link)) {
+			return missing;
+		}
+		offset += Image_ByteCountOf(link);
+		link = link->nextImage;
+	}
+	return LevelInfoOf(link, link, Image_RawDataPtr(link), offset);
+}
+
+AL2O3_EXTERN_C void Image_ResetLevelDirectory(Image_ImageHeader const *image) {
+	ASSERT(image);
+	if (std::atomic<Image::LevelDirectory *> *slot = Image::LevelDirectorySlotOf(image)) {
+		Image::FreeLevelDirectory(slot->exchange(nullptr, std::memory_order_acq_rel));
+	}
+}
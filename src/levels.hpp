@@ -0,0 +1,66 @@
+// The level directory of a chain, every link (or packed mip level) with its
+// offset so the lookups don't recompute them. Recorded on the head by the
+// functions here that build chains, lookups of any other chain walk it. Each
+// lookup checks the directory with a walk of the link pointers, one whose
+// head has been relinked or whose chain no longer ends at its last link is
+// ignored.
+// Formats and sizes are read from the links on every lookup so converting a
+// chain in place is seen
+#ifndef WYRD_IMAGE_LEVELS_HPP
+#define WYRD_IMAGE_LEVELS_HPP
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image_impl_basic/levels.h"
+
+namespace Image {
+
+// where a level is, its format and size come from the link (or for packed
+// mip maps the head) when looked up
+struct LevelEntry {
+	// the link holding the level, the head for packed mip maps
+	Image_ImageHeader const *image;
+	size_t offset;
+	// packed mip maps only, links have their own
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+};
+
+struct LevelDirectory {
+	// what the head looked like when this was built, a mismatch means stale
+	Image_ImageHeader const *headNext;
+	uint64_t headDataSize;
+	TinyImageFormat headFormat;
+	// the last link, only compared (never read) as it may since have been
+	// unlinked and freed
+	Image_ImageHeader const *lastLink;
+
+	uint32_t linkCount;
+	uint32_t mipMapCount;
+	size_t chainByteCount;
+
+	// replaced directories, kept until the image is freed as other threads
+	// may still be reading them
+	LevelDirectory *retired;
+
+	// linkCount links or for packed mip maps packedMipMapCount levels
+	uint32_t levelCount;
+	LevelEntry levels[1];
+};
+
+// the recorded directory of the chain image heads if it still matches the
+// chain, otherwise nullptr and the lookup walks the chain
+LevelDirectory const *LevelDirectoryOf(Image_ImageHeader const *image);
+
+// records (or replaces a stale) directory for the chain image heads, for
+// chains built here once they are linked. Nothing for a lone image (nothing
+// to walk) or chains that can't cache one (from an arena)
+LevelDirectory const *RecordLevelDirectory(Image_ImageHeader const *image);
+
+// frees directory and every directory it retired
+void FreeLevelDirectory(LevelDirectory *directory);
+
+} // end namespace Image
+
+#endif //WYRD_IMAGE_LEVELS_HPP
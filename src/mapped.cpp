@@ -0,0 +1,269 @@
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image_impl_basic/mapped.h"
+#include "allocator.hpp"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// The pixel data must directly follow the header, so each mapped image is one
+// granule of ordinary memory (MappingInfo at its start, the allocation prefix
+// and header at its end) with the file mapped immediately after it
+struct MappingInfo {
+	size_t headerAreaSize;
+	size_t dataSize;
+	Image_MapMode mode;
+};
+
+#if defined(_WIN32)
+
+size_t Granularity() {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwAllocationGranularity;
+}
+
+uint8_t *MapAfterHeaderArea(char const *fileName,
+														uint64_t offset,
+														size_t length,
+														Image_MapMode mode,
+														bool create,
+														size_t headerAreaSize) {
+	DWORD const fileAccess = mode == Image_MM_ReadWrite ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+	HANDLE file = CreateFileA(fileName, fileAccess, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+														create ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return nullptr;
+	}
+
+	LARGE_INTEGER fileSize;
+	uint64_t const end = offset + length;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return nullptr;
+	}
+	if ((uint64_t) fileSize.QuadPart < end) {
+		LARGE_INTEGER newSize;
+		newSize.QuadPart = (LONGLONG) end;
+		if (!create || !SetFilePointerEx(file, newSize, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+			LOGERROR("%s is too short to map %llu bytes at %llu", fileName,
+							 (unsigned long long) length, (unsigned long long) offset);
+			CloseHandle(file);
+			return nullptr;
+		}
+	}
+
+	DWORD const protect = mode == Image_MM_ReadOnly ? PAGE_READONLY :
+												mode == Image_MM_CopyOnWrite ? PAGE_WRITECOPY : PAGE_READWRITE;
+	DWORD const viewAccess = mode == Image_MM_ReadOnly ? FILE_MAP_READ :
+													 mode == Image_MM_CopyOnWrite ? FILE_MAP_COPY : FILE_MAP_WRITE;
+	HANDLE mapping = CreateFileMappingA(file, nullptr, protect, 0, 0, nullptr);
+	// the mapping and then the view keep the file open
+	CloseHandle(file);
+	if (!mapping) {
+		return nullptr;
+	}
+
+	// there is no way to map a view over part of a reservation, so find a big
+	// enough hole, release it and place both halves in it. Another thread can
+	// take the hole in between, in which case try again
+	uint8_t *result = nullptr;
+	for (int attempt = 0; attempt < 8 && !result; ++attempt) {
+		auto hole = (uint8_t *) VirtualAlloc(nullptr, headerAreaSize + length, MEM_RESERVE, PAGE_NOACCESS);
+		if (!hole) {
+			break;
+		}
+		VirtualFree(hole, 0, MEM_RELEASE);
+		void *header = VirtualAlloc(hole, headerAreaSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		void *view = MapViewOfFileEx(mapping, viewAccess, (DWORD) (offset >> 32), (DWORD) offset,
+																 length, hole + headerAreaSize);
+		if (header && view) {
+			result = hole;
+		} else {
+			if (view) {
+				UnmapViewOfFile(view);
+			}
+			if (header) {
+				VirtualFree(header, 0, MEM_RELEASE);
+			}
+		}
+	}
+	CloseHandle(mapping);
+	return result;
+}
+
+void Unmap(void *base) {
+	auto info = (MappingInfo const *) base;
+	UnmapViewOfFile((uint8_t *) base + info->headerAreaSize);
+	VirtualFree(base, 0, MEM_RELEASE);
+}
+
+bool Flush(void *base) {
+	auto info = (MappingInfo const *) base;
+	return FlushViewOfFile((uint8_t *) base + info->headerAreaSize, info->dataSize) != 0;
+}
+
+#else
+
+size_t Granularity() {
+	return (size_t) sysconf(_SC_PAGESIZE);
+}
+
+uint8_t *MapAfterHeaderArea(char const *fileName,
+														uint64_t offset,
+														size_t length,
+														Image_MapMode mode,
+														bool create,
+														size_t headerAreaSize) {
+	// a private mapping can be written without write access to the file
+	int const openFlags = mode == Image_MM_ReadWrite ? O_RDWR | (create ? O_CREAT : 0) : O_RDONLY;
+	int const fd = open(fileName, openFlags, 0644);
+	if (fd < 0) {
+		return nullptr;
+	}
+
+	struct stat fileStat;
+	uint64_t const end = offset + length;
+	if (fstat(fd, &fileStat) != 0) {
+		close(fd);
+		return nullptr;
+	}
+	if ((uint64_t) fileStat.st_size < end) {
+		if (!create || ftruncate(fd, (off_t) end) != 0) {
+			LOGERROR("%s is too short to map %llu bytes at %llu", fileName,
+							 (unsigned long long) length, (unsigned long long) offset);
+			close(fd);
+			return nullptr;
+		}
+	}
+
+	// reserve the whole range so the file can be mapped over its tail
+	size_t const total = headerAreaSize + length;
+	void *reserved = mmap(nullptr, total, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (reserved == MAP_FAILED) {
+		close(fd);
+		return nullptr;
+	}
+	auto base = (uint8_t *) reserved;
+	int const prot = mode == Image_MM_ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+	int const share = mode == Image_MM_CopyOnWrite ? MAP_PRIVATE : MAP_SHARED;
+	bool const ok = mprotect(base, headerAreaSize, PROT_READ | PROT_WRITE) == 0 &&
+			mmap(base + headerAreaSize, length, prot, share | MAP_FIXED, fd, (off_t) offset) != MAP_FAILED;
+	// the mapping keeps the file open
+	close(fd);
+	if (!ok) {
+		munmap(base, total);
+		return nullptr;
+	}
+	return base;
+}
+
+void Unmap(void *base) {
+	auto info = (MappingInfo const *) base;
+	munmap(base, info->headerAreaSize + info->dataSize);
+}
+
+bool Flush(void *base) {
+	auto info = (MappingInfo const *) base;
+	return msync((uint8_t *) base + info->headerAreaSize, info->dataSize, MS_SYNC) == 0;
+}
+
+#endif
+
+Image_ImageHeader const *CreateMapped(char const *fileName,
+																			uint64_t offset,
+																			Image_MapMode mode,
+																			bool create,
+																			uint32_t width,
+																			uint32_t height,
+																			uint32_t depth,
+																			uint32_t slices,
+																			TinyImageFormat format) {
+	if (!fileName) return nullptr;
+	if (width == 0) return nullptr;
+	if (format == TinyImageFormat_UNDEFINED) return nullptr;
+	if (height == 0) height = 1;
+	if (depth == 0) depth = 1;
+	if (slices == 0) slices = 1;
+
+	size_t const headerAreaSize = Granularity();
+	if (offset % headerAreaSize != 0) {
+		LOGERROR("Mapped image offset %llu isn't a multiple of %llu", (unsigned long long) offset,
+						 (unsigned long long) headerAreaSize);
+		return nullptr;
+	}
+	static_assert(sizeof(MappingInfo) + Image::ImagePrefixSize + sizeof(Image_ImageHeader) <= 4096,
+								"mapped image header area is bigger than a page");
+
+	Image_ImageHeader tmp;
+	Image_FillHeader(width, height, depth, slices, format, &tmp);
+
+	uint8_t *base = MapAfterHeaderArea(fileName, offset, tmp.dataSize, mode, create, headerAreaSize);
+	if (!base) {
+		return nullptr;
+	}
+
+	auto info = (MappingInfo *) base;
+	info->headerAreaSize = headerAreaSize;
+	info->dataSize = tmp.dataSize;
+	info->mode = mode;
+
+	auto image = ((Image_ImageHeader *) (base + headerAreaSize)) - 1;
+	memcpy(image, &tmp, sizeof(Image_ImageHeader));
+	if (mode == Image_MM_ReadOnly) {
+		image->flags |= Image_Flag_ReadOnly;
+	}
+	Image::AdoptExternalImage(image, base, &Unmap);
+	return image;
+}
+
+} // end anon namespace
+
+AL2O3_EXTERN_C size_t Image_MapOffsetAlignment(void) {
+	return Granularity();
+}
+
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateMapped(char const *fileName,
+																													 uint64_t offset,
+																													 Image_MapMode mode,
+																													 uint32_t width,
+																													 uint32_t height,
+																													 uint32_t depth,
+																													 uint32_t slices,
+																													 TinyImageFormat format) {
+	return CreateMapped(fileName, offset, mode, false, width, height, depth, slices, format);
+}
+
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateMappedOutput(char const *fileName,
+																																 uint64_t offset,
+																																 uint32_t width,
+																																 uint32_t height,
+																																 uint32_t depth,
+																																 uint32_t slices,
+																																 TinyImageFormat format) {
+	return CreateMapped(fileName, offset, Image_MM_ReadWrite, true, width, height, depth, slices, format);
+}
+
+AL2O3_EXTERN_C bool Image_IsMapped(Image_ImageHeader const *image) {
+	return image && Image::ExternalReleaseOf(image) == &Unmap;
+}
+
+AL2O3_EXTERN_C bool Image_FlushMapped(Image_ImageHeader const *image) {
+	if (!Image_IsMapped(image)) {
+		return false;
+	}
+	// the data (just after the header) starts one header area past the base
+	return Flush((uint8_t *) (image + 1) - Granularity());
+}
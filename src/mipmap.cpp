@@ -0,0 +1,1126 @@
+#include "al2o3_platform/platform.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "tiny_imageformat/tinyimageformat_query.h"
+#include "tiny_imageformat/tinyimageformat_decode.h"
+#include "tiny_imageformat/tinyimageformat_encode.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image/utils.h"
+#include "gfx_image_impl_basic/mipmap.h"
+#include "gfx_image_impl_basic/shared.h"
+#include "gfx_image_impl_basic/tiled.h"
+#include "gfx_image_impl_basic/view.h"
+#include "allocator.hpp"
+#include "convert_kernels.hpp"
+#include "copy.hpp"
+#include "format_info.hpp"
+#include "hq_resample.hpp"
+#include "levels.hpp"
+#include "mipmap.hpp"
+#include "parallel.hpp"
+#include "srgb.hpp"
+#include "tiled.hpp"
+#include "view.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+TinyImageFormat FloatFormatOfChannelCount(uint32_t numChans) {
+	switch (numChans) {
+	case 1: return TinyImageFormat_R32_SFLOAT;
+	case 2: return TinyImageFormat_R32G32_SFLOAT;
+	case 3: return TinyImageFormat_R32G32B32_SFLOAT;
+	case 4: return TinyImageFormat_R32G32B32A32_SFLOAT;
+	default: ASSERT(false);
+		return TinyImageFormat_UNDEFINED;
+	}
+}
+
+// rows per task, enough bands to keep every thread busy without making them
+// so thin the resampler keeps refiltering the source rows bands share
+uint32_t BandRowsFor(uint32_t height, uint32_t planeCount, uint32_t threadCount) {
+	static uint32_t const MinBandRows = 32;
+	uint32_t const wantedTasks = threadCount * 4;
+	uint32_t const bandsPerPlane = (wantedTasks + planeCount - 1) / planeCount;
+	uint32_t bandRows = (height + bandsPerPlane - 1) / bandsPerPlane;
+	bandRows = bandRows < MinBandRows ? MinBandRows : bandRows;
+	return bandRows > height ? height : bandRows;
+}
+
+// a linear copy of just this link of image, for the filters that walk rows.
+// NULL if it can't be made
+Image_ImageHeader const *LinearCopyOf(Image_ImageHeader const *image) {
+	Image_ImageHeader const *copy = Image_CreateNoClear(image->width, image->height, image->depth, image->slices, image->format);
+	if (!copy) {
+		return nullptr;
+	}
+	if (!Image_TryCopyImage(image, copy)) {
+		Image_Destroy(copy);
+		return nullptr;
+	}
+	return copy;
+}
+
+// the levels are written through views so they can be links of a chain or
+// share one packed allocation. Rows of formats without a fast path go via
+// the precise decode, 4 floats per pixel
+void DecodeRowF(Image_View const &view, uint32_t y, uint32_t z, uint32_t w, float *dst) {
+	TinyImageFormat_FetchInput input{Image::RowPtrOf(view, y, z, w)};
+	TinyImageFormat_DecodeLogicalPixelsF(view.format, &input, Image::BlocksPerRowOf(view), dst);
+}
+
+void EncodeRowF(Image_View const &view, float const *src, uint32_t y, uint32_t z, uint32_t w) {
+	TinyImageFormat_EncodeOutput output{Image::RowPtrOf(view, y, z, w)};
+	TinyImageFormat_EncodeLogicalPixelsF(view.format, src, Image::BlocksPerRowOf(view), &output);
+}
+
+// calls func with the component count as a compile time constant for the
+// common counts so inner loops unroll, 0 stands for any other count
+template<typename Func>
+void WithFixedComponentCount(uint32_t componentCount, Func const &func) {
+	switch (componentCount) {
+	case 1: func(std::integral_constant<uint32_t, 1>());
+		break;
+	case 2: func(std::integral_constant<uint32_t, 2>());
+		break;
+	case 3: func(std::integral_constant<uint32_t, 3>());
+		break;
+	case 4: func(std::integral_constant<uint32_t, 4>());
+		break;
+	default: func(std::integral_constant<uint32_t, 0>());
+		break;
+	}
+}
+
+// ------------------------------------------------------- classification ---
+// how the filters read a format. Native kinds are averaged on the stored
+// channels, F16 and SRGB8 are widened to float by the fast row kernels and
+// everything else goes via the precise decode to float
+enum class BoxKind {
+	Generic,
+	U8, S8, U16, S16, U32, S32,
+	F16, F32,
+	SRGB8,
+};
+
+struct BoxFormat {
+	BoxKind kind;
+	uint32_t componentCount;
+	// components on the sRGB curve, alpha is always linear
+	uint32_t srgbMask;
+};
+
+BoxFormat BoxFormatOf(TinyImageFormat fmt) {
+	BoxFormat format = {BoxKind::Generic, 0, 0};
+	Image::PlainLayout const layout = Image::PlainLayoutOf(fmt);
+	if (!layout.plain) {
+		return format;
+	}
+	uint32_t const channelCount = layout.componentCount;
+	uint32_t const bits = layout.bits;
+
+	// sRGB must be filtered in linear light, 8 bit has a table driven path
+	if (TinyImageFormat_IsSRGB(fmt)) {
+		if (bits == 8) {
+			format.kind = BoxKind::SRGB8;
+			format.componentCount = channelCount;
+			for (uint32_t i = 0; i < channelCount; ++i) {
+				TinyImageFormat_LogicalChannel const lc = TinyImageFormat_PhysicalChannelToLogical(fmt, (int) i);
+				if (lc == TinyImageFormat_LC_Red || lc == TinyImageFormat_LC_Green || lc == TinyImageFormat_LC_Blue) {
+					format.srgbMask |= 1u << i;
+				}
+			}
+		}
+		return format;
+	}
+
+	format.componentCount = channelCount;
+	if (TinyImageFormat_IsFloat(fmt)) {
+		switch (bits) {
+		case 16: format.kind = BoxKind::F16;
+			break;
+		case 32: format.kind = BoxKind::F32;
+			break;
+		default: break;
+		}
+		return format;
+	}
+	bool const isSigned = TinyImageFormat_IsSigned(fmt);
+	switch (bits) {
+	case 8: format.kind = isSigned ? BoxKind::S8 : BoxKind::U8;
+		break;
+	case 16: format.kind = isSigned ? BoxKind::S16 : BoxKind::U16;
+		break;
+	case 32: format.kind = isSigned ? BoxKind::S32 : BoxKind::U32;
+		break;
+	default: break;
+	}
+	return format;
+}
+
+bool IsWidenedKind(BoxKind kind) {
+	return kind == BoxKind::F16 || kind == BoxKind::SRGB8;
+}
+
+void WidenRow(BoxFormat const &format, void const *src, float *dst, size_t pixelCount) {
+	if (format.kind == BoxKind::F16) {
+		Image::HalfToFloat((uint16_t const *) src, dst, pixelCount * format.componentCount);
+	} else {
+		Image::SRGB8RowToLinear((uint8_t const *) src, dst, pixelCount, format.componentCount, format.srgbMask);
+	}
+}
+
+void NarrowRow(BoxFormat const &format, float const *src, void *dst, size_t pixelCount) {
+	if (format.kind == BoxKind::F16) {
+		Image::FloatToHalf(src, (uint16_t *) dst, pixelCount * format.componentCount);
+	} else {
+		Image::LinearRowToSRGB8(src, (uint8_t *) dst, pixelCount, format.componentCount, format.srgbMask);
+	}
+}
+
+// --------------------------------------------------------- high quality ---
+struct MipBandTask {
+	uint32_t levelIndex;
+	uint32_t slice;
+	uint32_t z;
+	uint32_t rowBegin;
+	uint32_t rowEnd;
+};
+
+struct HQScratch {
+	Image_ImageHeader *band;
+	std::vector<float> pages;
+};
+
+// every level is resampled from the base image, so all the bands of all the
+// levels are independent. Each row is computed the same whichever band or
+// thread it lands in so the result doesn't depend on the thread count.
+// Volumes resample the 4 source pages of each destination page then blend
+// them with the same filter along depth. False, with no level written, if the
+// float copy of the base or the band scratch can't be allocated
+bool GenerateMipLevelsHQ(Image_ImageHeader const *image,
+												 std::vector<Image_View> const &levels,
+												 uint32_t threadCount) {
+	using namespace Image;
+
+	uint32_t const numChans = TinyImageFormat_ChannelCount(image->format);
+	TinyImageFormat const floatFmt = FloatFormatOfChannelCount(numChans);
+	BoxFormat const format = BoxFormatOf(image->format);
+	bool const srgb8 = format.kind == BoxKind::SRGB8;
+	float const B = 1.0f / 3.0f;
+	float const C = 1.0f / 3.0f;
+
+	// the filter works on floats, so decode the base image once up front. Any
+	// level row can read any base row so the whole base is decoded
+	Image_ImageHeader const *base = image;
+	if (image->format != floatFmt) {
+		base = Image_CreateNoClear(image->width, image->height, image->depth, image->slices, floatFmt);
+		if (!base) {
+			LOGERROR("Out of memory decoding a %ux%u mip map base to float", image->width, image->height);
+			return false;
+		}
+		CopyPlan const decodePlan = PlanCopy(image->format, floatFmt);
+		uint32_t const planeCount = image->slices * image->depth;
+		uint32_t const bandRows = BandRowsFor(image->height, planeCount, threadCount);
+		uint32_t const bandsPerPlane = (image->height + bandRows - 1) / bandRows;
+		ParallelFor(threadCount, (size_t) bandsPerPlane * planeCount, [&](size_t task, uint32_t) {
+			uint32_t const plane = (uint32_t) (task / bandsPerPlane);
+			uint32_t const w = plane / image->depth;
+			uint32_t const z = plane % image->depth;
+			uint32_t const rowBegin = (uint32_t) (task % bandsPerPlane) * bandRows;
+			uint32_t const rowEnd = std::min(rowBegin + bandRows, image->height);
+			if (srgb8) {
+				for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+					WidenRow(format,
+									 ((uint8_t const *) Image_RawDataPtr(image)) + Image_CalculateIndex(image, 0, y, z, w) * numChans,
+									 ((float *) Image_RawDataPtr(base)) + Image_CalculateIndex(base, 0, y, z, w) * numChans,
+									 image->width);
+				}
+			} else {
+				CopyRows(decodePlan, image, rowBegin, z, w, base, rowBegin, z, w, rowEnd - rowBegin);
+			}
+		});
+	}
+
+	// only normalised formats have a range worth clamping the filter overshoot
+	// to, everything else is left to the encoder (NaN disables the clamp)
+	float clampLow = std::numeric_limits<float>::quiet_NaN();
+	float clampHigh = std::numeric_limits<float>::quiet_NaN();
+	if (TinyImageFormat_IsNormalised(image->format)) {
+		clampLow = (float) TinyImageFormat_Min(image->format, TinyImageFormat_LC_Red);
+		clampHigh = (float) TinyImageFormat_Max(image->format, TinyImageFormat_LC_Red);
+	}
+
+	std::vector<hq_resampler<float>> resamplers;
+	resamplers.reserve(levels.size());
+	std::vector<std::vector<hq_taps<float>>> zTaps(levels.size());
+	std::vector<MipBandTask> tasks;
+	uint32_t maxBandRows = 0;
+	for (uint32_t i = 0; i < (uint32_t) levels.size(); ++i) {
+		Image_View const &level = levels[i];
+		resamplers.emplace_back(numChans,
+														image->width, image->height,
+														level.width, level.height,
+														B, C, clampLow, clampHigh);
+		if (image->depth > 1) {
+			hq_resampler<float>::build_taps(zTaps[i], image->depth, level.depth, B, C);
+		}
+		uint32_t const bandRows = BandRowsFor(level.height, image->slices * level.depth, threadCount);
+		maxBandRows = std::max(maxBandRows, bandRows);
+		for (uint32_t w = 0; w < image->slices; ++w) {
+			for (uint32_t z = 0; z < level.depth; ++z) {
+				for (uint32_t y = 0; y < level.height; y += bandRows) {
+					tasks.push_back({i, w, z, y, std::min(y + bandRows, level.height)});
+				}
+			}
+		}
+	}
+
+	// each worker gets its own scratch, allocated for the widest level and
+	// tallest band then reshaped to each band it filters
+	threadCount = (uint32_t) std::min<size_t>(threadCount, tasks.size());
+	std::vector<HQScratch> scratch(threadCount);
+	bool scratchMade = true;
+	for (auto &s : scratch) {
+		s.band = (Image_ImageHeader *) Image_CreateNoClear(levels[0].width, maxBandRows, 1, 1, floatFmt);
+		scratchMade = scratchMade && s.band;
+	}
+	if (!scratchMade) {
+		LOGERROR("Out of memory making %ux%u mip map band scratch", levels[0].width, maxBandRows);
+		for (auto &s : scratch) {
+			if (s.band) {
+				Image_Destroy(s.band);
+			}
+		}
+		if (base != image) {
+			Image_Destroy(base);
+		}
+		return false;
+	}
+
+	CopyPlan const encodePlan = PlanCopy(floatFmt, image->format);
+	size_t const baseSliceSize = Image_ByteCountPerSliceOf(base);
+	size_t const basePageSize = Image_ByteCountPerPageOf(base);
+	ParallelFor(threadCount, tasks.size(), [&](size_t t, uint32_t worker) {
+		MipBandTask const &task = tasks[t];
+		Image_View const &level = levels[task.levelIndex];
+		hq_resampler<float> const &resampler = resamplers[task.levelIndex];
+		Image_ImageHeader *band = scratch[worker].band;
+		band->width = level.width;
+		band->height = task.rowEnd - task.rowBegin;
+		float *bandData = (float *) Image_RawDataPtr(band);
+
+		uint8_t const *srcSlice = ((uint8_t const *) Image_RawDataPtr(base)) + task.slice * baseSliceSize;
+		if (image->depth == 1) {
+			resampler.resample((float const *) srcSlice, bandData, task.rowBegin, task.rowEnd);
+		} else {
+			hq_taps<float> const &zt = zTaps[task.levelIndex][task.z];
+			size_t const bandSize = (size_t) band->width * band->height * numChans;
+			std::vector<float> &pages = scratch[worker].pages;
+			pages.resize(bandSize * 4);
+			for (int k = 0; k < 4; ++k) {
+				float const *srcPage = (float const *) (srcSlice + zt.index[k] * basePageSize);
+				resampler.resample(srcPage, pages.data() + k * bandSize, task.rowBegin, task.rowEnd);
+			}
+			for (size_t e = 0; e < bandSize; ++e) {
+				float v = zt.weight[0] * pages[e] + zt.weight[1] * pages[bandSize + e] +
+						zt.weight[2] * pages[bandSize * 2 + e] + zt.weight[3] * pages[bandSize * 3 + e];
+				// NaN clamps fail the compare and so leave v alone
+				v = v < clampLow ? clampLow : v;
+				v = v > clampHigh ? clampHigh : v;
+				bandData[e] = v;
+			}
+		}
+
+		if (srgb8) {
+			for (uint32_t y = task.rowBegin; y < task.rowEnd; ++y) {
+				NarrowRow(format,
+									bandData + (size_t) (y - task.rowBegin) * level.width * numChans,
+									RowPtrOf(level, y, task.z, task.slice),
+									level.width);
+			}
+		} else {
+			Image_View const bandView = Image_ViewOf(band);
+			Image_View const rows = Image_SubView(&level, 0, task.rowBegin, task.z, task.slice,
+																						level.width, band->height, 1, 1);
+			CopyView(encodePlan, bandView, rows);
+		}
+	});
+
+	for (auto &s : scratch) {
+		Image_Destroy(s.band);
+	}
+	if (base != image) {
+		Image_Destroy(base);
+	}
+	return true;
+}
+
+// ------------------------------------------------------------------ box ---
+// the source pixels and weights one destination pixel covers along one axis.
+// Even sizes average pairs, odd sizes use the 3 tap polyphase box so every
+// source pixel contributes equally to the level and a size of 1 just copies
+struct BoxTaps {
+	uint32_t index[3];
+	uint32_t weight[3];
+	uint32_t count;
+};
+
+struct BoxAxis {
+	std::vector<BoxTaps> taps;
+	uint32_t denominator;
+};
+
+BoxAxis BuildBoxAxis(uint32_t srcSize, uint32_t dstSize) {
+	BoxAxis axis;
+	axis.taps.resize(dstSize);
+	if (srcSize == 1) {
+		axis.denominator = 1;
+		axis.taps[0] = {{0, 0, 0}, {1, 0, 0}, 1};
+	} else if ((srcSize & 1) == 0) {
+		axis.denominator = 2;
+		for (uint32_t i = 0; i < dstSize; ++i) {
+			axis.taps[i] = {{i * 2, i * 2 + 1, 0}, {1, 1, 0}, 2};
+		}
+	} else {
+		uint32_t const m = dstSize;
+		axis.denominator = 2 * m + 1;
+		for (uint32_t i = 0; i < dstSize; ++i) {
+			axis.taps[i] = {{i * 2, i * 2 + 1, i * 2 + 2}, {m - i, m, i + 1}, 3};
+		}
+	}
+	return axis;
+}
+
+struct BoxLevelFilter {
+	BoxAxis x;
+	BoxAxis y;
+	BoxAxis z;
+	// 2D with every axis a pair or a copy, the common power of 2 case
+	bool pairwise;
+};
+
+// average of 4 with round to nearest, ties away from zero so the filter
+// commutes with negation for signed data
+template<typename T, typename Acc>
+T RoundedQuarter(Acc sum) {
+	if (std::is_signed<T>::value && sum < 0) {
+		return (T) -((-sum + 2) >> 2);
+	}
+	return (T) ((sum + 2) >> 2);
+}
+
+// the same rounding for the weighted footprints
+template<typename T>
+T RoundedDivide(int64_t sum, int64_t denominator) {
+	if (sum < 0) {
+		return (T) -((-sum * 2 + denominator) / (denominator * 2));
+	}
+	return (T) ((sum * 2 + denominator) / (denominator * 2));
+}
+
+// 32 bit channels could overflow the weighted integer sums, double is still
+// exact for pairwise footprints and std::round ties away from zero too
+template<typename T>
+T RoundedDivide(double sum, double denominator) {
+	return (T) std::round(sum / denominator);
+}
+
+// a 2x2 box over two source rows, a source side of 1 repeats its only pixel
+// which gives the plain 2 tap average with the same rounding
+template<typename T, typename Acc, uint32_t fixedComponentCount>
+void BoxRow(T const *row0, T const *row1, T *dst, uint32_t srcWidth, uint32_t dstWidth, uint32_t componentCount) {
+	// 0 is any component count
+	uint32_t const C = fixedComponentCount ? fixedComponentCount : componentCount;
+	for (uint32_t x = 0; x < dstWidth; ++x) {
+		uint32_t const sx0 = (x * 2) * C;
+		uint32_t const sx1 = std::min(x * 2 + 1, srcWidth - 1) * C;
+		for (uint32_t c = 0; c < C; ++c) {
+			Acc const sum = (Acc) row0[sx0 + c] + (Acc) row0[sx1 + c] + (Acc) row1[sx0 + c] + (Acc) row1[sx1 + c];
+			dst[x * C + c] = RoundedQuarter<T, Acc>(sum);
+		}
+	}
+}
+
+template<uint32_t fixedComponentCount>
+void BoxRowF(float const *row0, float const *row1, float *dst, uint32_t srcWidth, uint32_t dstWidth, uint32_t componentCount) {
+	uint32_t const C = fixedComponentCount ? fixedComponentCount : componentCount;
+	for (uint32_t x = 0; x < dstWidth; ++x) {
+		uint32_t const sx0 = (x * 2) * C;
+		uint32_t const sx1 = std::min(x * 2 + 1, srcWidth - 1) * C;
+		for (uint32_t c = 0; c < C; ++c) {
+			dst[x * C + c] = ((row0[sx0 + c] + row0[sx1 + c]) + (row1[sx0 + c] + row1[sx1 + c])) * 0.25f;
+		}
+	}
+}
+
+// the general footprint, rowCount source rows (the y and z taps) each with
+// its own weight and the x taps of each destination pixel
+template<typename T, typename Acc, uint32_t fixedComponentCount>
+void WeightedBoxRow(T const *const *rows, uint32_t const *rowWeights, uint32_t rowCount,
+										BoxTaps const *xTaps, T *dst, uint32_t dstWidth, uint32_t componentCount,
+										Acc denominator) {
+	uint32_t const C = fixedComponentCount ? fixedComponentCount : componentCount;
+	for (uint32_t x = 0; x < dstWidth; ++x) {
+		BoxTaps const &xt = xTaps[x];
+		for (uint32_t c = 0; c < C; ++c) {
+			Acc sum = 0;
+			for (uint32_t r = 0; r < rowCount; ++r) {
+				Acc rowSum = 0;
+				for (uint32_t t = 0; t < xt.count; ++t) {
+					rowSum += (Acc) xt.weight[t] * (Acc) rows[r][xt.index[t] * C + c];
+				}
+				sum += rowSum * (Acc) rowWeights[r];
+			}
+			dst[x * C + c] = RoundedDivide<T>(sum, denominator);
+		}
+	}
+}
+
+template<uint32_t fixedComponentCount>
+void WeightedBoxRowF(float const *const *rows, uint32_t const *rowWeights, uint32_t rowCount,
+										 BoxTaps const *xTaps, float *dst, uint32_t dstWidth, uint32_t componentCount,
+										 float denominator) {
+	uint32_t const C = fixedComponentCount ? fixedComponentCount : componentCount;
+	float const scale = 1.0f / denominator;
+	for (uint32_t x = 0; x < dstWidth; ++x) {
+		BoxTaps const &xt = xTaps[x];
+		for (uint32_t c = 0; c < C; ++c) {
+			float sum = 0;
+			for (uint32_t r = 0; r < rowCount; ++r) {
+				float rowSum = 0;
+				for (uint32_t t = 0; t < xt.count; ++t) {
+					rowSum += (float) xt.weight[t] * rows[r][xt.index[t] * C + c];
+				}
+				sum += rowSum * (float) rowWeights[r];
+			}
+			dst[x * C + c] = sum * scale;
+		}
+	}
+}
+
+template<typename T, typename Acc>
+void BoxRowAnyCount(T const *row0, T const *row1, T *dst, uint32_t srcWidth, uint32_t dstWidth, uint32_t componentCount) {
+	WithFixedComponentCount(componentCount, [&](auto fixed) {
+		BoxRow<T, Acc, decltype(fixed)::value>(row0, row1, dst, srcWidth, dstWidth, componentCount);
+	});
+}
+
+void BoxRowAnyCountF(float const *row0, float const *row1, float *dst, uint32_t srcWidth, uint32_t dstWidth, uint32_t componentCount) {
+	WithFixedComponentCount(componentCount, [&](auto fixed) {
+		BoxRowF<decltype(fixed)::value>(row0, row1, dst, srcWidth, dstWidth, componentCount);
+	});
+}
+
+template<typename T, typename Acc>
+void WeightedBoxRowAnyCount(void const *const *rows, uint32_t const *rowWeights, uint32_t rowCount,
+														BoxTaps const *xTaps, void *dst, uint32_t dstWidth, uint32_t componentCount,
+														Acc denominator) {
+	WithFixedComponentCount(componentCount, [&](auto fixed) {
+		WeightedBoxRow<T, Acc, decltype(fixed)::value>((T const *const *) rows, rowWeights, rowCount,
+																									 xTaps, (T *) dst, dstWidth, componentCount, denominator);
+	});
+}
+
+void WeightedBoxRowAnyCountF(float const *const *rows, uint32_t const *rowWeights, uint32_t rowCount,
+														 BoxTaps const *xTaps, float *dst, uint32_t dstWidth, uint32_t componentCount,
+														 float denominator) {
+	WithFixedComponentCount(componentCount, [&](auto fixed) {
+		WeightedBoxRowF<decltype(fixed)::value>(rows, rowWeights, rowCount,
+																						xTaps, dst, dstWidth, componentCount, denominator);
+	});
+}
+
+// filters destination row y of slice w of level from src (the level above)
+// with the pairwise 2x2 box
+void BoxFilterRowPairwise(BoxFormat const &format,
+													Image_View const &src, Image_View const &level,
+													uint32_t y, uint32_t w,
+													std::vector<float> &scratch) {
+	using namespace Image;
+	BoxKind const kind = format.kind;
+	uint32_t const sy0 = y * 2;
+	uint32_t const sy1 = std::min(y * 2 + 1, src.height - 1);
+
+	if (kind == BoxKind::Generic) {
+		scratch.resize(((size_t) src.width * 2 + level.width) * 4);
+		float *row0 = scratch.data();
+		float *row1 = row0 + (size_t) src.width * 4;
+		float *dst = row1 + (size_t) src.width * 4;
+		DecodeRowF(src, sy0, 0, w, row0);
+		DecodeRowF(src, sy1, 0, w, row1);
+		BoxRowF<4>(row0, row1, dst, src.width, level.width, 4);
+		EncodeRowF(level, dst, y, 0, w);
+		return;
+	}
+
+	void const *row0 = RowPtrOf(src, sy0, 0, w);
+	void const *row1 = RowPtrOf(src, sy1, 0, w);
+	void *dst = RowPtrOf(level, y, 0, w);
+
+	uint32_t const sw = src.width;
+	uint32_t const dw = level.width;
+	uint32_t const C = format.componentCount;
+	switch (kind) {
+	case BoxKind::U8: BoxRowAnyCount<uint8_t, uint32_t>((uint8_t const *) row0, (uint8_t const *) row1, (uint8_t *) dst, sw, dw, C);
+		break;
+	case BoxKind::S8: BoxRowAnyCount<int8_t, int32_t>((int8_t const *) row0, (int8_t const *) row1, (int8_t *) dst, sw, dw, C);
+		break;
+	case BoxKind::U16: BoxRowAnyCount<uint16_t, uint32_t>((uint16_t const *) row0, (uint16_t const *) row1, (uint16_t *) dst, sw, dw, C);
+		break;
+	case BoxKind::S16: BoxRowAnyCount<int16_t, int32_t>((int16_t const *) row0, (int16_t const *) row1, (int16_t *) dst, sw, dw, C);
+		break;
+	case BoxKind::U32: BoxRowAnyCount<uint32_t, uint64_t>((uint32_t const *) row0, (uint32_t const *) row1, (uint32_t *) dst, sw, dw, C);
+		break;
+	case BoxKind::S32: BoxRowAnyCount<int32_t, int64_t>((int32_t const *) row0, (int32_t const *) row1, (int32_t *) dst, sw, dw, C);
+		break;
+	case BoxKind::F32: BoxRowAnyCountF((float const *) row0, (float const *) row1, (float *) dst, sw, dw, C);
+		break;
+	case BoxKind::F16:
+	case BoxKind::SRGB8: {
+		// widen to float, filter and narrow with the row kernels
+		size_t const srcCount = (size_t) sw * C;
+		size_t const dstCount = (size_t) dw * C;
+		scratch.resize(srcCount * 2 + dstCount);
+		float *f0 = scratch.data();
+		float *f1 = f0 + srcCount;
+		float *fd = f1 + srcCount;
+		WidenRow(format, row0, f0, sw);
+		WidenRow(format, row1, f1, sw);
+		BoxRowAnyCountF(f0, f1, fd, sw, dw, C);
+		NarrowRow(format, fd, dst, dw);
+		break;
+	}
+	case BoxKind::Generic: break;
+	}
+}
+
+// filters destination row (y, z) of slice w of level from src with the full
+// footprint, odd sized axes and volumes end up here
+void BoxFilterRowWeighted(BoxFormat const &format,
+													Image_View const &src, Image_View const &level,
+													BoxLevelFilter const &filter,
+													uint32_t y, uint32_t z, uint32_t w,
+													std::vector<float> &scratch) {
+	BoxKind const kind = format.kind;
+	// gather the source rows of the y and z taps, at most 3x3
+	BoxTaps const &yt = filter.y.taps[y];
+	BoxTaps const &zt = filter.z.taps[z];
+	uint32_t rowY[9];
+	uint32_t rowZ[9];
+	uint32_t rowWeights[9];
+	uint32_t rowCount = 0;
+	for (uint32_t iz = 0; iz < zt.count; ++iz) {
+		for (uint32_t iy = 0; iy < yt.count; ++iy) {
+			rowY[rowCount] = yt.index[iy];
+			rowZ[rowCount] = zt.index[iz];
+			rowWeights[rowCount] = yt.weight[iy] * zt.weight[iz];
+			++rowCount;
+		}
+	}
+	uint32_t const denominator = filter.x.denominator * filter.y.denominator * filter.z.denominator;
+	BoxTaps const *xTaps = filter.x.taps.data();
+	uint32_t const dw = level.width;
+	uint32_t const C = format.componentCount;
+
+	if (kind == BoxKind::Generic || IsWidenedKind(kind)) {
+		// these filter floats, decoded rows are always 4 floats per pixel
+		uint32_t const floatsPerPixel = kind == BoxKind::Generic ? 4 : C;
+		size_t const srcCount = (size_t) src.width * floatsPerPixel;
+		scratch.resize(srcCount * rowCount + (size_t) dw * floatsPerPixel);
+		float const *rows[9];
+		for (uint32_t r = 0; r < rowCount; ++r) {
+			float *row = scratch.data() + srcCount * r;
+			if (kind == BoxKind::Generic) {
+				DecodeRowF(src, rowY[r], rowZ[r], w, row);
+			} else {
+				WidenRow(format, Image::RowPtrOf(src, rowY[r], rowZ[r], w), row, src.width);
+			}
+			rows[r] = row;
+		}
+		float *dst = scratch.data() + srcCount * rowCount;
+		WeightedBoxRowAnyCountF(rows, rowWeights, rowCount, xTaps, dst, dw, floatsPerPixel, (float) denominator);
+		if (kind == BoxKind::Generic) {
+			EncodeRowF(level, dst, y, z, w);
+		} else {
+			NarrowRow(format, dst, Image::RowPtrOf(level, y, z, w), dw);
+		}
+		return;
+	}
+
+	void const *rows[9];
+	for (uint32_t r = 0; r < rowCount; ++r) {
+		rows[r] = Image::RowPtrOf(src, rowY[r], rowZ[r], w);
+	}
+	void *dst = Image::RowPtrOf(level, y, z, w);
+
+	switch (kind) {
+	case BoxKind::U8: WeightedBoxRowAnyCount<uint8_t, int64_t>(rows, rowWeights, rowCount, xTaps, dst, dw, C, denominator);
+		break;
+	case BoxKind::S8: WeightedBoxRowAnyCount<int8_t, int64_t>(rows, rowWeights, rowCount, xTaps, dst, dw, C, denominator);
+		break;
+	case BoxKind::U16: WeightedBoxRowAnyCount<uint16_t, int64_t>(rows, rowWeights, rowCount, xTaps, dst, dw, C, denominator);
+		break;
+	case BoxKind::S16: WeightedBoxRowAnyCount<int16_t, int64_t>(rows, rowWeights, rowCount, xTaps, dst, dw, C, denominator);
+		break;
+	case BoxKind::U32: WeightedBoxRowAnyCount<uint32_t, double>(rows, rowWeights, rowCount, xTaps, dst, dw, C, denominator);
+		break;
+	case BoxKind::S32: WeightedBoxRowAnyCount<int32_t, double>(rows, rowWeights, rowCount, xTaps, dst, dw, C, denominator);
+		break;
+	case BoxKind::F32:
+		WeightedBoxRowAnyCountF((float const *const *) rows, rowWeights, rowCount, xTaps, (float *) dst, dw, C,
+														(float) denominator);
+		break;
+	case BoxKind::F16:
+	case BoxKind::SRGB8:
+	case BoxKind::Generic: break;
+	}
+}
+
+// ---------------------------------------------------------------- tiled ---
+// in Morton order the 2x2 footprint of pixel i of a quadrant of a destination
+// tile is pixels 4i to 4i + 3 of one source tile, summed in the same order as
+// the linear rows so tiled levels match linear ones exactly
+template<typename T, typename Acc, uint32_t fixedComponentCount>
+void MortonBox(T const *src, T *dst, uint32_t dstCount, uint32_t componentCount) {
+	uint32_t const C = fixedComponentCount ? fixedComponentCount : componentCount;
+	for (uint32_t i = 0; i < dstCount; ++i) {
+		T const *s = src + i * 4 * C;
+		for (uint32_t c = 0; c < C; ++c) {
+			Acc const sum = (Acc) s[c] + (Acc) s[C + c] + (Acc) s[C * 2 + c] + (Acc) s[C * 3 + c];
+			dst[i * C + c] = RoundedQuarter<T, Acc>(sum);
+		}
+	}
+}
+
+template<uint32_t fixedComponentCount>
+void MortonBoxF(float const *src, float *dst, uint32_t dstCount, uint32_t componentCount) {
+	uint32_t const C = fixedComponentCount ? fixedComponentCount : componentCount;
+	for (uint32_t i = 0; i < dstCount; ++i) {
+		float const *s = src + i * 4 * C;
+		for (uint32_t c = 0; c < C; ++c) {
+			dst[i * C + c] = ((s[c] + s[C + c]) + (s[C * 2 + c] + s[C * 3 + c])) * 0.25f;
+		}
+	}
+}
+
+template<typename T, typename Acc>
+void MortonBoxAnyCount(void const *src, void *dst, uint32_t dstCount, uint32_t componentCount) {
+	WithFixedComponentCount(componentCount, [&](auto fixed) {
+		MortonBox<T, Acc, decltype(fixed)::value>((T const *) src, (T *) dst, dstCount, componentCount);
+	});
+}
+
+void MortonBoxAnyCountF(float const *src, float *dst, uint32_t dstCount, uint32_t componentCount) {
+	WithFixedComponentCount(componentCount, [&](auto fixed) {
+		MortonBoxF<decltype(fixed)::value>(src, dst, dstCount, componentCount);
+	});
+}
+
+// filters destination tile (tx, ty) of slice w of a tiled level from the
+// tiled level above, each quadrant of the tile comes from one source tile
+void BoxFilterTile(BoxFormat const &format,
+									 Image_ImageHeader const *src, Image_ImageHeader const *level,
+									 uint32_t tx, uint32_t ty, uint32_t w,
+									 std::vector<float> &scratch) {
+	using namespace Image;
+	uint32_t const QuadrantPixelCount = TilePixelCount / 4;
+	size_t const pixelSize = TinyImageFormat_BitSizeOfBlock(src->format) / 8;
+	uint32_t const C = format.componentCount;
+	size_t const dstTileIndex = Image_CalculateLayoutIndex(level, tx * Image_TileSize, ty * Image_TileSize, 0, w);
+
+	for (uint32_t q = 0; q < 4; ++q) {
+		size_t const srcIndex = Image_CalculateLayoutIndex(src,
+																											 (tx * 2 + (q & 1)) * Image_TileSize,
+																											 (ty * 2 + (q >> 1)) * Image_TileSize,
+																											 0, w);
+		size_t const dstIndex = dstTileIndex + q * QuadrantPixelCount;
+		void const *s = ((uint8_t const *) Image_RawDataPtr(src)) + srcIndex * pixelSize;
+		void *d = ((uint8_t *) Image_RawDataPtr(level)) + dstIndex * pixelSize;
+
+		switch (format.kind) {
+		case BoxKind::U8: MortonBoxAnyCount<uint8_t, uint32_t>(s, d, QuadrantPixelCount, C);
+			break;
+		case BoxKind::S8: MortonBoxAnyCount<int8_t, int32_t>(s, d, QuadrantPixelCount, C);
+			break;
+		case BoxKind::U16: MortonBoxAnyCount<uint16_t, uint32_t>(s, d, QuadrantPixelCount, C);
+			break;
+		case BoxKind::S16: MortonBoxAnyCount<int16_t, int32_t>(s, d, QuadrantPixelCount, C);
+			break;
+		case BoxKind::U32: MortonBoxAnyCount<uint32_t, uint64_t>(s, d, QuadrantPixelCount, C);
+			break;
+		case BoxKind::S32: MortonBoxAnyCount<int32_t, int64_t>(s, d, QuadrantPixelCount, C);
+			break;
+		case BoxKind::F32: MortonBoxAnyCountF((float const *) s, (float *) d, QuadrantPixelCount, C);
+			break;
+		case BoxKind::F16:
+		case BoxKind::SRGB8: {
+			scratch.resize((size_t) (TilePixelCount + QuadrantPixelCount) * C);
+			float *fs = scratch.data();
+			float *fd = fs + (size_t) TilePixelCount * C;
+			WidenRow(format, s, fs, TilePixelCount);
+			MortonBoxAnyCountF(fs, fd, QuadrantPixelCount, C);
+			NarrowRow(format, fd, d, QuadrantPixelCount);
+			break;
+		}
+		case BoxKind::Generic: {
+			// decoded pixels are always 4 floats
+			scratch.resize((size_t) (TilePixelCount + QuadrantPixelCount) * 4);
+			float *fs = scratch.data();
+			float *fd = fs + (size_t) TilePixelCount * 4;
+			Image_GetBlocksAtF(src, fs, TilePixelCount, srcIndex);
+			MortonBoxF<4>(fs, fd, QuadrantPixelCount, 4);
+			Image_SetBlocksAtF(level, fd, QuadrantPixelCount, dstIndex);
+			break;
+		}
+		}
+	}
+}
+
+// filters level from src, the level above it. The bands of a level are
+// independent
+void BoxFilterLevel(BoxFormat const &format,
+										Image_View const &src, Image_View const &level,
+										uint32_t threadCount,
+										std::vector<std::vector<float>> &scratch) {
+	using namespace Image;
+	BoxLevelFilter filter;
+	filter.x = BuildBoxAxis(src.width, level.width);
+	filter.y = BuildBoxAxis(src.height, level.height);
+	filter.z = BuildBoxAxis(src.depth, level.depth);
+	filter.pairwise = src.depth == 1 && filter.x.denominator <= 2 && filter.y.denominator <= 2;
+
+	uint32_t const planeCount = level.slices * level.depth;
+	uint32_t const bandRows = BandRowsFor(level.height, planeCount, threadCount);
+	uint32_t const bandsPerPlane = (level.height + bandRows - 1) / bandRows;
+	ParallelFor(threadCount, (size_t) bandsPerPlane * planeCount, [&](size_t task, uint32_t worker) {
+		uint32_t const plane = (uint32_t) (task / bandsPerPlane);
+		uint32_t const w = plane / level.depth;
+		uint32_t const z = plane % level.depth;
+		uint32_t const rowBegin = (uint32_t) (task % bandsPerPlane) * bandRows;
+		uint32_t const rowEnd = std::min(rowBegin + bandRows, level.height);
+		for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+			if (filter.pairwise) {
+				BoxFilterRowPairwise(format, src, level, y, w, scratch[worker]);
+			} else {
+				BoxFilterRowWeighted(format, src, level, filter, y, z, w, scratch[worker]);
+			}
+		}
+	});
+}
+
+// each level is filtered from the one above it so the total work is a
+// geometric series of the base size. False if a linear copy of a tiled level
+// couldn't be made
+bool GenerateMipLevelsBox(Image_ImageHeader const *image,
+													std::vector<Image_ImageHeader const *> const &levels,
+													uint32_t threadCount) {
+	using namespace Image;
+
+	BoxFormat const format = BoxFormatOf(image->format);
+
+	std::vector<std::vector<float>> scratch(threadCount);
+	Image_ImageHeader const *src = image;
+	for (Image_ImageHeader const *level : levels) {
+		if (Image_IsTiled(level)) {
+			// a tiled level always has a tiled parent, so whole tiles filter to quadrants
+			uint32_t const tilesPerRow = level->width / Image_TileSize;
+			uint32_t const tileRows = level->height / Image_TileSize;
+			ParallelFor(threadCount, (size_t) tileRows * image->slices, [&](size_t task, uint32_t worker) {
+				uint32_t const w = (uint32_t) (task / tileRows);
+				uint32_t const ty = (uint32_t) (task % tileRows);
+				for (uint32_t tx = 0; tx < tilesPerRow; ++tx) {
+					BoxFilterTile(format, src, level, tx, ty, w, scratch[worker]);
+				}
+			});
+			src = level;
+			continue;
+		}
+		// the first linear level below a tiled one filters rows of a linear copy
+		Image_ImageHeader const *tiledSrc = nullptr;
+		if (Image_IsTiled(src)) {
+			tiledSrc = src;
+			src = LinearCopyOf(src);
+			if (!src) {
+				return false;
+			}
+		}
+
+		BoxFilterLevel(format, Image_ViewOf(src), Image_ViewOf(level), threadCount, scratch);
+		if (tiledSrc) {
+			Image_Destroy(src);
+		}
+		src = level;
+	}
+	return true;
+}
+
+// the resampler reads and writes rows, so a tiled chain is generated into
+// linear copies of the base and tiled levels then tiled back. False if the
+// copies couldn't be made
+bool GenerateMipLevelsHQAnyLayout(Image_ImageHeader const *image,
+																	std::vector<Image_ImageHeader const *> const &levels,
+																	uint32_t threadCount) {
+	std::vector<Image_View> views;
+	if (!Image_IsTiled(image)) {
+		for (Image_ImageHeader const *level : levels) {
+			views.push_back(Image_ViewOf(level));
+		}
+		return GenerateMipLevelsHQ(image, views, threadCount);
+	}
+
+	Image_ImageHeader const *base = LinearCopyOf(image);
+	if (!base) {
+		return false;
+	}
+	bool ok = true;
+	std::vector<Image_ImageHeader const *> linearLevels = levels;
+	for (Image_ImageHeader const *&level : linearLevels) {
+		if (Image_IsTiled(level)) {
+			level = Image_CreateNoClear(level->width, level->height, level->depth, level->slices, level->format);
+			ok = ok && level;
+		}
+		if (level) {
+			views.push_back(Image_ViewOf(level));
+		}
+	}
+	ok = ok && GenerateMipLevelsHQ(base, views, threadCount);
+	for (size_t i = 0; i < levels.size(); ++i) {
+		if (linearLevels[i] && linearLevels[i] != levels[i]) {
+			ok = ok && Image_TryCopyImage(linearLevels[i], levels[i]);
+			Image_Destroy(linearLevels[i]);
+		}
+	}
+	Image_Destroy(base);
+	return ok;
+}
+
+// removes and destroys the levels below image, it is left a single image
+void UnlinkLevels(Image_ImageHeader *image) {
+	if (image->nextType != Image_NT_None) {
+		Image_Destroy(image->nextImage);
+	}
+	image->nextType = Image_NT_None;
+	image->nextImage = nullptr;
+}
+
+} // end anon namespace
+
+uint32_t Image::HalveDimension(uint32_t size) {
+	return size > 1 ? size / 2 : 1;
+}
+
+uint32_t Image::BoxFirstSourceRow(uint32_t srcHeight, uint32_t dstRow) {
+	return srcHeight == 1 ? 0 : dstRow * 2;
+}
+
+uint32_t Image::BoxLastSourceRow(uint32_t srcHeight, uint32_t dstRow) {
+	if (srcHeight == 1) {
+		return 0;
+	}
+	return (srcHeight & 1) ? dstRow * 2 + 2 : dstRow * 2 + 1;
+}
+
+void Image::BoxFilterBand(Image_ImageHeader const *src, uint32_t srcHeight, uint32_t srcFirstRow,
+													Image_ImageHeader const *dst, uint32_t dstHeight, uint32_t dstFirstRow,
+													uint32_t rowCount, uint32_t threadCount) {
+	ASSERT(src->format == dst->format);
+	ASSERT(src->depth == 1 && src->slices == 1);
+	BoxFormat const format = BoxFormatOf(src->format);
+
+	// the y taps of just these rows, relative to the start of the source band
+	BoxAxis const y = BuildBoxAxis(srcHeight, dstHeight);
+	BoxLevelFilter filter;
+	filter.x = BuildBoxAxis(src->width, dst->width);
+	filter.y.denominator = y.denominator;
+	filter.y.taps.assign(y.taps.begin() + dstFirstRow, y.taps.begin() + dstFirstRow + rowCount);
+	for (BoxTaps &taps : filter.y.taps) {
+		for (uint32_t t = 0; t < taps.count; ++t) {
+			ASSERT(taps.index[t] >= srcFirstRow && taps.index[t] - srcFirstRow < src->height);
+			taps.index[t] -= srcFirstRow;
+		}
+	}
+	filter.z = BuildBoxAxis(1, 1);
+	// the pairwise rows read source rows 2y and 2y + 1 of the band
+	filter.pairwise = filter.x.denominator <= 2 && filter.y.denominator == 2 && srcFirstRow == dstFirstRow * 2;
+
+	threadCount = ResolveThreadCount(threadCount);
+	std::vector<std::vector<float>> scratch(threadCount);
+	Image_View const srcView = Image_ViewOf(src);
+	Image_View const dstView = Image_ViewOf(dst);
+	uint32_t const bandRows = BandRowsFor(rowCount, 1, threadCount);
+	uint32_t const taskCount = (rowCount + bandRows - 1) / bandRows;
+	ParallelFor(threadCount, taskCount, [&](size_t task, uint32_t worker) {
+		uint32_t const rowBegin = (uint32_t) task * bandRows;
+		uint32_t const rowEnd = std::min(rowBegin + bandRows, rowCount);
+		for (uint32_t row = rowBegin; row < rowEnd; ++row) {
+			if (filter.pairwise) {
+				BoxFilterRowPairwise(format, srcView, dstView, row, 0, scratch[worker]);
+			} else {
+				BoxFilterRowWeighted(format, srcView, dstView, filter, row, 0, 0, scratch[worker]);
+			}
+		}
+	});
+}
+
+AL2O3_EXTERN_C void Image_CreateMipMapChain(Image_ImageHeader const *image, bool generateFromImage) {
+	Image_MipMapChainDesc const desc = {generateFromImage, 1, Image_MMF_HighQuality};
+	Image_CreateMipMapChainEx(image, &desc);
+}
+
+AL2O3_EXTERN_C bool Image_CreateMipMapChainEx(Image_ImageHeader const *image, Image_MipMapChainDesc const *desc) {
+	ASSERT(desc);
+	if (Image_IsShared(image)) {
+		return false;
+	}
+	// start from the image provided and create successive mip images, each
+	// dimension halves rounding down until it reaches 1 so any size works
+	ASSERT(image->nextType == Image_NT_None);
+
+	Image_ImageHeader *curImage = (Image_ImageHeader *) image;
+	uint32_t curWidth = image->width;
+	uint32_t curHeight = image->height;
+	uint32_t curDepth = image->depth;
+	if (curWidth == 1 && curHeight == 1 && curDepth == 1) {
+		return true;
+	}
+
+	std::vector<Image_ImageHeader const *> levels;
+	bool tiled = Image_IsTiled(image);
+	do {
+		curWidth = Image::HalveDimension(curWidth);
+		curHeight = Image::HalveDimension(curHeight);
+		curDepth = Image::HalveDimension(curDepth);
+
+		// generated levels are fully overwritten so only need clearing when not
+		auto newImage = (Image_ImageHeader *) (desc->generateFromImage ?
+				Image_CreateNoClear(curWidth, curHeight, curDepth, image->slices, image->format) :
+				Image_Create(curWidth, curHeight, curDepth, image->slices, image->format));
+		if (!newImage) {
+			LOGERROR("Out of memory creating a %ux%ux%u mip level", curWidth, curHeight, curDepth);
+			UnlinkLevels((Image_ImageHeader *) image);
+			return false;
+		}
+		// levels of a tiled image stay tiled until one is too small to be
+		tiled = tiled && Image_CanBeTiled(newImage);
+		if (tiled) {
+			newImage->flags |= Image_Flag_Tiled;
+		}
+		levels.push_back(newImage);
+
+		curImage->nextImage = (Image_ImageHeader *) newImage;
+		curImage->nextType = Image_NT_MipMap;
+		curImage = (Image_ImageHeader *) curImage->nextImage;
+	} while (curWidth > 1 || curHeight > 1 || curDepth > 1);
+
+	bool generated = true;
+	if (desc->generateFromImage) {
+		uint32_t const threadCount = Image::ResolveThreadCount(desc->threadCount);
+		switch (desc->filter) {
+		case Image_MMF_HighQuality: generated = GenerateMipLevelsHQAnyLayout(image, levels, threadCount);
+			break;
+		case Image_MMF_FastBox: generated = GenerateMipLevelsBox(image, levels, threadCount);
+			break;
+		default: ASSERT(false);
+			break;
+		}
+	}
+	if (!generated) {
+		LOGERROR("Out of memory generating the mip levels");
+		UnlinkLevels((Image_ImageHeader *) image);
+		return false;
+	}
+
+	// later lookups of the chain index its directory instead of walking it
+	Image::RecordLevelDirectory(image);
+	return true;
+}
+
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateWithPackedMipMaps(uint32_t width,
+																																	 uint32_t height,
+																																	 uint32_t depth,
+																																	 uint32_t slices,
+																																	 TinyImageFormat format) {
+	// the same levels Image_CreateMipMapChainEx links, halving down to 1x1x1
+	Image_ImageHeader level;
+	Image_FillHeader(width, height, depth, slices, format, &level);
+	size_t byteCount = Image_ByteCountOf(&level);
+	uint32_t levelCount = 1;
+	while (level.width > 1 || level.height > 1 || level.depth > 1) {
+		Image_FillHeader(Image::HalveDimension(level.width),
+										 Image::HalveDimension(level.height),
+										 Image::HalveDimension(level.depth),
+										 slices, format, &level);
+		byteCount += Image_ByteCountOf(&level);
+		++levelCount;
+	}
+
+	Image_ImageHeader *image = Image::AllocateImage(byteCount, true);
+	if (!image) {
+		return nullptr;
+	}
+	Image_FillHeader(width, height, depth, slices, format, image);
+	image->dataSize = byteCount;
+	image->flags |= Image_Flag_PackedMipMaps;
+	image->packedMipMapCount = (uint8_t) levelCount;
+	Image::RecordLevelDirectory(image);
+	return image;
+}
+
+AL2O3_EXTERN_C bool Image_GeneratePackedMipMaps(Image_ImageHeader const *image,
+																								uint32_t threadCount,
+																								Image_MipMapFilter filter) {
+	ASSERT(Image_HasPackedMipMaps(image));
+	if (Image_IsReadOnly(image)) {
+		return false;
+	}
+
+	// level 0 is at the start of the data so the packed image is also the base
+	std::vector<Image_View> levels;
+	for (uint32_t i = 1; i < image->packedMipMapCount; ++i) {
+		levels.push_back(Image_ViewOfMipLevel(image, i));
+	}
+	if (levels.empty()) {
+		return true;
+	}
+
+	threadCount = Image::ResolveThreadCount(threadCount);
+	switch (filter) {
+	case Image_MMF_HighQuality: return GenerateMipLevelsHQ(image, levels, threadCount);
+	case Image_MMF_FastBox: {
+		BoxFormat const format = BoxFormatOf(image->format);
+		std::vector<std::vector<float>> scratch(threadCount);
+		Image_View src = Image_ViewOfMipLevel(image, 0);
+		for (Image_View const &level : levels) {
+			BoxFilterLevel(format, src, level, threadCount, scratch);
+			src = level;
+		}
+		break;
+	}
+	default: ASSERT(false);
+		break;
+	}
+	return true;
+}
+
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreatePackedMipMapChainEx(Image_ImageHeader const *image,
+																																			 Image_MipMapChainDesc const *desc) {
+	ASSERT(image);
+	ASSERT(desc);
+	auto packed = (Image_ImageHeader *) Image_CreateWithPackedMipMaps(image->width, image->height, image->depth,
+																																		 image->slices, image->format);
+	if (!packed) {
+		return nullptr;
+	}
+	packed->flags |= image->flags & Image_Flag_Cubemap;
+	Image_CopyImage(image, packed);
+	if (desc->generateFromImage && !Image_GeneratePackedMipMaps(packed, desc->threadCount, desc->filter)) {
+		Image_Destroy(packed);
+		return nullptr;
+	}
+	return packed;
+}
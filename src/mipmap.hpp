@@ -0,0 +1,30 @@
+// The box filter of the mip map generator for callers that only hold a band
+// of rows of each level at a time, like the streaming pipeline
+#ifndef WYRD_IMAGE_MIPMAP_HPP
+#define WYRD_IMAGE_MIPMAP_HPP
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+
+namespace Image {
+
+// the size of the next level along one axis, halving rounding down to 1
+uint32_t HalveDimension(uint32_t size);
+
+// the first and last source rows the box filter reads for destination row
+// dstRow of the level below one srcHeight rows high
+uint32_t BoxFirstSourceRow(uint32_t srcHeight, uint32_t dstRow);
+uint32_t BoxLastSourceRow(uint32_t srcHeight, uint32_t dstRow);
+
+// Image_MMF_FastBox filters rowCount rows, from row dstFirstRow, of a 2D
+// level dstHeight rows high from the srcHeight row level above it. src and
+// dst are 2D images of the full level widths holding just a band of rows, src
+// from row srcFirstRow, which must include every row the destination rows
+// read. Results are the same as filtering the whole level at once
+void BoxFilterBand(Image_ImageHeader const *src, uint32_t srcHeight, uint32_t srcFirstRow,
+									 Image_ImageHeader const *dst, uint32_t dstHeight, uint32_t dstFirstRow,
+									 uint32_t rowCount, uint32_t threadCount);
+
+} // end namespace Image
+
+#endif //WYRD_IMAGE_MIPMAP_HPP
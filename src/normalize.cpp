@@ -0,0 +1,289 @@
+#include "al2o3_platform/platform.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "tiny_imageformat/tinyimageformat_query.h"
+#include "tiny_imageformat/tinyimageformat_decode.h"
+#include "tiny_imageformat/tinyimageformat_encode.h"
+#include "gfx_image/image.h"
+#include "gfx_image/utils.h"
+#include "gfx_image_impl_basic/normalize.h"
+#include "gfx_image_impl_basic/shared.h"
+#include "format_info.hpp"
+#include "parallel.hpp"
+#include "range.hpp"
+#include "simd.hpp"
+#include <vector>
+
+namespace {
+
+// below this each task isn't worth a thread
+size_t const MinBytesPerTask = 256 * 1024;
+
+// scale and bias of each logical channel, v * scale + bias in double as the
+// per pixel version did so results are unchanged
+struct Affine {
+	double scale[4];
+	double bias[4];
+};
+
+// the per channel affine repeated over period values of stored components,
+// so the transform loops never need a channel index
+template<uint32_t Period>
+struct ExpandedAffine {
+	double scale[Period];
+	double bias[Period];
+};
+
+template<uint32_t Period>
+ExpandedAffine<Period> Expand(Affine const &affine, TinyImageFormat fmt, uint32_t componentCount) {
+	ExpandedAffine<Period> expanded;
+	for (uint32_t i = 0; i < Period; ++i) {
+		TinyImageFormat_LogicalChannel const lc =
+				TinyImageFormat_PhysicalChannelToLogical(fmt, (int) (i % componentCount));
+		expanded.scale[i] = lc >= 0 ? affine.scale[lc] : 1.0;
+		expanded.bias[i] = lc >= 0 ? affine.bias[lc] : 0.0;
+	}
+	return expanded;
+}
+
+template<typename T, uint32_t Period>
+void Affine_Scalar(T *data, size_t valueCount, ExpandedAffine<Period> const &affine) {
+	size_t i = 0;
+	for (; i + Period <= valueCount; i += Period) {
+		for (uint32_t j = 0; j < Period; ++j) {
+			data[i + j] = (T) (data[i + j] * affine.scale[j] + affine.bias[j]);
+		}
+	}
+	// runs always start on a pixel so the tail does too
+	for (uint32_t j = 0; i < valueCount; ++i, ++j) {
+		data[i] = (T) (data[i] * affine.scale[j] + affine.bias[j]);
+	}
+}
+
+// floats widen to double in pairs so each of the Period / 4 vectors of a
+// period uses its own two scale and bias registers
+#if IMAGE_SIMD_X86
+template<uint32_t Period>
+IMAGE_SIMD_TARGET("sse2")
+void AffineF32_Vector(float *data, size_t valueCount, ExpandedAffine<Period> const &affine) {
+	uint32_t const vectorCount = Period / 4;
+	__m128d scaleLo[vectorCount], scaleHi[vectorCount];
+	__m128d biasLo[vectorCount], biasHi[vectorCount];
+	for (uint32_t v = 0; v < vectorCount; ++v) {
+		scaleLo[v] = _mm_loadu_pd(affine.scale + v * 4 + 0);
+		scaleHi[v] = _mm_loadu_pd(affine.scale + v * 4 + 2);
+		biasLo[v] = _mm_loadu_pd(affine.bias + v * 4 + 0);
+		biasHi[v] = _mm_loadu_pd(affine.bias + v * 4 + 2);
+	}
+
+	size_t const blockCount = valueCount / Period;
+	for (size_t b = 0; b < blockCount; ++b) {
+		for (uint32_t v = 0; v < vectorCount; ++v) {
+			__m128 const x = _mm_loadu_ps(data + v * 4);
+			__m128d const lo = _mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(x), scaleLo[v]), biasLo[v]);
+			__m128d const hi = _mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), scaleHi[v]), biasHi[v]);
+			_mm_storeu_ps(data + v * 4, _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi)));
+		}
+		data += Period;
+	}
+	Affine_Scalar(data, valueCount - blockCount * Period, affine);
+}
+#elif IMAGE_SIMD_NEON && (defined(__aarch64__) || defined(_M_ARM64))
+template<uint32_t Period>
+void AffineF32_Vector(float *data, size_t valueCount, ExpandedAffine<Period> const &affine) {
+	uint32_t const vectorCount = Period / 4;
+	float64x2_t scaleLo[vectorCount], scaleHi[vectorCount];
+	float64x2_t biasLo[vectorCount], biasHi[vectorCount];
+	for (uint32_t v = 0; v < vectorCount; ++v) {
+		scaleLo[v] = vld1q_f64(affine.scale + v * 4 + 0);
+		scaleHi[v] = vld1q_f64(affine.scale + v * 4 + 2);
+		biasLo[v] = vld1q_f64(affine.bias + v * 4 + 0);
+		biasHi[v] = vld1q_f64(affine.bias + v * 4 + 2);
+	}
+
+	size_t const blockCount = valueCount / Period;
+	for (size_t b = 0; b < blockCount; ++b) {
+		for (uint32_t v = 0; v < vectorCount; ++v) {
+			float32x4_t const x = vld1q_f32(data + v * 4);
+			// separate multiply and add, a fused one would change the rounding
+			float64x2_t const lo = vaddq_f64(vmulq_f64(vcvt_f64_f32(vget_low_f32(x)), scaleLo[v]), biasLo[v]);
+			float64x2_t const hi = vaddq_f64(vmulq_f64(vcvt_high_f64_f32(x), scaleHi[v]), biasHi[v]);
+			vst1q_f32(data + v * 4, vcvt_high_f32_f64(vcvt_f32_f64(lo), hi));
+		}
+		data += Period;
+	}
+	Affine_Scalar(data, valueCount - blockCount * Period, affine);
+}
+#else
+template<uint32_t Period>
+void AffineF32_Vector(float *data, size_t valueCount, ExpandedAffine<Period> const &affine) {
+	Affine_Scalar(data, valueCount, affine);
+}
+#endif
+
+// splits count units of unitBytes into tasks of at least MinBytesPerTask,
+// about 4 per thread so uneven threads balance out
+size_t UnitsPerTask(size_t count, size_t unitBytes, uint32_t threadCount) {
+	size_t units = (count + threadCount * 4 - 1) / (threadCount * 4);
+	if (unitBytes && units * unitBytes < MinBytesPerTask) {
+		units = (MinBytesPerTask + unitBytes - 1) / unitBytes;
+	}
+	return units ? units : 1;
+}
+
+// float and double formats are transformed in place on the stored values,
+// the image is one run of pixels so tasks are just sub runs
+template<typename T, uint32_t Period, typename Func>
+void TransformStored(Image_ImageHeader const *image, uint32_t threadCount, uint32_t componentCount, Func const &func) {
+	size_t const pixelCount = Image_PixelCountOf(image);
+	size_t const taskPixels = UnitsPerTask(pixelCount, sizeof(T) * componentCount, threadCount);
+	size_t const taskCount = (pixelCount + taskPixels - 1) / taskPixels;
+	T *data = (T *) Image_RawDataPtr(image);
+	Image::ParallelFor(threadCount, taskCount, [&](size_t taskIndex, uint32_t) {
+		size_t const begin = taskIndex * taskPixels;
+		size_t const count = (begin + taskPixels < pixelCount) ? taskPixels : pixelCount - begin;
+		func(data + begin * componentCount, count * componentCount);
+	});
+}
+
+template<uint32_t Period>
+void ApplyStored(Image_ImageHeader const *image, uint32_t threadCount, uint32_t componentCount, uint32_t bits, Affine const &affine) {
+	ExpandedAffine<Period> const expanded = Expand<Period>(affine, image->format, componentCount);
+	if (bits == 32) {
+		TransformStored<float, Period>(image, threadCount, componentCount, [&expanded](float *data, size_t valueCount) {
+			AffineF32_Vector(data, valueCount, expanded);
+		});
+	} else {
+		TransformStored<double, Period>(image, threadCount, componentCount, [&expanded](double *data, size_t valueCount) {
+			Affine_Scalar(data, valueCount, expanded);
+		});
+	}
+}
+
+// every other format decodes a row to double, transforms it and encodes it
+// back, tasks are bands of rows across every page
+void ApplyDecoded(Image_ImageHeader const *image, uint32_t threadCount, Affine const &affine) {
+	uint32_t const rowsPerPage = image->height;
+	size_t const rowCount = (size_t) rowsPerPage * image->depth * image->slices;
+	size_t const taskRows = UnitsPerTask(rowCount, Image_ByteCountPerRowOf(image), threadCount);
+	size_t const taskCount = (rowCount + taskRows - 1) / taskRows;
+	ExpandedAffine<4> const expanded = {
+			{affine.scale[0], affine.scale[1], affine.scale[2], affine.scale[3]},
+			{affine.bias[0], affine.bias[1], affine.bias[2], affine.bias[3]},
+	};
+
+	Image::ParallelFor(threadCount, taskCount, [&](size_t taskIndex, uint32_t) {
+		thread_local std::vector<double> row;
+		if (row.size() < (size_t) image->width * 4) {
+			row.resize((size_t) image->width * 4);
+		}
+		size_t const begin = taskIndex * taskRows;
+		size_t const end = (begin + taskRows < rowCount) ? begin + taskRows : rowCount;
+		for (size_t r = begin; r < end; ++r) {
+			size_t const page = r / rowsPerPage;
+			size_t const index = Image_CalculateIndex(image, 0, (uint32_t) (r % rowsPerPage),
+																								(uint32_t) (page % image->depth), (uint32_t) (page / image->depth));
+			Image_GetRowAtD(image, row.data(), index);
+			Affine_Scalar(row.data(), (size_t) image->width * 4, expanded);
+			Image_SetRowAtD(image, row.data(), index);
+		}
+	});
+}
+
+bool ApplyAffine(Image_ImageHeader const *image, uint32_t threadCount, Affine const &affine) {
+	if (TinyImageFormat_PixelCountOfBlock(image->format) != 1 ||
+			!TinyImageFormat_CanDecodeLogicalPixelsD(image->format) ||
+			!TinyImageFormat_CanEncodeLogicalPixelsD(image->format)) {
+		return false;
+	}
+	threadCount = Image::ResolveThreadCount(threadCount);
+
+	Image::PlainLayout const layout = Image::PlainLayoutOf(image->format);
+	if (layout.plain && TinyImageFormat_IsFloat(image->format) && (layout.bits == 32 || layout.bits == 64)) {
+		// lcm of the 4 floats per vector and the component count
+		if (layout.componentCount == 3) {
+			ApplyStored<12>(image, threadCount, 3, layout.bits, affine);
+		} else {
+			ApplyStored<4>(image, threadCount, layout.componentCount, layout.bits, affine);
+		}
+		return true;
+	}
+
+	ApplyDecoded(image, threadCount, affine);
+	return true;
+}
+
+void RangeOf(Image_ImageHeader const *image, Image_NormalizeDesc const *desc, double *omin, double *omax) {
+	if (desc->useRange) {
+		double const *rmin = &desc->rangeMin.r;
+		double const *rmax = &desc->rangeMax.r;
+		for (uint32_t i = 0; i < 4; ++i) {
+			omin[i] = rmin[i];
+			omax[i] = rmax[i];
+		}
+	} else {
+		Image::ColorRangeOf(image, desc->threadCount, omin, omax);
+	}
+}
+
+// what the plain entry points use, one thread and the range scanned
+Image_NormalizeDesc const DefaultNormalizeDesc = {1, false, {0.0, 0.0, 0.0, 0.0}, {1.0, 1.0, 1.0, 1.0}};
+
+} // end anon namespace
+
+AL2O3_EXTERN_C bool Image_NormalizeEachChannel(Image_ImageHeader const *src) {
+	return Image_NormalizeEachChannelEx(src, &DefaultNormalizeDesc);
+}
+
+AL2O3_EXTERN_C bool Image_NormalizeAcrossChannels(Image_ImageHeader const *src) {
+	return Image_NormalizeAcrossChannelsEx(src, &DefaultNormalizeDesc);
+}
+
+AL2O3_EXTERN_C bool Image_NormalizeEachChannelEx(Image_ImageHeader const *image, Image_NormalizeDesc const *desc) {
+	ASSERT(image);
+	ASSERT(desc);
+	if (Image_IsReadOnly(image)) {
+		return false;
+	}
+
+	double pmin[4] = {0.0, 0.0, 0.0, 0.0};
+	double pmax[4] = {1.0, 1.0, 1.0, 1.0};
+	RangeOf(image, desc, pmin, pmax);
+
+	// channels the format doesn't have are left as they are
+	Affine affine = {{1.0, 1.0, 1.0, 1.0}, {0.0, 0.0, 0.0, 0.0}};
+	uint32_t const channelCount = TinyImageFormat_ChannelCount(image->format);
+	for (uint32_t i = 0; i < channelCount; ++i) {
+		affine.scale[i] = 1.0 / (pmax[i] - pmin[i]);
+		affine.bias[i] = -pmin[i] * affine.scale[i];
+	}
+	return ApplyAffine(image, desc->threadCount, affine);
+}
+
+AL2O3_EXTERN_C bool Image_NormalizeAcrossChannelsEx(Image_ImageHeader const *image, Image_NormalizeDesc const *desc) {
+	ASSERT(image);
+	ASSERT(desc);
+	if (Image_IsReadOnly(image)) {
+		return false;
+	}
+
+	double pmin[4] = {0.0, 0.0, 0.0, 0.0};
+	double pmax[4] = {1.0, 1.0, 1.0, 1.0};
+	RangeOf(image, desc, pmin, pmax);
+
+	uint32_t const channelCount = TinyImageFormat_ChannelCount(image->format);
+	double dmin = pmin[0];
+	double dmax = pmax[0];
+	for (uint32_t i = 1; i < channelCount; ++i) {
+		if (pmin[i] < dmin) {
+			dmin = pmin[i];
+		}
+		if (pmax[i] > dmax) {
+			dmax = pmax[i];
+		}
+	}
+
+	double const s = 1.0 / (dmax - dmin);
+	double const b = -dmin * s;
+	Affine const affine = {{s, s, s, s}, {b, b, b, b}};
+	return ApplyAffine(image, desc->threadCount, affine);
+}
@@ -0,0 +1,128 @@
+#include "al2o3_platform/platform.h"
+#include "parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// one ParallelFor call, lives on the calling threads stack
+struct Job {
+	Image::TaskFunc func;
+	void *context;
+	size_t taskCount;
+	uint32_t threadCount;
+	std::atomic<size_t> nextTask;
+
+	// guarded by the pool mutex. Workers handed out so far (the caller is 0)
+	// and those still running tasks
+	uint32_t joined;
+	uint32_t active;
+	std::condition_variable finished;
+};
+
+void Work(Job &job, uint32_t workerIndex) {
+	for (size_t i = job.nextTask++; i < job.taskCount; i = job.nextTask++) {
+		job.func(job.context, i, workerIndex);
+	}
+}
+
+// Threads are only ever added, up to the most any call has asked for. Each
+// call queues its job for helpers then works on it itself, so it finishes
+// even if no helper ever picks it up (nested calls, a busy or short pool)
+class WorkerPool {
+public:
+	~WorkerPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto &thread : threads) {
+			thread.join();
+		}
+	}
+
+	void Run(Job &job) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			Grow(job.threadCount - 1);
+			if (!threads.empty()) {
+				jobs.push_back(&job);
+			}
+		}
+		wake.notify_all();
+		Work(job, 0);
+
+		// every task has been taken, stop more helpers joining and wait for the
+		// ones that did
+		std::unique_lock<std::mutex> lock(mutex);
+		jobs.erase(std::remove(jobs.begin(), jobs.end(), &job), jobs.end());
+		job.finished.wait(lock, [&job] { return job.active == 0; });
+	}
+
+private:
+	// called with the mutex held
+	void Grow(uint32_t count) {
+		while (threads.size() < count) {
+			try {
+				threads.emplace_back([this] { WorkerLoop(); });
+			} catch (...) {
+				// out of threads, run with what there is
+				LOGWARNING("Image worker pool couldn't start thread %u", (uint32_t) threads.size() + 1);
+				break;
+			}
+		}
+	}
+
+	void WorkerLoop() {
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;) {
+			wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+			if (stopping) {
+				return;
+			}
+			Job &job = *jobs.front();
+			uint32_t const workerIndex = ++job.joined;
+			if (job.joined + 1 >= job.threadCount) {
+				jobs.erase(jobs.begin());
+			}
+			++job.active;
+			lock.unlock();
+			Work(job, workerIndex);
+			lock.lock();
+			if (--job.active == 0) {
+				job.finished.notify_all();
+			}
+		}
+	}
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	// jobs still wanting helpers, oldest first
+	std::vector<Job *> jobs;
+	std::vector<std::thread> threads;
+	bool stopping = false;
+};
+
+WorkerPool &Pool() {
+	static WorkerPool pool;
+	return pool;
+}
+
+} // end anon namespace
+
+void Image::RunTasks(uint32_t threadCount, size_t taskCount, TaskFunc func, void *context) {
+	ASSERT(threadCount > 1);
+	Job job;
+	job.func = func;
+	job.context = context;
+	job.taskCount = taskCount;
+	job.threadCount = threadCount;
+	job.nextTask = 0;
+	job.joined = 0;
+	job.active = 0;
+	Pool().Run(job);
+}
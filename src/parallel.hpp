@@ -0,0 +1,53 @@
+// Minimal fork/join helper for spreading independent tasks over threads. The
+// helper threads are one pool made on first use and kept, so a call costs a
+// wake up rather than creating and joining threads
+#ifndef WYRD_IMAGE_PARALLEL_HPP
+#define WYRD_IMAGE_PARALLEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+namespace Image {
+
+// 0 means one thread per hardware thread
+inline uint32_t ResolveThreadCount(uint32_t requested) {
+	if (requested != 0) {
+		return requested;
+	}
+	uint32_t const hardware = std::thread::hardware_concurrency();
+	return hardware ? hardware : 1;
+}
+
+typedef void (*TaskFunc)(void *context, size_t taskIndex, uint32_t workerIndex);
+
+// ParallelFor without the template, threadCount is at least 2. Pool threads
+// that can't be started (or are busy with other calls) leave more of the
+// tasks to the calling thread, nothing is thrown
+void RunTasks(uint32_t threadCount, size_t taskCount, TaskFunc func, void *context);
+
+// calls func(taskIndex, workerIndex) for every task in [0, taskCount).
+// Tasks are handed out on demand to at most threadCount workers, the calling
+// thread is worker 0. workerIndex is always < threadCount so can be used to
+// pick per worker scratch data. With a threadCount of 1 everything runs in
+// order on the calling thread. Calls may nest or come from several threads
+template<typename Func>
+void ParallelFor(uint32_t threadCount, size_t taskCount, Func const &func) {
+	if (threadCount > taskCount) {
+		threadCount = (uint32_t) taskCount;
+	}
+	if (threadCount <= 1) {
+		for (size_t i = 0; i < taskCount; ++i) {
+			func(i, 0u);
+		}
+		return;
+	}
+
+	RunTasks(threadCount, taskCount, [](void *context, size_t taskIndex, uint32_t workerIndex) {
+		(*(Func const *) context)(taskIndex, workerIndex);
+	}, (void *) &func);
+}
+
+} // end namespace Image
+
+#endif //WYRD_IMAGE_PARALLEL_HPP
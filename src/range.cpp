@@ -0,0 +1,482 @@
+#include "al2o3_platform/platform.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "tiny_imageformat/tinyimageformat_query.h"
+#include "tiny_imageformat/tinyimageformat_decode.h"
+#include "gfx_image/image.h"
+#include "convert_kernels.hpp"
+#include "format_info.hpp"
+#include "parallel.hpp"
+#include "range.hpp"
+#include "simd.hpp"
+#include "view.hpp"
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// below this each task isn't worth a thread
+size_t const MinBytesPerTask = 1024 * 1024;
+
+// half floats are widened this many values at a time
+size_t const HalfBatchCount = 4096;
+
+template<typename T>
+T InitialMin() {
+	return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+}
+
+template<typename T>
+T InitialMax() {
+	return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+}
+
+// mn and mx hold componentCount running extremes, NaNs fail both compares so
+// are skipped
+template<typename T>
+void MinMax_Scalar(T const *src, size_t pixelCount, uint32_t componentCount, T *mn, T *mx) {
+	for (size_t i = 0; i < pixelCount; ++i) {
+		for (uint32_t c = 0; c < componentCount; ++c) {
+			T const v = src[c];
+			if (v < mn[c]) {
+				mn[c] = v;
+			}
+			if (v > mx[c]) {
+				mx[c] = v;
+			}
+		}
+		src += componentCount;
+	}
+}
+
+#if IMAGE_SIMD_X86 || (IMAGE_SIMD_NEON && (defined(__aarch64__) || defined(_M_ARM64)))
+// one 16 byte register of T, Min and Max keep acc when v is a NaN
+template<typename T>
+struct VectorOps;
+
+#if IMAGE_SIMD_X86
+// SSE4.1 is the first with min and max for every integer width we need
+#define IMAGE_RANGE_TARGET IMAGE_SIMD_TARGET("sse4.1")
+
+#define IMAGE_RANGE_INTEGER_OPS(type, minOp, maxOp) \
+template<> \
+struct VectorOps<type> { \
+	typedef __m128i V; \
+	IMAGE_RANGE_TARGET static V Load(type const *p) { return _mm_loadu_si128((__m128i const *) p); } \
+	IMAGE_RANGE_TARGET static void Store(type *p, V v) { _mm_storeu_si128((__m128i *) p, v); } \
+	IMAGE_RANGE_TARGET static V Min(V v, V acc) { return minOp(v, acc); } \
+	IMAGE_RANGE_TARGET static V Max(V v, V acc) { return maxOp(v, acc); } \
+};
+
+IMAGE_RANGE_INTEGER_OPS(uint8_t, _mm_min_epu8, _mm_max_epu8)
+IMAGE_RANGE_INTEGER_OPS(int8_t, _mm_min_epi8, _mm_max_epi8)
+IMAGE_RANGE_INTEGER_OPS(uint16_t, _mm_min_epu16, _mm_max_epu16)
+IMAGE_RANGE_INTEGER_OPS(int16_t, _mm_min_epi16, _mm_max_epi16)
+IMAGE_RANGE_INTEGER_OPS(uint32_t, _mm_min_epu32, _mm_max_epu32)
+IMAGE_RANGE_INTEGER_OPS(int32_t, _mm_min_epi32, _mm_max_epi32)
+#undef IMAGE_RANGE_INTEGER_OPS
+
+// minps/maxps return the second operand when either is a NaN
+template<>
+struct VectorOps<float> {
+	typedef __m128 V;
+	IMAGE_RANGE_TARGET static V Load(float const *p) { return _mm_loadu_ps(p); }
+	IMAGE_RANGE_TARGET static void Store(float *p, V v) { _mm_storeu_ps(p, v); }
+	IMAGE_RANGE_TARGET static V Min(V v, V acc) { return _mm_min_ps(v, acc); }
+	IMAGE_RANGE_TARGET static V Max(V v, V acc) { return _mm_max_ps(v, acc); }
+};
+
+template<>
+struct VectorOps<double> {
+	typedef __m128d V;
+	IMAGE_RANGE_TARGET static V Load(double const *p) { return _mm_loadu_pd(p); }
+	IMAGE_RANGE_TARGET static void Store(double *p, V v) { _mm_storeu_pd(p, v); }
+	IMAGE_RANGE_TARGET static V Min(V v, V acc) { return _mm_min_pd(v, acc); }
+	IMAGE_RANGE_TARGET static V Max(V v, V acc) { return _mm_max_pd(v, acc); }
+};
+
+#else
+#define IMAGE_RANGE_TARGET
+
+#define IMAGE_RANGE_NEON_OPS(type, vtype, suffix) \
+template<> \
+struct VectorOps<type> { \
+	typedef vtype V; \
+	static V Load(type const *p) { return vld1q_##suffix(p); } \
+	static void Store(type *p, V v) { vst1q_##suffix(p, v); } \
+	static V Min(V v, V acc) { return vminq_##suffix(v, acc); } \
+	static V Max(V v, V acc) { return vmaxq_##suffix(v, acc); } \
+};
+
+IMAGE_RANGE_NEON_OPS(uint8_t, uint8x16_t, u8)
+IMAGE_RANGE_NEON_OPS(int8_t, int8x16_t, s8)
+IMAGE_RANGE_NEON_OPS(uint16_t, uint16x8_t, u16)
+IMAGE_RANGE_NEON_OPS(int16_t, int16x8_t, s16)
+IMAGE_RANGE_NEON_OPS(uint32_t, uint32x4_t, u32)
+IMAGE_RANGE_NEON_OPS(int32_t, int32x4_t, s32)
+#undef IMAGE_RANGE_NEON_OPS
+
+// the nm variants return the number when one operand is a NaN, plain
+// vminq/vmaxq would return the NaN
+template<>
+struct VectorOps<float> {
+	typedef float32x4_t V;
+	static V Load(float const *p) { return vld1q_f32(p); }
+	static void Store(float *p, V v) { vst1q_f32(p, v); }
+	static V Min(V v, V acc) { return vminnmq_f32(v, acc); }
+	static V Max(V v, V acc) { return vmaxnmq_f32(v, acc); }
+};
+
+template<>
+struct VectorOps<double> {
+	typedef float64x2_t V;
+	static V Load(double const *p) { return vld1q_f64(p); }
+	static void Store(double *p, V v) { vst1q_f64(p, v); }
+	static V Min(V v, V acc) { return vminnmq_f64(v, acc); }
+	static V Max(V v, V acc) { return vmaxnmq_f64(v, acc); }
+};
+#endif
+
+// the channel pattern of interleaved pixels repeats every
+// VectorCount * lanes values (the lcm of the lanes and the component count),
+// so each of VectorCount accumulators only ever sees a fixed channel per lane
+// and the per channel result is folded out of the lanes at the end
+template<typename T, uint32_t VectorCount>
+IMAGE_RANGE_TARGET
+void MinMax_Vector(T const *src, size_t pixelCount, uint32_t componentCount, T *mn, T *mx) {
+	typedef VectorOps<T> Ops;
+	typedef typename Ops::V V;
+	uint32_t const lanes = 16 / sizeof(T);
+	uint32_t const period = VectorCount * lanes;
+
+	size_t const blockCount = (pixelCount * componentCount) / period;
+	if (blockCount) {
+		T laneMin[VectorCount * lanes];
+		T laneMax[VectorCount * lanes];
+		for (uint32_t i = 0; i < period; ++i) {
+			laneMin[i] = mn[i % componentCount];
+			laneMax[i] = mx[i % componentCount];
+		}
+		V accMin[VectorCount];
+		V accMax[VectorCount];
+		for (uint32_t v = 0; v < VectorCount; ++v) {
+			accMin[v] = Ops::Load(laneMin + v * lanes);
+			accMax[v] = Ops::Load(laneMax + v * lanes);
+		}
+
+		for (size_t b = 0; b < blockCount; ++b) {
+			for (uint32_t v = 0; v < VectorCount; ++v) {
+				V const x = Ops::Load(src + v * lanes);
+				accMin[v] = Ops::Min(x, accMin[v]);
+				accMax[v] = Ops::Max(x, accMax[v]);
+			}
+			src += period;
+		}
+
+		for (uint32_t v = 0; v < VectorCount; ++v) {
+			Ops::Store(laneMin + v * lanes, accMin[v]);
+			Ops::Store(laneMax + v * lanes, accMax[v]);
+		}
+		for (uint32_t i = 0; i < period; ++i) {
+			uint32_t const c = i % componentCount;
+			if (laneMin[i] < mn[c]) {
+				mn[c] = laneMin[i];
+			}
+			if (laneMax[i] > mx[c]) {
+				mx[c] = laneMax[i];
+			}
+		}
+	}
+
+	// the period is a whole number of pixels so the tail starts on one
+	MinMax_Scalar(src, pixelCount - (blockCount * period) / componentCount, componentCount, mn, mx);
+}
+
+template<typename T>
+struct MinMaxSelect {
+	typedef void (*Func)(T const *src, size_t pixelCount, uint32_t componentCount, T *mn, T *mx);
+
+	// index is the component count
+	static Func const *Table() {
+		static Func const table[5] = {
+				nullptr,
+				Pick(1), Pick(2), Pick(3), Pick(4),
+		};
+		return table;
+	}
+
+	static Func Pick(uint32_t componentCount) {
+#if IMAGE_SIMD_X86
+		if (!Image::GetCpuFeatures().sse41) {
+			return &MinMax_Scalar<T>;
+		}
+#endif
+		uint32_t const lanes = 16 / sizeof(T);
+		uint32_t vectorCount = 1;
+		while ((vectorCount * lanes) % componentCount) {
+			++vectorCount;
+		}
+		switch (vectorCount) {
+		case 1: return &MinMax_Vector<T, 1>;
+		case 2: return &MinMax_Vector<T, 2>;
+		case 3: return &MinMax_Vector<T, 3>;
+		default: return &MinMax_Scalar<T>;
+		}
+	}
+};
+
+// 64 bit integers have no vector min or max before AVX-512
+template<>
+struct MinMaxSelect<uint64_t> {
+	typedef void (*Func)(uint64_t const *src, size_t pixelCount, uint32_t componentCount, uint64_t *mn, uint64_t *mx);
+	static Func const *Table() {
+		static Func const table[5] = {nullptr, &MinMax_Scalar, &MinMax_Scalar, &MinMax_Scalar, &MinMax_Scalar};
+		return table;
+	}
+};
+
+template<>
+struct MinMaxSelect<int64_t> {
+	typedef void (*Func)(int64_t const *src, size_t pixelCount, uint32_t componentCount, int64_t *mn, int64_t *mx);
+	static Func const *Table() {
+		static Func const table[5] = {nullptr, &MinMax_Scalar, &MinMax_Scalar, &MinMax_Scalar, &MinMax_Scalar};
+		return table;
+	}
+};
+
+template<typename T>
+void MinMax(T const *src, size_t pixelCount, uint32_t componentCount, T *mn, T *mx) {
+	MinMaxSelect<T>::Table()[componentCount](src, pixelCount, componentCount, mn, mx);
+}
+
+#else
+template<typename T>
+void MinMax(T const *src, size_t pixelCount, uint32_t componentCount, T *mn, T *mx) {
+	MinMax_Scalar(src, pixelCount, componentCount, mn, mx);
+}
+#endif
+
+// halfs are widened in batches then reduced as floats
+void MinMaxHalf(uint16_t const *src, size_t pixelCount, uint32_t componentCount, float *mn, float *mx) {
+	float batch[HalfBatchCount];
+	size_t const batchPixels = HalfBatchCount / componentCount;
+	while (pixelCount) {
+		size_t const count = pixelCount < batchPixels ? pixelCount : batchPixels;
+		Image::HalfToFloat(src, batch, count * componentCount);
+		MinMax(batch, count, componentCount, mn, mx);
+		src += count * componentCount;
+		pixelCount -= count;
+	}
+}
+
+// each task reduces a run of whole pixels of Stored values into its own slot
+// of Acc extremes, the slots are combined in task order so the result never
+// depends on the thread count
+template<typename Stored, typename T, typename Reduce>
+void ReducePlain(Image_View const &view,
+								 uint32_t threadCount,
+								 uint32_t componentCount,
+								 Reduce const &reduce,
+								 T *mn,
+								 T *mx) {
+	size_t const pixelCount = Image::PixelCountOf(view);
+	size_t const pixelBytes = sizeof(Stored) * componentCount;
+	threadCount = Image::ResolveThreadCount(threadCount);
+
+	size_t taskPixels = (pixelCount + threadCount * 4 - 1) / (threadCount * 4);
+	if (taskPixels * pixelBytes < MinBytesPerTask) {
+		taskPixels = MinBytesPerTask / pixelBytes;
+	}
+	size_t const taskCount = pixelCount ? (pixelCount + taskPixels - 1) / taskPixels : 0;
+
+	std::vector<T> taskMin(taskCount * componentCount);
+	std::vector<T> taskMax(taskCount * componentCount);
+	Image::ParallelFor(threadCount, taskCount, [&](size_t taskIndex, uint32_t) {
+		size_t const begin = taskIndex * taskPixels;
+		size_t const count = (begin + taskPixels < pixelCount) ? taskPixels : pixelCount - begin;
+		T *tmn = taskMin.data() + taskIndex * componentCount;
+		T *tmx = taskMax.data() + taskIndex * componentCount;
+		for (uint32_t c = 0; c < componentCount; ++c) {
+			tmn[c] = InitialMin<T>();
+			tmx[c] = InitialMax<T>();
+		}
+		Image::ForEachRun(view, begin, count, [&](uint8_t const *run, size_t runCount) {
+			reduce((Stored const *) run, runCount, componentCount, tmn, tmx);
+		});
+	});
+
+	for (uint32_t c = 0; c < componentCount; ++c) {
+		mn[c] = InitialMin<T>();
+		mx[c] = InitialMax<T>();
+	}
+	for (size_t t = 0; t < taskCount; ++t) {
+		T const *tmn = taskMin.data() + t * componentCount;
+		T const *tmx = taskMax.data() + t * componentCount;
+		for (uint32_t c = 0; c < componentCount; ++c) {
+			if (tmn[c] < mn[c]) {
+				mn[c] = tmn[c];
+			}
+			if (tmx[c] > mx[c]) {
+				mx[c] = tmx[c];
+			}
+		}
+	}
+}
+
+template<typename T>
+void ReducePlain(Image_View const &view, uint32_t threadCount, uint32_t componentCount, T *mn, T *mx) {
+	ReducePlain<T, T>(view, threadCount, componentCount, &MinMax<T>, mn, mx);
+}
+
+// every plain integer or float format stores values whose order matches
+// their decoded order (normalised, sRGB and two's complement included), so
+// the stored extremes decode to the extremes of the decoded values. Fills
+// minPixel and maxPixel with the stored extremes, false for other formats
+bool ReduceStored(Image_View const &view, uint32_t threadCount, uint8_t *minPixel, uint8_t *maxPixel) {
+	Image::PlainLayout const layout = Image::PlainLayoutOf(view.format);
+	if (!layout.plain || layout.componentCount > 4) {
+		return false;
+	}
+	uint32_t const n = layout.componentCount;
+
+	if (TinyImageFormat_IsFloat(view.format)) {
+		switch (layout.bits) {
+		case 16: {
+			// back through FloatToHalf, exact as the extremes started as halfs
+			float fmn[4];
+			float fmx[4];
+			ReducePlain<uint16_t, float>(view, threadCount, n, &MinMaxHalf, fmn, fmx);
+			Image::FloatToHalf(fmn, (uint16_t *) minPixel, n);
+			Image::FloatToHalf(fmx, (uint16_t *) maxPixel, n);
+			return true;
+		}
+		case 32: ReducePlain<float>(view, threadCount, n, (float *) minPixel, (float *) maxPixel);
+			return true;
+		case 64: ReducePlain<double>(view, threadCount, n, (double *) minPixel, (double *) maxPixel);
+			return true;
+		default: return false;
+		}
+	}
+
+	bool const isSigned = TinyImageFormat_IsSigned(view.format);
+	switch (layout.bits) {
+	case 8:
+		if (isSigned) {
+			ReducePlain<int8_t>(view, threadCount, n, (int8_t *) minPixel, (int8_t *) maxPixel);
+		} else {
+			ReducePlain<uint8_t>(view, threadCount, n, minPixel, maxPixel);
+		}
+		return true;
+	case 16:
+		if (isSigned) {
+			ReducePlain<int16_t>(view, threadCount, n, (int16_t *) minPixel, (int16_t *) maxPixel);
+		} else {
+			ReducePlain<uint16_t>(view, threadCount, n, (uint16_t *) minPixel, (uint16_t *) maxPixel);
+		}
+		return true;
+	case 32:
+		if (isSigned) {
+			ReducePlain<int32_t>(view, threadCount, n, (int32_t *) minPixel, (int32_t *) maxPixel);
+		} else {
+			ReducePlain<uint32_t>(view, threadCount, n, (uint32_t *) minPixel, (uint32_t *) maxPixel);
+		}
+		return true;
+	case 64:
+		if (isSigned) {
+			ReducePlain<int64_t>(view, threadCount, n, (int64_t *) minPixel, (int64_t *) maxPixel);
+		} else {
+			ReducePlain<uint64_t>(view, threadCount, n, (uint64_t *) minPixel, (uint64_t *) maxPixel);
+		}
+		return true;
+	default: return false;
+	}
+}
+
+// packed and block formats decode a row at a time, tasks are bands of rows
+void ReduceDecoded(Image_View const &view, uint32_t threadCount, double *omin, double *omax) {
+	size_t const rowCount = Image::RowCountOf(view);
+	uint32_t const blocksPerRow = Image::BlocksPerRowOf(view);
+	size_t const rowPixels = (size_t) blocksPerRow * TinyImageFormat_PixelCountOfBlock(view.format);
+	threadCount = Image::ResolveThreadCount(threadCount);
+
+	size_t taskRows = (rowCount + threadCount * 4 - 1) / (threadCount * 4);
+	size_t const rowBytes = blocksPerRow * Image::BlockSizeOf(view);
+	if (rowBytes && taskRows * rowBytes < MinBytesPerTask) {
+		taskRows = (MinBytesPerTask + rowBytes - 1) / rowBytes;
+	}
+	if (taskRows == 0) {
+		taskRows = 1;
+	}
+	size_t const taskCount = (rowCount + taskRows - 1) / taskRows;
+
+	std::vector<double> taskMin(taskCount * 4, std::numeric_limits<double>::infinity());
+	std::vector<double> taskMax(taskCount * 4, -std::numeric_limits<double>::infinity());
+	Image::ParallelFor(threadCount, taskCount, [&](size_t taskIndex, uint32_t) {
+		thread_local std::vector<double> row;
+		if (row.size() < rowPixels * 4) {
+			row.resize(rowPixels * 4);
+		}
+		size_t const begin = taskIndex * taskRows;
+		size_t const end = (begin + taskRows < rowCount) ? begin + taskRows : rowCount;
+		for (size_t r = begin; r < end; ++r) {
+			TinyImageFormat_FetchInput input{Image::RowPtrOf(view, r)};
+			TinyImageFormat_DecodeLogicalPixelsD(view.format, &input, blocksPerRow, row.data());
+			MinMax_Scalar<double>(row.data(), rowPixels, 4, taskMin.data() + taskIndex * 4, taskMax.data() + taskIndex * 4);
+		}
+	});
+
+	uint32_t const channelCount = TinyImageFormat_ChannelCount(view.format);
+	for (size_t t = 0; t < taskCount; ++t) {
+		for (uint32_t i = 0; i < channelCount; ++i) {
+			if (taskMin[t * 4 + i] < omin[i]) {
+				omin[i] = taskMin[t * 4 + i];
+			}
+			if (taskMax[t * 4 + i] > omax[i]) {
+				omax[i] = taskMax[t * 4 + i];
+			}
+		}
+	}
+}
+
+} // end anon namespace
+
+void Image::ColorRangeOf(Image_ImageHeader const *image, uint32_t threadCount, double *omin, double *omax) {
+	ASSERT(image);
+	Image_View const view = StorageViewOf(image);
+	ColorRangeOf(view, threadCount, omin, omax);
+}
+
+void Image::ColorRangeOf(Image_View const &view, uint32_t threadCount, double *omin, double *omax) {
+	ASSERT(omin);
+	ASSERT(omax);
+
+	uint32_t const channelCount = TinyImageFormat_ChannelCount(view.format);
+	for (uint32_t i = 0u; i < channelCount; ++i) {
+		omin[i] = TinyImageFormat_Max(view.format, (TinyImageFormat_LogicalChannel) i);
+		omax[i] = TinyImageFormat_Min(view.format, (TinyImageFormat_LogicalChannel) i);
+	}
+
+	uint8_t minPixel[32];
+	uint8_t maxPixel[32];
+	if (ReduceStored(view, threadCount, minPixel, maxPixel)) {
+		double decodedMin[4];
+		double decodedMax[4];
+		TinyImageFormat_FetchInput minInput{minPixel};
+		TinyImageFormat_FetchInput maxInput{maxPixel};
+		TinyImageFormat_DecodeLogicalPixelsD(view.format, &minInput, 1, decodedMin);
+		TinyImageFormat_DecodeLogicalPixelsD(view.format, &maxInput, 1, decodedMax);
+		for (uint32_t i = 0u; i < channelCount; ++i) {
+			if (decodedMin[i] < omin[i]) {
+				omin[i] = decodedMin[i];
+			}
+			if (decodedMax[i] > omax[i]) {
+				omax[i] = decodedMax[i];
+			}
+		}
+		return;
+	}
+
+	if (TinyImageFormat_CanDecodeLogicalPixelsD(view.format)) {
+		ReduceDecoded(view, threadCount, omin, omax);
+	}
+}
@@ -0,0 +1,25 @@
+// Per channel min and max reduction behind Image_GetColorRangeOf. Plain
+// integer and float formats are reduced directly on the stored values a
+// vector at a time, with only the two extremes decoded at the end
+#ifndef WYRD_IMAGE_RANGE_HPP
+#define WYRD_IMAGE_RANGE_HPP
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image_impl_basic/view.h"
+
+namespace Image {
+
+// omin and omax get the min and max of each logical channel over every pixel
+// of the image, for the first TinyImageFormat_ChannelCount channels. Channels
+// start at the formats max (for omin) and min (for omax), NaNs are ignored.
+// threadCount of 0 uses every hardware thread, small images always run on
+// the calling thread
+void ColorRangeOf(Image_ImageHeader const *image, uint32_t threadCount, double *omin, double *omax);
+
+// the same over the pixels of a view
+void ColorRangeOf(Image_View const &view, uint32_t threadCount, double *omin, double *omax);
+
+} // end namespace Image
+
+#endif //WYRD_IMAGE_RANGE_HPP
@@ -0,0 +1,45 @@
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image/utils.h"
+#include "gfx_image_impl_basic/mapped.h"
+#include "gfx_image_impl_basic/shared.h"
+#include "allocator.hpp"
+
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CreateSharedSnapshot(Image_ImageHeader const *image) {
+	ASSERT(image);
+	// every link is retained and marked so a write to any of them sees it shared
+	for (Image_ImageHeader const *link = image; link; link = link->nextType != Image_NT_None ? link->nextImage : nullptr) {
+		Image::RetainImage(link);
+		if (!(link->flags & Image_Flag_Shared)) {
+			((Image_ImageHeader *) link)->flags |= Image_Flag_Shared;
+		}
+	}
+	return image;
+}
+
+AL2O3_EXTERN_C bool Image_IsShared(Image_ImageHeader const *image) {
+	ASSERT(image);
+	// only snapshotted images have a reference count worth reading, the flag
+	// stays once the other references are gone
+	return (image->flags & Image_Flag_Shared) && Image::ReferenceCountOf(image) > 1;
+}
+
+AL2O3_EXTERN_C bool Image_IsReadOnly(Image_ImageHeader const *image) {
+	ASSERT(image);
+	return (image->flags & Image_Flag_ReadOnly) || Image_IsShared(image);
+}
+
+AL2O3_EXTERN_C Image_ImageHeader const *Image_Unshare(Image_ImageHeader const *image) {
+	ASSERT(image);
+	if (!Image_IsReadOnly(image)) {
+		return image;
+	}
+	Image_ImageHeader const *copy = Image_Clone(image);
+	if (!copy) {
+		return nullptr;
+	}
+	// if every other reference went away since the check this frees it
+	Image_Destroy(image);
+	return copy;
+}
@@ -0,0 +1,85 @@
+// Runtime CPU feature detection and the helpers the SIMD kernels need to be
+// compiled for an instruction set without changing the global compiler flags
+#ifndef WYRD_IMAGE_SIMD_HPP
+#define WYRD_IMAGE_SIMD_HPP
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define IMAGE_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define IMAGE_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang only allow intrinsics inside functions compiled for the
+// matching target, MSVC allows them anywhere
+#if defined(__GNUC__) || defined(__clang__)
+#define IMAGE_SIMD_TARGET(x) __attribute__((target(x)))
+#else
+#define IMAGE_SIMD_TARGET(x)
+#endif
+
+namespace Image {
+
+struct CpuFeatures {
+	bool ssse3;
+	bool sse41;
+	bool avx;
+	bool avx2;
+	bool f16c;
+};
+
+inline CpuFeatures DetectCpuFeatures() {
+	CpuFeatures features{};
+#if IMAGE_SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	int const maxLeaf = info[0];
+	if (maxLeaf >= 1) {
+		__cpuid(info, 1);
+		features.ssse3 = (info[2] & (1 << 9)) != 0;
+		features.sse41 = (info[2] & (1 << 19)) != 0;
+		features.f16c = (info[2] & (1 << 29)) != 0;
+		bool const osxsave = (info[2] & (1 << 27)) != 0;
+		bool const cpuAvx = (info[2] & (1 << 28)) != 0;
+		// the OS must save the YMM registers for any AVX instruction to be usable
+		bool const osYmm = osxsave && ((_xgetbv(0) & 0x6) == 0x6);
+		features.avx = cpuAvx && osYmm;
+		features.f16c = features.f16c && osYmm;
+		if (maxLeaf >= 7) {
+			__cpuidex(info, 7, 0);
+			features.avx2 = features.avx && (info[1] & (1 << 5)) != 0;
+		}
+	}
+#else
+	__builtin_cpu_init();
+	features.ssse3 = __builtin_cpu_supports("ssse3");
+	features.sse41 = __builtin_cpu_supports("sse4.1");
+	features.avx = __builtin_cpu_supports("avx");
+	features.avx2 = __builtin_cpu_supports("avx2");
+	// f16c isn't a __builtin_cpu_supports name on all compilers, so ask cpuid
+	// directly, it shares the AVX OS support requirement
+	unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+		features.f16c = features.avx && (ecx & (1u << 29)) != 0;
+	}
+#endif
+#endif
+	return features;
+}
+
+// detected once on first use, thread safe via static local initialisation
+inline CpuFeatures const& GetCpuFeatures() {
+	static CpuFeatures const features = DetectCpuFeatures();
+	return features;
+}
+
+} // end namespace Image
+
+#endif //WYRD_IMAGE_SIMD_HPP
@@ -0,0 +1,117 @@
+#include "al2o3_platform/platform.h"
+#include "srgb.hpp"
+#include <cmath>
+
+namespace {
+
+// encode guesses are exact at the sample points, between them the code can
+// change by at most one step (the curve is steepest at 0, 12.92 * 255 codes
+// per unit vs 4096 samples) which the threshold compares fix up
+static uint32_t const EncodeGuessCount = 4096;
+
+struct SRGBTables {
+	float srgbDecode[256];
+	float unormDecode[256];
+	// linear value of the sRGB midpoint between code k and k + 1
+	float thresholds[255];
+	uint8_t encodeGuess[EncodeGuessCount + 1];
+};
+
+double SRGBToLinearPrecise(double s) {
+	return s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4);
+}
+
+double LinearToSRGBPrecise(double l) {
+	return l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+}
+
+SRGBTables BuildTables() {
+	SRGBTables tables;
+	for (uint32_t i = 0; i < 256; ++i) {
+		tables.srgbDecode[i] = (float) SRGBToLinearPrecise(i / 255.0);
+		tables.unormDecode[i] = (float) (i / 255.0);
+	}
+	for (uint32_t i = 0; i < 255; ++i) {
+		tables.thresholds[i] = (float) SRGBToLinearPrecise((i + 0.5) / 255.0);
+	}
+	for (uint32_t i = 0; i <= EncodeGuessCount; ++i) {
+		double const s = LinearToSRGBPrecise((double) i / EncodeGuessCount);
+		tables.encodeGuess[i] = (uint8_t) std::floor(s * 255.0 + 0.5);
+	}
+	return tables;
+}
+
+// built once on first use, thread safe via static local initialisation
+SRGBTables const &Tables() {
+	static SRGBTables const tables = BuildTables();
+	return tables;
+}
+
+uint8_t EncodeSRGB(SRGBTables const &tables, float v) {
+	// also catches NaN
+	if (!(v > 0.0f)) {
+		return 0;
+	}
+	if (v >= 1.0f) {
+		return 255;
+	}
+	uint32_t code = tables.encodeGuess[(uint32_t) (v * (float) EncodeGuessCount)];
+	while (code < 255 && v >= tables.thresholds[code]) {
+		++code;
+	}
+	while (code > 0 && v < tables.thresholds[code - 1]) {
+		--code;
+	}
+	return (uint8_t) code;
+}
+
+uint8_t EncodeUnorm(float v) {
+	if (!(v > 0.0f)) {
+		return 0;
+	}
+	if (v >= 1.0f) {
+		return 255;
+	}
+	return (uint8_t) (v * 255.0f + 0.5f);
+}
+
+} // end anon namespace
+
+namespace Image {
+
+float SRGB8ToLinear(uint8_t v) {
+	return Tables().srgbDecode[v];
+}
+
+uint8_t LinearToSRGB8(float v) {
+	return EncodeSRGB(Tables(), v);
+}
+
+void SRGB8RowToLinear(uint8_t const *src, float *dst, size_t pixelCount, uint32_t componentCount, uint32_t srgbMask) {
+	ASSERT(componentCount <= 4);
+	SRGBTables const &tables = Tables();
+	float const *decode[4];
+	for (uint32_t c = 0; c < componentCount; ++c) {
+		decode[c] = (srgbMask & (1u << c)) ? tables.srgbDecode : tables.unormDecode;
+	}
+	for (size_t i = 0; i < pixelCount; ++i) {
+		for (uint32_t c = 0; c < componentCount; ++c) {
+			dst[c] = decode[c][src[c]];
+		}
+		src += componentCount;
+		dst += componentCount;
+	}
+}
+
+void LinearRowToSRGB8(float const *src, uint8_t *dst, size_t pixelCount, uint32_t componentCount, uint32_t srgbMask) {
+	SRGBTables const &tables = Tables();
+	for (size_t i = 0; i < pixelCount; ++i) {
+		for (uint32_t c = 0; c < componentCount; ++c) {
+			dst[c] = (srgbMask & (1u << c)) ? EncodeSRGB(tables, src[c]) : EncodeUnorm(src[c]);
+		}
+		src += componentCount;
+		dst += componentCount;
+	}
+}
+
+} // end namespace Image
@@ -0,0 +1,23 @@
+// 8 bit sRGB channel conversion, decode is a 256 entry table and encode a
+// coarse table lookup refined against the code boundaries, giving the same
+// code as rounding the precise transfer function except for values within
+// float precision of a half way point
+#ifndef WYRD_IMAGE_SRGB_HPP
+#define WYRD_IMAGE_SRGB_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Image {
+
+float SRGB8ToLinear(uint8_t v);
+uint8_t LinearToSRGB8(float v);
+
+// pixelCount pixels of componentCount 8 bit channels, components with their
+// bit set in srgbMask use the sRGB curve, the rest (alpha) are plain unorm
+void SRGB8RowToLinear(uint8_t const *src, float *dst, size_t pixelCount, uint32_t componentCount, uint32_t srgbMask);
+void LinearRowToSRGB8(float const *src, uint8_t *dst, size_t pixelCount, uint32_t componentCount, uint32_t srgbMask);
+
+} // end namespace Image
+
+#endif //WYRD_IMAGE_SRGB_HPP
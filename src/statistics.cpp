@@ -0,0 +1,492 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "tiny_imageformat/tinyimageformat_query.h"
+#include "tiny_imageformat/tinyimageformat_decode.h"
+#include "gfx_image/image.h"
+#include "gfx_image/utils.h"
+#include "gfx_image_impl_basic/statistics.h"
+#include "convert_kernels.hpp"
+#include "format_info.hpp"
+#include "parallel.hpp"
+#include "range.hpp"
+#include "view.hpp"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// tasks are a fixed number of pixels whatever the thread count, the floating
+// point sums of each are combined in task order so results never change
+size_t const PixelsPerTask = 64 * 1024;
+
+uint32_t const DefaultBinCount = 256;
+
+// half floats are widened this many values at a time
+size_t const HalfBatchCount = 4096;
+
+// per logical channel sums of one task, shifted by the histogram midpoint so
+// the squares don't lose the variance to cancellation
+struct Partial {
+	uint64_t count[4];
+	double mn[4];
+	double mx[4];
+	double sum[4];
+	double sumSquares[4];
+};
+
+struct Bins {
+	uint32_t count;
+	double lo[4];
+	double scale[4];
+	double shift[4];
+};
+
+Partial EmptyPartial() {
+	Partial partial;
+	for (uint32_t i = 0; i < 4; ++i) {
+		partial.count[i] = 0;
+		partial.mn[i] = std::numeric_limits<double>::infinity();
+		partial.mx[i] = -std::numeric_limits<double>::infinity();
+		partial.sum[i] = 0.0;
+		partial.sumSquares[i] = 0.0;
+	}
+	return partial;
+}
+
+// NaN (from a zero or infinite range) lands in bin 0, past the top in the last
+inline uint32_t BinOf(double v, double lo, double scale, uint32_t binCount) {
+	double const b = (v - lo) * scale;
+	if (!(b >= 0.0)) {
+		return 0;
+	}
+	return b >= (double) binCount ? binCount - 1 : (uint32_t) b;
+}
+
+Bins MakeBins(uint32_t binCount, double const *lo, double const *hi) {
+	Bins bins;
+	bins.count = binCount;
+	for (uint32_t i = 0; i < 4; ++i) {
+		double const range = hi[i] - lo[i];
+		bins.lo[i] = lo[i];
+		bins.scale[i] = range > 0.0 ? binCount / range : 0.0;
+		double const mid = lo[i] + range * 0.5;
+		bins.shift[i] = std::isfinite(mid) ? mid : 0.0;
+	}
+	return bins;
+}
+
+// channelOf maps each stored component to its logical channel, -1 to skip
+template<typename T>
+void Accumulate(T const *src,
+								size_t pixelCount,
+								uint32_t componentCount,
+								int32_t const *channelOf,
+								Bins const &bins,
+								Partial &partial,
+								uint64_t *histogram) {
+	for (size_t p = 0; p < pixelCount; ++p) {
+		for (uint32_t c = 0; c < componentCount; ++c) {
+			int32_t const lc = channelOf[c];
+			double const v = (double) src[c];
+			if (lc < 0 || v != v) {
+				continue;
+			}
+			partial.count[lc]++;
+			if (v < partial.mn[lc]) {
+				partial.mn[lc] = v;
+			}
+			if (v > partial.mx[lc]) {
+				partial.mx[lc] = v;
+			}
+			double const d = v - bins.shift[lc];
+			partial.sum[lc] += d;
+			partial.sumSquares[lc] += d * d;
+			histogram[lc * bins.count + BinOf(v, bins.lo[lc], bins.scale[lc], bins.count)]++;
+		}
+		src += componentCount;
+	}
+}
+
+// histograms are integer counts so per worker ones summed in any order are
+// still deterministic, only the per task sums need keeping apart
+struct Workers {
+	Workers(uint32_t threadCount, size_t histogramSize) : histograms(threadCount) {
+		for (auto &histogram : histograms) {
+			histogram.assign(histogramSize, 0);
+		}
+	}
+
+	void SumInto(uint64_t *histogram) const {
+		for (auto const &worker : histograms) {
+			for (size_t i = 0; i < worker.size(); ++i) {
+				histogram[i] += worker[i];
+			}
+		}
+	}
+
+	std::vector<std::vector<uint64_t>> histograms;
+};
+
+// every stored component of a plain format and the logical channel it is
+int32_t ChannelOfComponent(TinyImageFormat fmt, uint32_t component) {
+	TinyImageFormat_LogicalChannel const lc = TinyImageFormat_PhysicalChannelToLogical(fmt, (int) component);
+	return (lc >= 0 && lc < 4) ? (int32_t) lc : -1;
+}
+
+void Finish(std::vector<Partial> const &partials, Bins const &bins, Image_Statistics *stats) {
+	for (uint32_t i = 0; i < 4; ++i) {
+		Image_ChannelStatistics &channel = stats->channel[i];
+		// Chan et al. pairwise combine of (count, mean, sum of squared
+		// differences), in task order
+		uint64_t n = 0;
+		double mean = 0.0;
+		double m2 = 0.0;
+		double mn = std::numeric_limits<double>::infinity();
+		double mx = -std::numeric_limits<double>::infinity();
+		for (auto const &partial : partials) {
+			uint64_t const nb = partial.count[i];
+			if (nb == 0) {
+				continue;
+			}
+			double const meanB = bins.shift[i] + partial.sum[i] / (double) nb;
+			double m2B = partial.sumSquares[i] - partial.sum[i] * partial.sum[i] / (double) nb;
+			if (m2B < 0.0) {
+				m2B = 0.0;
+			}
+			uint64_t const total = n + nb;
+			double const delta = meanB - mean;
+			mean += delta * ((double) nb / (double) total);
+			m2 += m2B + delta * delta * ((double) n * (double) nb / (double) total);
+			n = total;
+			if (partial.mn[i] < mn) {
+				mn = partial.mn[i];
+			}
+			if (partial.mx[i] > mx) {
+				mx = partial.mx[i];
+			}
+		}
+		channel.count = n;
+		channel.min = n ? mn : 0.0;
+		channel.max = n ? mx : 0.0;
+		channel.mean = mean;
+		channel.variance = n ? m2 / (double) n : 0.0;
+	}
+}
+
+void RangeForBins(Image_StatisticsDesc const *desc, double const *scannedMin, double const *scannedMax, double *lo, double *hi) {
+	for (uint32_t i = 0; i < 4; ++i) {
+		lo[i] = desc->useRange ? (&desc->rangeMin.r)[i] : scannedMin[i];
+		hi[i] = desc->useRange ? (&desc->rangeMax.r)[i] : scannedMax[i];
+	}
+}
+
+void StoreBins(double const *lo, double const *hi, Image_Statistics *stats) {
+	for (uint32_t i = 0; i < 4; ++i) {
+		stats->channel[i].histogramMin = lo[i];
+		stats->channel[i].histogramMax = hi[i];
+	}
+}
+
+// 8 bit formats count each code of each component then work everything out
+// from the 256 decoded values, exact and with no per value float work
+void Statistics8Bit(Image_View const &view,
+										uint32_t threadCount,
+										Image_StatisticsDesc const *desc,
+										uint32_t componentCount,
+										Image_Statistics *stats,
+										uint64_t *histogram) {
+	size_t const pixelCount = Image::PixelCountOf(view);
+	size_t const taskCount = (pixelCount + PixelsPerTask - 1) / PixelsPerTask;
+
+	Workers codes(threadCount, componentCount * 256);
+	Image::ParallelFor(threadCount, taskCount, [&](size_t taskIndex, uint32_t workerIndex) {
+		size_t const begin = taskIndex * PixelsPerTask;
+		size_t const count = (begin + PixelsPerTask < pixelCount) ? PixelsPerTask : pixelCount - begin;
+		uint64_t *counts = codes.histograms[workerIndex].data();
+		Image::ForEachRun(view, begin, count, [&](uint8_t const *src, size_t runCount) {
+			for (size_t p = 0; p < runCount; ++p) {
+				for (uint32_t c = 0; c < componentCount; ++c) {
+					counts[c * 256 + src[c]]++;
+				}
+				src += componentCount;
+			}
+		});
+	});
+	std::vector<uint64_t> counts(componentCount * 256, 0);
+	codes.SumInto(counts.data());
+
+	// decoded value of every code of every component
+	double values[4][256];
+	for (uint32_t code = 0; code < 256; ++code) {
+		uint8_t pixel[4];
+		memset(pixel, (int) code, sizeof(pixel));
+		TinyImageFormat_FetchInput input{pixel};
+		double decoded[4];
+		TinyImageFormat_DecodeLogicalPixelsD(view.format, &input, 1, decoded);
+		for (uint32_t c = 0; c < componentCount; ++c) {
+			int32_t const lc = ChannelOfComponent(view.format, c);
+			values[c][code] = lc >= 0 ? decoded[lc] : 0.0;
+		}
+	}
+
+	double scannedMin[4] = {0.0, 0.0, 0.0, 0.0};
+	double scannedMax[4] = {0.0, 0.0, 0.0, 0.0};
+	for (uint32_t c = 0; c < componentCount; ++c) {
+		int32_t const lc = ChannelOfComponent(view.format, c);
+		if (lc < 0) {
+			continue;
+		}
+		Image_ChannelStatistics &channel = stats->channel[lc];
+		uint64_t const *channelCounts = counts.data() + c * 256;
+		uint64_t n = 0;
+		double sum = 0.0;
+		double mn = std::numeric_limits<double>::infinity();
+		double mx = -std::numeric_limits<double>::infinity();
+		for (uint32_t code = 0; code < 256; ++code) {
+			if (channelCounts[code] == 0) {
+				continue;
+			}
+			double const v = values[c][code];
+			n += channelCounts[code];
+			sum += (double) channelCounts[code] * v;
+			if (v < mn) {
+				mn = v;
+			}
+			if (v > mx) {
+				mx = v;
+			}
+		}
+		double const mean = n ? sum / (double) n : 0.0;
+		double m2 = 0.0;
+		for (uint32_t code = 0; code < 256; ++code) {
+			double const d = values[c][code] - mean;
+			m2 += (double) channelCounts[code] * d * d;
+		}
+		channel.count = n;
+		channel.min = n ? mn : 0.0;
+		channel.max = n ? mx : 0.0;
+		channel.mean = mean;
+		channel.variance = n ? m2 / (double) n : 0.0;
+		scannedMin[lc] = channel.min;
+		scannedMax[lc] = channel.max;
+	}
+
+	double lo[4], hi[4];
+	RangeForBins(desc, scannedMin, scannedMax, lo, hi);
+	Bins const bins = MakeBins(stats->binCount, lo, hi);
+	StoreBins(lo, hi, stats);
+	for (uint32_t c = 0; c < componentCount; ++c) {
+		int32_t const lc = ChannelOfComponent(view.format, c);
+		if (lc < 0) {
+			continue;
+		}
+		for (uint32_t code = 0; code < 256; ++code) {
+			uint32_t const bin = BinOf(values[c][code], bins.lo[lc], bins.scale[lc], bins.count);
+			histogram[lc * bins.count + bin] += counts[c * 256 + code];
+		}
+	}
+}
+
+// float formats go straight from the stored values, halfs widened in batches
+template<typename T>
+void StatisticsStored(Image_View const &view,
+											uint32_t threadCount,
+											uint32_t componentCount,
+											Bins const &bins,
+											std::vector<Partial> &partials,
+											uint64_t *histogram) {
+	size_t const pixelCount = Image::PixelCountOf(view);
+	size_t const taskCount = (pixelCount + PixelsPerTask - 1) / PixelsPerTask;
+	int32_t channelOf[4];
+	for (uint32_t c = 0; c < componentCount; ++c) {
+		channelOf[c] = ChannelOfComponent(view.format, c);
+	}
+
+	partials.assign(taskCount, EmptyPartial());
+	Workers workers(threadCount, 4 * bins.count);
+	Image::ParallelFor(threadCount, taskCount, [&](size_t taskIndex, uint32_t workerIndex) {
+		size_t const begin = taskIndex * PixelsPerTask;
+		size_t const count = (begin + PixelsPerTask < pixelCount) ? PixelsPerTask : pixelCount - begin;
+		Image::ForEachRun(view, begin, count, [&](uint8_t const *src, size_t runCount) {
+			Accumulate((T const *) src, runCount, componentCount, channelOf, bins, partials[taskIndex],
+								 workers.histograms[workerIndex].data());
+		});
+	});
+	workers.SumInto(histogram);
+}
+
+void StatisticsHalf(Image_View const &view,
+										uint32_t threadCount,
+										uint32_t componentCount,
+										Bins const &bins,
+										std::vector<Partial> &partials,
+										uint64_t *histogram) {
+	size_t const pixelCount = Image::PixelCountOf(view);
+	size_t const taskCount = (pixelCount + PixelsPerTask - 1) / PixelsPerTask;
+	int32_t channelOf[4];
+	for (uint32_t c = 0; c < componentCount; ++c) {
+		channelOf[c] = ChannelOfComponent(view.format, c);
+	}
+
+	partials.assign(taskCount, EmptyPartial());
+	Workers workers(threadCount, 4 * bins.count);
+	Image::ParallelFor(threadCount, taskCount, [&](size_t taskIndex, uint32_t workerIndex) {
+		size_t const begin = taskIndex * PixelsPerTask;
+		size_t const count = (begin + PixelsPerTask < pixelCount) ? PixelsPerTask : pixelCount - begin;
+		float batch[HalfBatchCount];
+		size_t const batchPixels = HalfBatchCount / componentCount;
+		Image::ForEachRun(view, begin, count, [&](uint8_t const *run, size_t runCount) {
+			uint16_t const *src = (uint16_t const *) run;
+			while (runCount) {
+				size_t const n = runCount < batchPixels ? runCount : batchPixels;
+				Image::HalfToFloat(src, batch, n * componentCount);
+				Accumulate(batch, n, componentCount, channelOf, bins, partials[taskIndex], workers.histograms[workerIndex].data());
+				src += n * componentCount;
+				runCount -= n;
+			}
+		});
+	});
+	workers.SumInto(histogram);
+}
+
+// everything else decodes a row at a time, tasks are a fixed number of rows
+void StatisticsDecoded(Image_View const &view,
+											 uint32_t threadCount,
+											 Bins const &bins,
+											 std::vector<Partial> &partials,
+											 uint64_t *histogram) {
+	size_t const rowCount = Image::RowCountOf(view);
+	size_t const taskRows = view.width < PixelsPerTask ? PixelsPerTask / view.width : 1;
+	size_t const taskCount = (rowCount + taskRows - 1) / taskRows;
+	int32_t channelOf[4];
+	for (uint32_t i = 0; i < 4; ++i) {
+		TinyImageFormat_LogicalChannel const lc = (TinyImageFormat_LogicalChannel) i;
+		channelOf[i] = TinyImageFormat_LogicalChannelToPhysical(view.format, lc) >= 0 ? (int32_t) i : -1;
+	}
+
+	partials.assign(taskCount, EmptyPartial());
+	Workers workers(threadCount, 4 * bins.count);
+	Image::ParallelFor(threadCount, taskCount, [&](size_t taskIndex, uint32_t workerIndex) {
+		thread_local std::vector<double> row;
+		if (row.size() < (size_t) view.width * 4) {
+			row.resize((size_t) view.width * 4);
+		}
+		size_t const begin = taskIndex * taskRows;
+		size_t const end = (begin + taskRows < rowCount) ? begin + taskRows : rowCount;
+		for (size_t r = begin; r < end; ++r) {
+			TinyImageFormat_FetchInput input{Image::RowPtrOf(view, r)};
+			TinyImageFormat_DecodeLogicalPixelsD(view.format, &input, view.width, row.data());
+			Accumulate(row.data(), view.width, 4, channelOf, bins, partials[taskIndex], workers.histograms[workerIndex].data());
+		}
+	});
+	workers.SumInto(histogram);
+}
+
+} // end anon namespace
+
+AL2O3_EXTERN_C Image_Statistics const *Image_ComputeStatistics(Image_ImageHeader const *image,
+																															 Image_StatisticsDesc const *desc) {
+	ASSERT(image);
+	Image_View const view = Image::StorageViewOf(image);
+	return Image_ViewComputeStatistics(&view, desc);
+}
+
+AL2O3_EXTERN_C Image_Statistics const *Image_ViewComputeStatistics(Image_View const *view,
+																																	 Image_StatisticsDesc const *desc) {
+	ASSERT(view);
+	ASSERT(desc);
+	if (TinyImageFormat_PixelCountOfBlock(view->format) != 1 ||
+			!TinyImageFormat_CanDecodeLogicalPixelsD(view->format)) {
+		return nullptr;
+	}
+
+	uint32_t const binCount = desc->binCount ? desc->binCount : DefaultBinCount;
+	size_t const histogramBytes = sizeof(uint64_t) * 4 * binCount;
+	auto stats = (Image_Statistics *) MEMORY_MALLOC(sizeof(Image_Statistics) + histogramBytes);
+	if (!stats) {
+		return nullptr;
+	}
+	memset(stats, 0, sizeof(Image_Statistics) + histogramBytes);
+	stats->binCount = binCount;
+	uint64_t *histogram = (uint64_t *) (stats + 1);
+
+	// nothing to count, e.g. the empty view of a tiled image
+	if (Image::PixelCountOf(*view) == 0) {
+		return stats;
+	}
+
+	uint32_t const threadCount = Image::ResolveThreadCount(desc->threadCount);
+	Image::PlainLayout const layout = Image::PlainLayoutOf(view->format);
+	if (layout.plain && layout.bits == 8 && layout.componentCount <= 4) {
+		Statistics8Bit(*view, threadCount, desc, layout.componentCount, stats, histogram);
+		return stats;
+	}
+
+	double scannedMin[4] = {0.0, 0.0, 0.0, 0.0};
+	double scannedMax[4] = {0.0, 0.0, 0.0, 0.0};
+	if (!desc->useRange) {
+		Image::ColorRangeOf(*view, threadCount, scannedMin, scannedMax);
+	}
+	double lo[4], hi[4];
+	RangeForBins(desc, scannedMin, scannedMax, lo, hi);
+	Bins const bins = MakeBins(binCount, lo, hi);
+	StoreBins(lo, hi, stats);
+
+	std::vector<Partial> partials;
+	bool const isFloat = TinyImageFormat_IsFloat(view->format);
+	if (layout.plain && isFloat && layout.bits == 32) {
+		StatisticsStored<float>(*view, threadCount, layout.componentCount, bins, partials, histogram);
+	} else if (layout.plain && isFloat && layout.bits == 64) {
+		StatisticsStored<double>(*view, threadCount, layout.componentCount, bins, partials, histogram);
+	} else if (layout.plain && isFloat && layout.bits == 16) {
+		StatisticsHalf(*view, threadCount, layout.componentCount, bins, partials, histogram);
+	} else {
+		StatisticsDecoded(*view, threadCount, bins, partials, histogram);
+	}
+	Finish(partials, bins, stats);
+	return stats;
+}
+
+AL2O3_EXTERN_C void Image_DestroyStatistics(Image_Statistics const *stats) {
+	if (!stats) {
+		return;
+	}
+	MEMORY_FREE((Image_Statistics *) stats);
+}
+
+AL2O3_EXTERN_C uint64_t const *Image_StatisticsHistogramOf(Image_Statistics const *stats, uint32_t channel) {
+	ASSERT(stats);
+	ASSERT(channel < 4);
+	return ((uint64_t const *) (stats + 1)) + channel * stats->binCount;
+}
+
+AL2O3_EXTERN_C double Image_StatisticsPercentile(Image_Statistics const *stats, uint32_t channel, double percentile) {
+	ASSERT(stats);
+	ASSERT(channel < 4);
+	Image_ChannelStatistics const &channelStats = stats->channel[channel];
+	if (channelStats.count == 0) {
+		return 0.0;
+	}
+	if (percentile <= 0.0) {
+		return channelStats.min;
+	}
+	if (percentile >= 100.0) {
+		return channelStats.max;
+	}
+
+	uint64_t const *histogram = Image_StatisticsHistogramOf(stats, channel);
+	double const rank = percentile * 0.01 * (double) channelStats.count;
+	double const binWidth = (channelStats.histogramMax - channelStats.histogramMin) / stats->binCount;
+	double below = 0.0;
+	for (uint32_t i = 0; i < stats->binCount; ++i) {
+		double const inBin = (double) histogram[i];
+		if (inBin > 0.0 && below + inBin >= rank) {
+			return channelStats.histogramMin + binWidth * (i + (rank - below) / inBin);
+		}
+		below += inBin;
+	}
+	return channelStats.max;
+}
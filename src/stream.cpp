@@ -0,0 +1,317 @@
+#include "al2o3_platform/platform.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "tiny_imageformat/tinyimageformat_query.h"
+#include "tiny_imageformat/tinyimageformat_decode.h"
+#include "tiny_imageformat/tinyimageformat_encode.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image_impl_basic/normalize.h"
+#include "gfx_image_impl_basic/shared.h"
+#include "gfx_image_impl_basic/stream.h"
+#include "gfx_image_impl_basic/tiled.h"
+#include "copy.hpp"
+#include "mipmap.hpp"
+#include "parallel.hpp"
+#include "range.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+uint32_t const DefaultBandHeight = 64;
+
+uint32_t BandHeightOf(Image_StreamDesc const *desc, uint32_t height) {
+	uint32_t const bandHeight = desc->bandHeight ? desc->bandHeight : DefaultBandHeight;
+	return std::min(bandHeight, height);
+}
+
+// what the output rows must be for them to be normalised or box filtered,
+// one pixel per block that can be decoded and encoded again
+bool CanWorkOn(TinyImageFormat format) {
+	return TinyImageFormat_PixelCountOfBlock(format) == 1 &&
+			TinyImageFormat_CanDecodeLogicalPixelsD(format) &&
+			TinyImageFormat_CanEncodeLogicalPixelsD(format);
+}
+
+uint8_t *RowPtr(Image_ImageHeader const *image, uint32_t row) {
+	return ((uint8_t *) Image_RawDataPtr(image)) + row * Image_ByteCountPerRowOf(image);
+}
+
+// builds one mip level from the rows of the level above as they arrive.
+// pending holds the rows from pendingFirst that later rows of this level
+// still read, at most two bands worth plus the shared row odd sizes have
+struct LevelStage {
+	uint32_t srcHeight;
+	uint32_t height;
+	Image_ImageHeader const *pending;
+	uint32_t pendingFirst;
+	uint32_t pendingCount;
+	// the rows just filtered, before they go to the sink and next level
+	Image_ImageHeader const *band;
+	uint32_t nextRow;
+};
+
+struct StreamState {
+	Image_StreamSink const *sinks;
+	uint32_t threadCount;
+	// stages[i] builds output level i + 1
+	std::vector<LevelStage> stages;
+};
+
+bool Feed(StreamState &state, uint32_t stageIndex, Image_ImageHeader const *rows, uint32_t rowCount);
+
+// hands rowCount rows (from firstRow) of output level to its sink and to the
+// stage building the level below it
+bool Emit(StreamState &state, uint32_t level, Image_ImageHeader const *rows, uint32_t firstRow, uint32_t rowCount) {
+	Image_StreamSink const &sink = state.sinks[level];
+	if (sink.writeRows && !sink.writeRows(sink.user, firstRow, rowCount, Image_RawDataPtr(rows))) {
+		return false;
+	}
+	if (level < state.stages.size()) {
+		return Feed(state, level, rows, rowCount);
+	}
+	return true;
+}
+
+// filters every row of the level whose source rows have all arrived
+bool Produce(StreamState &state, uint32_t stageIndex) {
+	using namespace Image;
+	LevelStage &stage = state.stages[stageIndex];
+	size_t const rowSize = Image_ByteCountPerRowOf(stage.pending);
+	while (stage.nextRow < stage.height) {
+		uint32_t const available = stage.pendingFirst + stage.pendingCount;
+		uint32_t const limit = std::min(stage.height, stage.nextRow + stage.band->height);
+		uint32_t end = stage.nextRow;
+		while (end < limit && BoxLastSourceRow(stage.srcHeight, end) < available) {
+			++end;
+		}
+		if (end == stage.nextRow) {
+			break;
+		}
+
+		uint32_t const firstRow = stage.nextRow;
+		uint32_t const rowCount = end - firstRow;
+		BoxFilterBand(stage.pending, stage.srcHeight, stage.pendingFirst,
+									stage.band, stage.height, firstRow, rowCount, state.threadCount);
+		stage.nextRow = end;
+
+		// drop the source rows no later row reads
+		uint32_t const keepFrom = end < stage.height ? BoxFirstSourceRow(stage.srcHeight, end) : available;
+		uint32_t const dropCount = keepFrom - stage.pendingFirst;
+		memmove(RowPtr(stage.pending, 0), RowPtr(stage.pending, dropCount), (stage.pendingCount - dropCount) * rowSize);
+		stage.pendingFirst += dropCount;
+		stage.pendingCount -= dropCount;
+
+		if (!Emit(state, stageIndex + 1, stage.band, firstRow, rowCount)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Feed(StreamState &state, uint32_t stageIndex, Image_ImageHeader const *rows, uint32_t rowCount) {
+	LevelStage &stage = state.stages[stageIndex];
+	size_t const rowSize = Image_ByteCountPerRowOf(stage.pending);
+	uint32_t done = 0;
+	while (done < rowCount) {
+		// a full pending band always has rows ready so this always makes room
+		uint32_t const count = std::min(rowCount - done, stage.pending->height - stage.pendingCount);
+		memcpy(RowPtr(stage.pending, stage.pendingCount), RowPtr(rows, done), count * rowSize);
+		stage.pendingCount += count;
+		done += count;
+		if (!Produce(state, stageIndex)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// converts rowCount rows of src to dst spread over the threads
+void ConvertBand(Image::CopyPlan const &plan, Image_ImageHeader const *src, Image_ImageHeader const *dst,
+								 uint32_t rowCount, uint32_t threadCount) {
+	uint32_t const taskCount = std::min(threadCount, rowCount);
+	uint32_t const rowsPerTask = (rowCount + taskCount - 1) / taskCount;
+	Image::ParallelFor(threadCount, taskCount, [&](size_t task, uint32_t) {
+		uint32_t const rowBegin = (uint32_t) task * rowsPerTask;
+		uint32_t const rowEnd = std::min(rowBegin + rowsPerTask, rowCount);
+		if (rowBegin < rowEnd) {
+			Image::CopyRows(plan, src, rowBegin, 0, 0, dst, rowBegin, 0, 0, rowEnd - rowBegin);
+		}
+	});
+}
+
+bool ReadImageRows(void *user, uint32_t firstRow, uint32_t rowCount, void *dst) {
+	auto image = (Image_ImageHeader const *) user;
+	// rows of a tiled image are spread over its tiles
+	if (Image_IsTiled(image)) {
+		return false;
+	}
+	memcpy(dst, RowPtr(image, firstRow), rowCount * Image_ByteCountPerRowOf(image));
+	return true;
+}
+
+// sources of images with more than one page stack the pages as one tall
+// image, filtering that would blend rows across pages
+bool IsMultiPageImageSource(Image_StreamSource const &source) {
+	if (source.readRows != &ReadImageRows) {
+		return false;
+	}
+	auto image = (Image_ImageHeader const *) source.user;
+	return image->depth * image->slices > 1;
+}
+
+bool WriteImageRows(void *user, uint32_t firstRow, uint32_t rowCount, void const *src) {
+	auto image = (Image_ImageHeader const *) user;
+	// shared or mapped read only, Image_Unshare first
+	if (Image_IsReadOnly(image) || Image_IsTiled(image)) {
+		return false;
+	}
+	memcpy(RowPtr(image, firstRow), src, rowCount * Image_ByteCountPerRowOf(image));
+	return true;
+}
+
+} // end anon namespace
+
+AL2O3_EXTERN_C bool Image_StreamProcess(Image_StreamSource const *source,
+																				Image_StreamSink const *sinks,
+																				uint32_t sinkCount,
+																				Image_StreamDesc const *desc) {
+	using namespace Image;
+	ASSERT(source);
+	ASSERT(sinks);
+	ASSERT(sinkCount > 0);
+	ASSERT(desc);
+
+	TinyImageFormat const outputFormat =
+			desc->outputFormat != TinyImageFormat_UNDEFINED ? desc->outputFormat : source->format;
+	uint32_t const bandHeight = BandHeightOf(desc, source->height);
+
+	// refused up front rather than emitting rows that weren't processed
+	CopyPlan const plan = PlanCopy(source->format, outputFormat);
+	if ((outputFormat != source->format && plan.kind == CopyKind::Unsupported) ||
+			((desc->normalize || sinkCount > 1) && !CanWorkOn(outputFormat)) ||
+			(sinkCount > 1 && IsMultiPageImageSource(*source))) {
+		return false;
+	}
+
+	StreamState state;
+	state.sinks = sinks;
+	state.threadCount = ResolveThreadCount(desc->threadCount);
+
+	// each level is built from the one above, stopping at 1x1. The band images
+	// are reused, past the rows of a short last band they still hold rows of
+	// the band before. Those are converted and normalised again but never
+	// filtered or emitted
+	uint32_t width = source->width;
+	uint32_t height = source->height;
+	bool ok = true;
+	for (uint32_t level = 1; level < sinkCount && (width > 1 || height > 1); ++level) {
+		LevelStage stage;
+		stage.srcHeight = height;
+		stage.pending = Image_Create(width, std::min(bandHeight * 2 + 2, height), 1, 1, outputFormat);
+		width = HalveDimension(width);
+		height = HalveDimension(height);
+		stage.height = height;
+		stage.pendingFirst = 0;
+		stage.pendingCount = 0;
+		stage.band = Image_Create(width, std::min(bandHeight, height), 1, 1, outputFormat);
+		stage.nextRow = 0;
+		state.stages.push_back(stage);
+		ok = ok && stage.pending && stage.band;
+	}
+
+	Image_ImageHeader const *input = Image_Create(source->width, bandHeight, 1, 1, source->format);
+	Image_ImageHeader const *output = input;
+	if (outputFormat != source->format) {
+		output = Image_Create(source->width, bandHeight, 1, 1, outputFormat);
+	}
+	ok = ok && input && output;
+
+	Image_NormalizeDesc const normalizeDesc = {state.threadCount, true, desc->rangeMin, desc->rangeMax};
+	for (uint32_t row = 0; ok && row < source->height; row += bandHeight) {
+		uint32_t const rowCount = std::min(bandHeight, source->height - row);
+		ok = source->readRows(source->user, row, rowCount, Image_RawDataPtr(input));
+		if (!ok) {
+			break;
+		}
+		if (output != input) {
+			ConvertBand(plan, input, output, rowCount, state.threadCount);
+		}
+		if (desc->normalize && !Image_NormalizeEachChannelEx(output, &normalizeDesc)) {
+			ok = false;
+			break;
+		}
+		ok = Emit(state, 0, output, row, rowCount);
+	}
+
+	if (output != input) {
+		Image_Destroy(output);
+	}
+	Image_Destroy(input);
+	for (LevelStage const &stage : state.stages) {
+		Image_Destroy(stage.band);
+		Image_Destroy(stage.pending);
+	}
+	return ok;
+}
+
+AL2O3_EXTERN_C bool Image_StreamColorRange(Image_StreamSource const *source,
+																					 Image_StreamDesc const *desc,
+																					 Image_PixelD *omin,
+																					 Image_PixelD *omax) {
+	ASSERT(source);
+	ASSERT(desc);
+	ASSERT(omin);
+	ASSERT(omax);
+
+	uint32_t const bandHeight = BandHeightOf(desc, source->height);
+	uint32_t const threadCount = Image::ResolveThreadCount(desc->threadCount);
+	uint32_t const channelCount = TinyImageFormat_ChannelCount(source->format);
+	// the first band is always full, after that any rows past the end of a
+	// short band are a repeat of earlier ones so don't change the range
+	Image_ImageHeader const *band = Image_Create(source->width, bandHeight, 1, 1, source->format);
+	if (!band) {
+		return false;
+	}
+
+	bool ok = true;
+	double *dmin = &omin->r;
+	double *dmax = &omax->r;
+	for (uint32_t row = 0; row < source->height; row += bandHeight) {
+		uint32_t const rowCount = std::min(bandHeight, source->height - row);
+		ok = source->readRows(source->user, row, rowCount, Image_RawDataPtr(band));
+		if (!ok) {
+			break;
+		}
+		Image_PixelD bandMin;
+		Image_PixelD bandMax;
+		Image::ColorRangeOf(band, threadCount, &bandMin.r, &bandMax.r);
+		double const *bmin = &bandMin.r;
+		double const *bmax = &bandMax.r;
+		// like Image_GetColorRangeOf channels the format doesn't have are untouched
+		for (uint32_t c = 0; c < channelCount; ++c) {
+			dmin[c] = row == 0 ? bmin[c] : std::min(dmin[c], bmin[c]);
+			dmax[c] = row == 0 ? bmax[c] : std::max(dmax[c], bmax[c]);
+		}
+	}
+
+	Image_Destroy(band);
+	return ok;
+}
+
+AL2O3_EXTERN_C Image_StreamSource Image_StreamSourceOfImage(Image_ImageHeader const *image) {
+	Image_StreamSource source;
+	source.width = image->width;
+	source.height = image->height * image->depth * image->slices;
+	source.format = image->format;
+	source.readRows = &ReadImageRows;
+	source.user = (void *) image;
+	return source;
+}
+
+AL2O3_EXTERN_C Image_StreamSink Image_StreamSinkOfImage(Image_ImageHeader const *image) {
+	Image_StreamSink sink;
+	sink.writeRows = &WriteImageRows;
+	sink.user = (void *) image;
+	return sink;
+}
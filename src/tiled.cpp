@@ -0,0 +1,153 @@
+#include "al2o3_platform/platform.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "tiny_imageformat/tinyimageformat_query.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image/utils.h"
+#include "gfx_image_impl_basic/shared.h"
+#include "gfx_image_impl_basic/tiled.h"
+#include "levels.hpp"
+#include "tiled.hpp"
+
+namespace {
+
+template<size_t Size>
+struct PixelBytes {
+	uint8_t bytes[Size];
+};
+
+// a tile row at a time, the 8 pixels of a tile row are spread over the tile
+// by the MortonX table so the inner loop is a table lookup and a copy
+template<typename T>
+void SwizzlePageOf(T const *src, T *dst, uint32_t width, uint32_t height, bool toTiled) {
+	using namespace Image;
+	uint32_t const tilesPerRow = width / Image_TileSize;
+	for (uint32_t y = 0; y < height; ++y) {
+		T const *linearSrc = src + (size_t) y * width;
+		T *linearDst = dst + (size_t) y * width;
+		size_t const rowBase = (size_t) (y / Image_TileSize) * tilesPerRow * TilePixelCount + MortonY[y % Image_TileSize];
+		for (uint32_t tx = 0; tx < tilesPerRow; ++tx) {
+			size_t const tileBase = rowBase + (size_t) tx * TilePixelCount;
+			uint32_t const xBase = tx * Image_TileSize;
+			if (toTiled) {
+				for (uint32_t x = 0; x < Image_TileSize; ++x) {
+					dst[tileBase + MortonX[x]] = linearSrc[xBase + x];
+				}
+			} else {
+				for (uint32_t x = 0; x < Image_TileSize; ++x) {
+					linearDst[xBase + x] = src[tileBase + MortonX[x]];
+				}
+			}
+		}
+	}
+}
+
+// any other pixel size
+void SwizzlePageBytes(uint8_t const *src, uint8_t *dst, uint32_t width, uint32_t height, size_t pixelSize, bool toTiled) {
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			size_t const linear = ((size_t) y * width + x) * pixelSize;
+			size_t const tiled = Image::TiledPixelIndex(width, x, y) * pixelSize;
+			if (toTiled) {
+				memcpy(dst + tiled, src + linear, pixelSize);
+			} else {
+				memcpy(dst + linear, src + tiled, pixelSize);
+			}
+		}
+	}
+}
+
+Image_ImageHeader const *CloneInLayout(Image_ImageHeader const *image, bool tiled) {
+	auto dst = (Image_ImageHeader *) Image_CreateNoClear(image->width, image->height, image->depth, image->slices, image->format);
+	if (dst == nullptr) {
+		return nullptr;
+	}
+	if (tiled && Image_CanBeTiled(dst)) {
+		dst->flags |= Image_Flag_Tiled;
+	}
+	if (!Image_TryCopyImage(image, dst)) {
+		Image_Destroy(dst);
+		return nullptr;
+	}
+	if (image->nextType != Image_NT_None) {
+		dst->nextImage = CloneInLayout(image->nextImage, tiled);
+		if (dst->nextImage == nullptr) {
+			Image_Destroy(dst);
+			return nullptr;
+		}
+		dst->nextType = image->nextType;
+	}
+	return dst;
+}
+
+} // end anon namespace
+
+void Image::SwizzlePage(void const *src, void *dst, uint32_t width, uint32_t height, size_t pixelSize, bool toTiled) {
+	ASSERT(src != dst);
+	ASSERT(width % Image_TileSize == 0 && height % Image_TileSize == 0);
+	switch (pixelSize) {
+	case 1: SwizzlePageOf((uint8_t const *) src, (uint8_t *) dst, width, height, toTiled);
+		break;
+	case 2: SwizzlePageOf((uint16_t const *) src, (uint16_t *) dst, width, height, toTiled);
+		break;
+	case 3: SwizzlePageOf((PixelBytes<3> const *) src, (PixelBytes<3> *) dst, width, height, toTiled);
+		break;
+	case 4: SwizzlePageOf((uint32_t const *) src, (uint32_t *) dst, width, height, toTiled);
+		break;
+	case 6: SwizzlePageOf((PixelBytes<6> const *) src, (PixelBytes<6> *) dst, width, height, toTiled);
+		break;
+	case 8: SwizzlePageOf((uint64_t const *) src, (uint64_t *) dst, width, height, toTiled);
+		break;
+	case 12: SwizzlePageOf((PixelBytes<12> const *) src, (PixelBytes<12> *) dst, width, height, toTiled);
+		break;
+	case 16: SwizzlePageOf((PixelBytes<16> const *) src, (PixelBytes<16> *) dst, width, height, toTiled);
+		break;
+	default: SwizzlePageBytes((uint8_t const *) src, (uint8_t *) dst, width, height, pixelSize, toTiled);
+		break;
+	}
+}
+
+AL2O3_EXTERN_C bool Image_IsTiled(Image_ImageHeader const *image) {
+	ASSERT(image);
+	return (image->flags & Image_Flag_Tiled) != 0;
+}
+
+AL2O3_EXTERN_C bool Image_CanBeTiled(Image_ImageHeader const *image) {
+	ASSERT(image);
+	TinyImageFormat const fmt = image->format;
+	return image->depth == 1 &&
+			image->width % Image_TileSize == 0 &&
+			image->height % Image_TileSize == 0 &&
+			!Image_HasPackedMipMaps(image) &&
+			!TinyImageFormat_IsCompressed(fmt) &&
+			!TinyImageFormat_IsCLUT(fmt) &&
+			TinyImageFormat_PixelCountOfBlock(fmt) == 1 &&
+			TinyImageFormat_BitSizeOfBlock(fmt) % 8 == 0;
+}
+
+AL2O3_EXTERN_C size_t Image_CalculateLayoutIndex(Image_ImageHeader const *image,
+																								 uint32_t x, uint32_t y, uint32_t z, uint32_t w) {
+	if (!Image_IsTiled(image)) {
+		return Image_CalculateIndex(image, x, y, z, w);
+	}
+	ASSERT(x < image->width && y < image->height && z == 0 && w < image->slices);
+	return (size_t) w * image->width * image->height + Image::TiledPixelIndex(image->width, x, y);
+}
+
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CloneTiled(Image_ImageHeader const *image) {
+	ASSERT(image);
+	Image_ImageHeader const *dst = CloneInLayout(image, true);
+	if (dst) {
+		Image::RecordLevelDirectory(dst);
+	}
+	return dst;
+}
+
+AL2O3_EXTERN_C Image_ImageHeader const *Image_CloneLinear(Image_ImageHeader const *image) {
+	ASSERT(image);
+	Image_ImageHeader const *dst = CloneInLayout(image, false);
+	if (dst) {
+		Image::RecordLevelDirectory(dst);
+	}
+	return dst;
+}
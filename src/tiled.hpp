@@ -0,0 +1,39 @@
+// Pixel order of tiled images, shared by the swizzle, copy and mip map code.
+// Within a tile bit i of x lands in bit 2i of the Morton index and bit i of y
+// in bit 2i + 1
+#ifndef WYRD_IMAGE_TILED_HPP
+#define WYRD_IMAGE_TILED_HPP
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image_impl_basic/tiled.h"
+
+namespace Image {
+
+uint32_t const TilePixelCount = Image_TileSize * Image_TileSize;
+
+// the Morton index bits of the tile relative x and y coordinates
+uint8_t const MortonX[Image_TileSize] = {0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15};
+uint8_t const MortonY[Image_TileSize] = {0x00, 0x02, 0x08, 0x0a, 0x20, 0x22, 0x28, 0x2a};
+
+// pixel index of (x, y) within a tiled page width pixels wide
+inline size_t TiledPixelIndex(uint32_t width, uint32_t x, uint32_t y) {
+	size_t const tile = (size_t) (y / Image_TileSize) * (width / Image_TileSize) + x / Image_TileSize;
+	return tile * TilePixelCount + MortonY[y % Image_TileSize] + MortonX[x % Image_TileSize];
+}
+
+// reorders one width x height page of pixelSize byte pixels from linear to
+// tiled order (or back), src and dst must not overlap
+void SwizzlePage(void const *src, void *dst, uint32_t width, uint32_t height, size_t pixelSize, bool toTiled);
+
+// the tiled flag for to if from is tiled and to can be, for clones and
+// conversions that keep the layout of their source
+inline void InheritLayout(Image_ImageHeader const *from, Image_ImageHeader *to) {
+	if (Image_IsTiled(from) && Image_CanBeTiled(to)) {
+		to->flags |= Image_Flag_Tiled;
+	}
+}
+
+} // end namespace Image
+
+#endif //WYRD_IMAGE_TILED_HPP
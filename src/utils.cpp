@@ -5,41 +5,140 @@
 #include "tiny_imageformat/tinyimageformat_decode.h"
 #include "tiny_imageformat/tinyimageformat_encode.h"
 #include "gfx_image/image.h"
-#include "hq_resample.hpp"
+#include "gfx_image_impl_basic/range.h"
+#include "gfx_image_impl_basic/shared.h"
+#include "gfx_image_impl_basic/tiled.h"
+#include "allocator.hpp"
+#include "copy.hpp"
+#include "levels.hpp"
+#include "range.hpp"
+#include "tiled.hpp"
+
+namespace {
+
+uint8_t *PagePtr(Image_ImageHeader const *image, uint32_t page) {
+	size_t const pixelSize = TinyImageFormat_BitSizeOfBlock(image->format) / 8;
+	return ((uint8_t *) Image_RawDataPtr(image)) +
+			Image_CalculateIndex(image, 0, 0, page % image->depth, page / image->depth) * pixelSize;
+}
+
+// CopyPages for images of either layout. When only one is tiled each page is
+// swizzled, via a page in the source format and destination layout if the
+// formats differ as well. False, with dst untouched, if that page can't be
+// made
+bool CopyPagesAnyLayout(Image_ImageHeader const *src, uint32_t sz, uint32_t sw,
+												Image_ImageHeader const *dst, uint32_t dz, uint32_t dw,
+												uint32_t pageCount) {
+	Image::CopyPlan const plan = Image::PlanCopy(src->format, dst->format);
+	bool const toTiled = Image_IsTiled(dst);
+	if (Image_IsTiled(src) == toTiled) {
+		Image::CopyPages(plan, src, sz, sw, dst, dz, dw, pageCount);
+		return true;
+	}
+
+	Image_ImageHeader *page = nullptr;
+	if (src->format != dst->format) {
+		page = (Image_ImageHeader *) Image_CreateNoClear(src->width, src->height, 1, 1, src->format);
+		if (!page) {
+			LOGERROR("Image copy couldn't make a %ux%u page to swizzle through, nothing copied", src->width, src->height);
+			return false;
+		}
+		page->flags |= dst->flags & Image_Flag_Tiled;
+	}
+	size_t const pixelSize = TinyImageFormat_BitSizeOfBlock(src->format) / 8;
+	uint32_t const srcFirst = sw * src->depth + sz;
+	uint32_t const dstFirst = dw * dst->depth + dz;
+	for (uint32_t i = 0; i < pageCount; ++i) {
+		uint32_t const dstPage = dstFirst + i;
+		if (page) {
+			Image::SwizzlePage(PagePtr(src, srcFirst + i), Image_RawDataPtr(page),
+												 src->width, src->height, pixelSize, toTiled);
+			Image::CopyPages(plan, page, 0, 0, dst, dstPage % dst->depth, dstPage / dst->depth, 1);
+		} else {
+			Image::SwizzlePage(PagePtr(src, srcFirst + i), PagePtr(dst, dstPage),
+												 src->width, src->height, pixelSize, toTiled);
+		}
+	}
+	if (page) {
+		Image_Destroy(page);
+	}
+	return true;
+}
+
+// the links of Image_Clone, Image_CloneStructure and Image_PreciseConvert,
+// the directory of the whole chain is recorded once it is linked
+Image_ImageHeader const *CloneChain(Image_ImageHeader const *image) {
+	auto
+			dst = (Image_ImageHeader *) Image_CreateNoClear(image->width, image->height, image->depth, image->slices, image->format);
+	if (dst == nullptr) {
+		return nullptr;
+	}
+	Image::InheritLayout(image, dst);
+	if (!Image_TryCopyImage(image, dst)) {
+		Image_Destroy(dst);
+		return nullptr;
+	}
+	if (image->nextType != Image_NT_None) {
+		dst->nextImage = CloneChain(image->nextImage);
+		if (dst->nextImage == nullptr) {
+			Image_Destroy(dst);
+			return nullptr;
+		}
+		dst->nextType = image->nextType;
+	}
+	return dst;
+}
+
+Image_ImageHeader const *CloneStructureChain(Image_ImageHeader const *image) {
+	auto
+			dst = (Image_ImageHeader *) Image_Create(image->width, image->height, image->depth, image->slices, image->format);
+	if (dst == nullptr) {
+		return nullptr;
+	}
+	Image::InheritLayout(image, dst);
+	if (image->nextType != Image_NT_None) {
+		dst->nextImage = CloneStructureChain(image->nextImage);
+		dst->nextType = image->nextType;
+	}
+	return dst;
+}
+
+Image_ImageHeader const *PreciseConvertChain(Image_ImageHeader const *image, TinyImageFormat const newFormat) {
+	auto dst = (Image_ImageHeader *) Image_CreateNoClear(image->width, image->height, image->depth, image->slices, newFormat);
+	if (dst == nullptr) {
+		return nullptr;
+	}
+	Image::InheritLayout(image, dst);
+	if (!Image_TryCopyImage(image, dst)) {
+		Image_Destroy(dst);
+		return nullptr;
+	}
+	if (image->nextType != Image_NT_None) {
+		dst->nextImage = PreciseConvertChain(image->nextImage, newFormat);
+		if (dst->nextImage == nullptr) {
+			Image_Destroy(dst);
+			return nullptr;
+		}
+		dst->nextType = image->nextType;
+	}
+	return dst;
+}
+
+} // end anon namespace
 
 AL2O3_EXTERN_C bool Image_GetColorRangeOf(Image_ImageHeader const *src, Image_PixelD *omin, Image_PixelD *omax) {
+	return Image_GetColorRangeOfEx(src, 1, omin, omax);
+}
+
+AL2O3_EXTERN_C bool Image_GetColorRangeOfEx(Image_ImageHeader const *src,
+																						uint32_t threadCount,
+																						Image_PixelD *omin,
+																						Image_PixelD *omax) {
 	ASSERT(src);
 	ASSERT(omin);
 	ASSERT(omax);
 
-	double *minData = &omin->r;
-	double *maxData = &omax->r;
-	for (uint32_t i = 0u; i < TinyImageFormat_ChannelCount(src->format); ++i) {
-		minData[i] = TinyImageFormat_Max(src->format, (TinyImageFormat_LogicalChannel)i);
-		maxData[i] = TinyImageFormat_Min(src->format, (TinyImageFormat_LogicalChannel)i);
-	};
-
-	for (auto w = 0u; w < src->slices; ++w) {
-		for (auto z = 0u; z < src->depth; ++z) {
-			for (auto y = 0u; y < src->height; ++y) {
-				for (auto x = 0u; x < src->width; ++x) {
-					size_t const index = Image_CalculateIndex(src, x, y, z, w);
-					double data[4];
-					Image_GetPixelAtD(src, data, index);
-
-					for (uint32_t i = 0u; i < TinyImageFormat_ChannelCount(src->format); ++i) {
-						if (data[i] < minData[i]) {
-							minData[i] = data[i];
-						}
-						if (data[i] > maxData[i]) {
-							maxData[i] = data[i];
-						}
-					}
-				}
-			}
-		}
-	}
-
+	Image::ColorRangeOf(src, threadCount, &omin->r, &omax->r);
 	return true;
 }
 
@@ -61,7 +160,7 @@ AL2O3_EXTERN_C bool Image_GetColorRangeOfD(Image_ImageHeader const *src, double
 				dmin[0] = dmin[i];
 			}
 			if (dmax[i] > dmax[0]) {
-				dmax[i] = dmax[i];
+				dmax[0] = dmax[i];
 			}
 		}
 
@@ -84,171 +183,43 @@ AL2O3_EXTERN_C bool Image_GetColorRangeOfF(Image_ImageHeader const *src, float *
 	return false;
 }
 
-AL2O3_EXTERN_C bool Image_NormalizeEachChannel(Image_ImageHeader const *src) {
-	Image_PixelD pmin, pmax;
-	if (!Image_GetColorRangeOf(src, &pmin, &pmax)) {
-		return false;
-	}
-
-	Image_PixelD const s{
-			1.0 / (pmax.r - pmin.r),
-			1.0 / (pmax.g - pmin.g),
-			1.0 / (pmax.b - pmin.b),
-			1.0 / (pmax.a - pmin.a),
-	};
-
-	Image_PixelD const b{
-			-pmin.r * s.r,
-			-pmin.g * s.g,
-			-pmin.b * s.b,
-			-pmin.a * s.a,
-	};
-
-	for (auto w = 0u; w < src->slices; ++w) {
-		for (auto z = 0u; z < src->depth; ++z) {
-			for (auto y = 0u; y < src->height; ++y) {
-				for (auto x = 0u; x < src->width; ++x) {
-					size_t const index = Image_CalculateIndex(src, x, y, z, w);
-					Image_PixelD pixel;
-					Image_GetPixelAtD(src, (double*)&pixel, index);
-					pixel.r = pixel.r * s.r + b.r;
-					pixel.g = pixel.g * s.g + b.g;
-					pixel.b = pixel.b * s.b + b.b;
-					pixel.a = pixel.a * s.a + b.a;
-					Image_SetPixelAtD(src, (double const*)&pixel, index);
-				}
-			}
-		}
-	}
-	return true;
-}
-
-AL2O3_EXTERN_C bool Image_NormalizeAcrossChannels(Image_ImageHeader const *src) {
-	double dmin, dmax;
-	if (!Image_GetColorRangeOfD(src, &dmin, &dmax)) {
+AL2O3_EXTERN_C bool Image_TryCopyImageChain(Image_ImageHeader const *src, Image_ImageHeader const *dst) {
+	if (!Image_TryCopyImage(src, dst)) {
 		return false;
 	}
-
-	double const s = 1.0 / (dmax - dmin);
-	double const b = -dmin * s;
-
-	for (auto w = 0u; w < src->slices; ++w) {
-		for (auto z = 0u; z < src->depth; ++z) {
-			for (auto y = 0u; y < src->height; ++y) {
-				for (auto x = 0u; x < src->width; ++x) {
-					size_t const index = Image_CalculateIndex(src, x, y, z, w);
-					Image_PixelD pixel;
-					Image_GetPixelAtD(src, (double*)&pixel, index);
-					pixel.r = pixel.r * s + b;
-					pixel.g = pixel.g * s + b;
-					pixel.b = pixel.b * s + b;
-					pixel.a = pixel.a * s + b;
-					Image_SetPixelAtD(src, (double const*)&pixel, index);
-				}
-			}
-		}
-	}
-	return true;
-}
-// TODO optimise or have option for faster mipmap chain generation
-AL2O3_EXTERN_C void Image_CreateMipMapChain(Image_ImageHeader const *image, bool generateFromImage) {
-	// start from the image provided and create successive mip images
-	ASSERT(image->nextType == Image_NT_None);
-	ASSERT(Math_IsPowerOf2U32(image->width));
-	ASSERT(Math_IsPowerOf2U32(image->height));
-
-	// need to think about mip mapped volume textures...
-	ASSERT(image->depth == 1);
-
-	using namespace Image;
-
-	Image_ImageHeader *curImage = (Image_ImageHeader *) image;
-	uint32_t curWidth = image->width;
-	uint32_t curHeight = image->height;
-	if (curWidth <= 1 || curHeight <= 1) {
-		return;
-	}
-
-	Image_ImageHeader const *scratchImage = nullptr;
-
-	uint32_t const numChans = TinyImageFormat_ChannelCount(image->format);
-	if (generateFromImage) {
-		TinyImageFormat dblFmt = TinyImageFormat_R32G32B32A32_SFLOAT;
-		switch (numChans) {
-		case 1:dblFmt = TinyImageFormat_R32_SFLOAT;
-			break;
-		case 2:dblFmt = TinyImageFormat_R32G32_SFLOAT;
-			break;
-		case 3:dblFmt = TinyImageFormat_R32G32B32_SFLOAT;
-			break;
-		case 4:dblFmt = TinyImageFormat_R32G32B32A32_SFLOAT;
-			break;
-		default:
-		case 0: {
-			ASSERT(false);
-		}
-		}
-		scratchImage = Image_Create(image->width / 2, image->height / 2, 1, 1, dblFmt);
-	}
-
-	do {
-		curWidth = curWidth / 2;
-		curHeight = curHeight / 2;
-
-		auto newImage = Image_Create(curWidth, curHeight, 1, image->slices, image->format);
-
-		if (generateFromImage) {
-			float *const scratch = (float *const) Image_RawDataPtr(scratchImage);
-
-			for (auto w = 0u; w < image->slices; ++w) {
-				float const *origSlice = (float const *)
-						(((uint8_t *) Image_RawDataPtr(image)) + w * Image_ByteCountPerSliceOf(image));
-
-				hq_resample<float>(numChans,
-													 origSlice, image->width, image->height,
-													 scratch, curWidth, curHeight);
-
-				Image_CopySlice(scratchImage, w, newImage, 0);
-			}
-		}
-
-		curImage->nextImage = (Image_ImageHeader *) newImage;
-		curImage->nextType = Image_NT_MipMap;
-		curImage = (Image_ImageHeader *) curImage->nextImage;
-	} while (curWidth > 1 || curHeight > 1);
-
-	if (scratchImage) {
-		Image_Destroy(scratchImage);
-	}
-}
-
-AL2O3_EXTERN_C void Image_CopyImageChain(Image_ImageHeader const *src, Image_ImageHeader const *dst) {
-	Image_CopyImage(src, dst);
 	if (src->nextType == dst->nextType && src->nextImage && dst->nextImage) {
-		Image_CopyImageChain(src->nextImage, dst->nextImage);
+		return Image_TryCopyImageChain(src->nextImage, dst->nextImage);
 	}
+	return true;
 }
 
-AL2O3_EXTERN_C void Image_CopyImage(Image_ImageHeader const *src, Image_ImageHeader const *dst) {
+AL2O3_EXTERN_C bool Image_TryCopyImage(Image_ImageHeader const *src, Image_ImageHeader const *dst) {
 	if (src == dst) {
-		return;
+		return true;
 	}
 
+	// shared or mapped read only, Image_Unshare first
+	if (Image_IsReadOnly(dst)) {
+		return false;
+	}
 	ASSERT(dst->slices == src->slices);
 	ASSERT(dst->depth == src->depth);
 	ASSERT(dst->height == src->height);
 	ASSERT(dst->width == src->width);
 
-	for (auto w = 0u; w < src->slices; ++w) {
-		Image_CopySlice(src, w, dst, w);
-	}
+	// every page of both images is contiguous so this is one memcpy or kernel
+	// call when the formats and layouts allow it
+	return CopyPagesAnyLayout(src, 0, 0, dst, 0, 0, src->depth * src->slices);
 }
 
-AL2O3_EXTERN_C void Image_CopySlice(
+AL2O3_EXTERN_C bool Image_TryCopySlice(
 		Image_ImageHeader const *src,
 		uint32_t sw,
 		Image_ImageHeader const *dst,
 		uint32_t dw) {
+	if (Image_IsReadOnly(dst)) {
+		return false;
+	}
 	ASSERT(dst->depth == src->depth);
 	ASSERT(dst->height == src->height);
 	ASSERT(dst->width == src->width);
@@ -256,119 +227,132 @@ AL2O3_EXTERN_C void Image_CopySlice(
 		ASSERT(dw != sw);
 	}
 
-	for (auto z = 0u; z < src->depth; ++z) {
-		Image_CopyPage(src, z, sw, dst, z, dw);
-	}
+	return CopyPagesAnyLayout(src, 0, sw, dst, 0, dw, src->depth);
 }
 
-AL2O3_EXTERN_C void Image_CopyPage(
+AL2O3_EXTERN_C bool Image_TryCopyPage(
 		Image_ImageHeader const *src,
 		uint32_t sz, uint32_t sw,
 		Image_ImageHeader const *dst,
 		uint32_t dz, uint32_t dw) {
+	if (Image_IsReadOnly(dst)) {
+		return false;
+	}
 	ASSERT(dst->height == src->height);
 	ASSERT(dst->width == src->width);
 	if (dst == src) {
 		ASSERT(dz != sz || dw != sw);
 	}
 
-	uint32_t const heightOfBlock = TinyImageFormat_HeightOfBlock(src->format);
-	for (auto y = 0u; y < src->height / heightOfBlock; ++y) {
-		Image_CopyRow(src, y, sz, sw, dst, y, dz, dw);
-	}
+	return CopyPagesAnyLayout(src, sz, sw, dst, dz, dw, 1);
 }
 
-AL2O3_EXTERN_C void Image_CopyRow(Image_ImageHeader const *src,
-																	uint32_t sy, uint32_t sz, uint32_t sw,
-																	Image_ImageHeader const *dst,
-																	uint32_t dy, uint32_t dz, uint32_t dw) {
+AL2O3_EXTERN_C bool Image_TryCopyRow(Image_ImageHeader const *src,
+																		 uint32_t sy, uint32_t sz, uint32_t sw,
+																		 Image_ImageHeader const *dst,
+																		 uint32_t dy, uint32_t dz, uint32_t dw) {
+	if (Image_IsReadOnly(dst)) {
+		return false;
+	}
 	ASSERT(dst->width == src->width);
 	if (dst == src) {
 		ASSERT(dy != sy || dz != sz || dw != sw);
 	}
 
-	// can we do it via the faster float path (more common case)
-	if (TinyImageFormat_CanDecodeLogicalPixelsF(src->format) &&
-			TinyImageFormat_CanEncodeLogicalPixelsF(dst->format)) {
-		uint32_t const widthOfBlock = TinyImageFormat_WidthOfBlock(src->format);
-		uint32_t const pixelCountOfBlock = TinyImageFormat_PixelCountOfBlock(src->format);
-		uint64_t const rowBufferSize = (src->width / widthOfBlock) * pixelCountOfBlock * sizeof(float) * 4;
-
-		auto rowBuffer = (float *) STACK_ALLOC(rowBufferSize);
-
-		size_t const srcIndex = Image_CalculateIndex(src, 0, sy, sz, sw);
-		size_t const dstIndex = Image_CalculateIndex(dst, 0, dy, dz, dw);
-		Image_GetRowAtF(src, rowBuffer, srcIndex);
-		Image_SetRowAtF(dst, rowBuffer, dstIndex);
-
-	} else if (TinyImageFormat_CanDecodeLogicalPixelsD(src->format) &&
-				TinyImageFormat_CanEncodeLogicalPixelsD(dst->format)) {
-		// this is if we require the double path
-		uint32_t const widthOfBlock = TinyImageFormat_WidthOfBlock(src->format);
-		uint32_t const pixelCountOfBlock = TinyImageFormat_PixelCountOfBlock(src->format);
-		uint64_t const rowBufferSize = (src->width / widthOfBlock) * pixelCountOfBlock * sizeof(double) * 4;
-
-		auto rowBuffer = (double *) STACK_ALLOC(rowBufferSize);
-
-		size_t const srcIndex = Image_CalculateIndex(src, 0, sy, sz, sw);
-		size_t const dstIndex = Image_CalculateIndex(dst, 0, dy, dz, dw);
-		Image_GetRowAtD(src, rowBuffer, srcIndex);
-		Image_SetRowAtD(dst, rowBuffer, dstIndex);
-	} else {
-		// TODO better error
-		// we can't decode and/or encode between these formats so die
-		ASSERT(false);
+	// a row of a tiled image is spread over a row of tiles
+	if (Image_IsTiled(src) || Image_IsTiled(dst)) {
+		for (uint32_t x = 0; x < src->width; ++x) {
+			Image_TryCopyPixel(src, x, sy, sz, sw, dst, x, dy, dz, dw);
+		}
+		return true;
 	}
+
+	Image::CopyPlan const plan = Image::PlanCopy(src->format, dst->format);
+	Image::CopyRows(plan, src, sy, sz, sw, dst, dy, dz, dw, 1);
+	return true;
+}
+
+AL2O3_EXTERN_C bool Image_TryCopyPixel(Image_ImageHeader const *src,
+																			 uint32_t sx, uint32_t sy, uint32_t sz, uint32_t sw,
+																			 Image_ImageHeader const *dst,
+																			 uint32_t dx, uint32_t dy, uint32_t dz, uint32_t dw) {
+	if (Image_IsReadOnly(dst)) {
+		return false;
+	}
+	size_t const srcIndex = Image_CalculateLayoutIndex(src, sx, sy, sz, sw);
+	size_t const dstIndex = Image_CalculateLayoutIndex(dst, dx, dy, dz, dw);
+	Image_PixelD pixel;
+	Image_GetPixelAtD(src, (double*)&pixel, srcIndex);
+	return Image_SetPixelAtD(dst, (double*)&pixel, dstIndex);
+}
+
+// the plain copies have nowhere to report a refusal, a read only destination is
+// a bug in the caller
+AL2O3_EXTERN_C void Image_CopyImageChain(Image_ImageHeader const *src, Image_ImageHeader const *dst) {
+	ASSERT(!Image_IsReadOnly(dst));
+	Image_TryCopyImageChain(src, dst);
+}
+
+AL2O3_EXTERN_C void Image_CopyImage(Image_ImageHeader const *src, Image_ImageHeader const *dst) {
+	ASSERT(src == dst || !Image_IsReadOnly(dst));
+	Image_TryCopyImage(src, dst);
+}
+
+AL2O3_EXTERN_C void Image_CopySlice(
+		Image_ImageHeader const *src,
+		uint32_t sw,
+		Image_ImageHeader const *dst,
+		uint32_t dw) {
+	ASSERT(!Image_IsReadOnly(dst));
+	Image_TryCopySlice(src, sw, dst, dw);
+}
+
+AL2O3_EXTERN_C void Image_CopyPage(
+		Image_ImageHeader const *src,
+		uint32_t sz, uint32_t sw,
+		Image_ImageHeader const *dst,
+		uint32_t dz, uint32_t dw) {
+	ASSERT(!Image_IsReadOnly(dst));
+	Image_TryCopyPage(src, sz, sw, dst, dz, dw);
+}
+
+AL2O3_EXTERN_C void Image_CopyRow(Image_ImageHeader const *src,
+																	uint32_t sy, uint32_t sz, uint32_t sw,
+																	Image_ImageHeader const *dst,
+																	uint32_t dy, uint32_t dz, uint32_t dw) {
+	ASSERT(!Image_IsReadOnly(dst));
+	Image_TryCopyRow(src, sy, sz, sw, dst, dy, dz, dw);
 }
 
 AL2O3_EXTERN_C void Image_CopyPixel(Image_ImageHeader const *src,
 																		uint32_t sx, uint32_t sy, uint32_t sz, uint32_t sw,
 																		Image_ImageHeader const *dst,
 																		uint32_t dx, uint32_t dy, uint32_t dz, uint32_t dw) {
-	size_t const srcIndex = Image_CalculateIndex(src, sx, sy, sz, sw);
-	size_t const dstIndex = Image_CalculateIndex(src, dx, dy, dz, dw);
-	Image_PixelD pixel;
-	Image_GetPixelAtD(src, (double*)&pixel, srcIndex);
-	Image_SetPixelAtD(dst, (double*)&pixel, dstIndex);
+	ASSERT(!Image_IsReadOnly(dst));
+	Image_TryCopyPixel(src, sx, sy, sz, sw, dst, dx, dy, dz, dw);
 }
 
 AL2O3_EXTERN_C Image_ImageHeader const *Image_Clone(Image_ImageHeader const *image) {
-	auto
-			dst = (Image_ImageHeader *) Image_Create(image->width, image->height, image->depth, image->slices, image->format);
-	if (dst == nullptr) {
-		return nullptr;
-	}
-	Image_CopyImage(image, dst);
-	if (image->nextType != Image_NT_None) {
-		dst->nextImage = Image_Clone(image->nextImage);
-		dst->nextType = image->nextType;
+	Image_ImageHeader const *dst = CloneChain(image);
+	if (dst) {
+		Image::RecordLevelDirectory(dst);
 	}
 	return dst;
 }
 
 AL2O3_EXTERN_C Image_ImageHeader const *Image_CloneStructure(Image_ImageHeader const *image) {
-	auto
-			dst = (Image_ImageHeader *) Image_Create(image->width, image->height, image->depth, image->slices, image->format);
-	if (dst == nullptr) {
-		return nullptr;
-	}
-	if (image->nextType != Image_NT_None) {
-		dst->nextImage = Image_CloneStructure(image->nextImage);
-		dst->nextType = image->nextType;
+	Image_ImageHeader const *dst = CloneStructureChain(image);
+	if (dst) {
+		Image::RecordLevelDirectory(dst);
 	}
 	return dst;
 }
 
 AL2O3_EXTERN_C Image_ImageHeader const *Image_PreciseConvert(Image_ImageHeader const *image,
 																														 TinyImageFormat const newFormat) {
-	auto dst = (Image_ImageHeader *) Image_Create(image->width, image->height, image->depth, image->slices, newFormat);
-	if (dst == nullptr) {
-		return nullptr;
-	}
-	Image_CopyImage(image, dst);
-	if (image->nextType != Image_NT_None) {
-		dst->nextImage = Image_PreciseConvert(image->nextImage, newFormat);
-		dst->nextType = image->nextType;
+	Image_ImageHeader const *dst = PreciseConvertChain(image, newFormat);
+	if (dst) {
+		Image::RecordLevelDirectory(dst);
 	}
 	return dst;
 }
@@ -382,7 +366,10 @@ AL2O3_EXTERN_C Image_ImageHeader const *Image_PackMipmaps(Image_ImageHeader cons
 		return image;
 
 	size_t const packedSized = Image_ByteCountOfImageChainOf(image);
-	auto *newImage = (Image_ImageHeader *) MEMORY_MALLOC(sizeof(Image_ImageHeader) + packedSized);
+	auto *newImage = Image::AllocateImage(packedSized, false);
+	if (newImage == nullptr) {
+		return nullptr;
+	}
 	Image_FillHeader(image->width, image->height, image->depth, image->slices, image->format, newImage);
 	newImage->dataSize = packedSized;
 	newImage->flags |= Image_Flag_PackedMipMaps;
@@ -392,9 +379,21 @@ AL2O3_EXTERN_C Image_ImageHeader const *Image_PackMipmaps(Image_ImageHeader cons
 	for (size_t i = 0; i < numLevels; ++i) {
 		ASSERT((size_t)(dstPtr - (uint8_t *) Image_RawDataPtr(newImage)) < packedSized);
 		Image_ImageHeader const *levelHeader = Image_LinkedImageOf(image, i);
-		memcpy(dstPtr, Image_RawDataPtr(levelHeader), levelHeader->dataSize);
+		if (Image_IsTiled(levelHeader)) {
+			// packed levels are always linear
+			size_t const pageSize = Image_ByteCountPerPageOf(levelHeader);
+			for (uint32_t w = 0; w < levelHeader->slices; ++w) {
+				Image::SwizzlePage(((uint8_t const *) Image_RawDataPtr(levelHeader)) + w * pageSize, dstPtr + w * pageSize,
+													 levelHeader->width, levelHeader->height,
+													 TinyImageFormat_BitSizeOfBlock(levelHeader->format) / 8, false);
+			}
+		} else {
+			memcpy(dstPtr, Image_RawDataPtr(levelHeader), levelHeader->dataSize);
+		}
 		dstPtr += levelHeader->dataSize;
 	}
 
+	// so the packed levels can be addressed directly from the start
+	Image::RecordLevelDirectory(newImage);
 	return newImage;
 }
@@ -0,0 +1,164 @@
+#include "al2o3_platform/platform.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "tiny_imageformat/tinyimageformat_query.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image_impl_basic/levels.h"
+#include "gfx_image_impl_basic/shared.h"
+#include "gfx_image_impl_basic/tiled.h"
+#include "gfx_image_impl_basic/view.h"
+#include "copy.hpp"
+#include "range.hpp"
+#include "view.hpp"
+
+namespace {
+
+// nothing to address, what the constructors give for tiled images
+Image_View EmptyViewOf(TinyImageFormat format) {
+	Image_View view;
+	view.data = nullptr;
+	view.format = format;
+	view.width = 0;
+	view.height = 0;
+	view.depth = 0;
+	view.slices = 0;
+	view.rowPitch = 0;
+	view.pagePitch = 0;
+	view.slicePitch = 0;
+	view.image = nullptr;
+	view.readOnly = true;
+	return view;
+}
+
+} // end anon namespace
+
+Image_View Image::StorageViewOf(Image_ImageHeader const *image) {
+	ASSERT(image);
+	Image_View view;
+	view.data = Image_RawDataPtr(image);
+	view.format = image->format;
+	view.width = image->width;
+	view.height = image->height;
+	view.depth = image->depth;
+	view.slices = image->slices;
+	view.rowPitch = Image_ByteCountPerRowOf(image);
+	view.pagePitch = Image_ByteCountPerPageOf(image);
+	view.slicePitch = Image_ByteCountPerSliceOf(image);
+	view.image = image;
+	view.readOnly = Image_IsReadOnly(image);
+	return view;
+}
+
+AL2O3_EXTERN_C Image_View Image_ViewOf(Image_ImageHeader const *image) {
+	ASSERT(image);
+	// the rows of a tiled image are spread over its tiles, pitches can't
+	// address them
+	if (Image_IsTiled(image)) {
+		return EmptyViewOf(image->format);
+	}
+	return Image::StorageViewOf(image);
+}
+
+AL2O3_EXTERN_C Image_View Image_ViewOfRegion(Image_ImageHeader const *image,
+																						 uint32_t x, uint32_t y, uint32_t z, uint32_t w,
+																						 uint32_t width, uint32_t height, uint32_t depth, uint32_t slices) {
+	ASSERT(image);
+	if (Image_IsTiled(image)) {
+		return EmptyViewOf(image->format);
+	}
+	Image_View const whole = Image_ViewOf(image);
+	return Image_SubView(&whole, x, y, z, w, width, height, depth, slices);
+}
+
+AL2O3_EXTERN_C Image_View Image_ViewOfSlice(Image_ImageHeader const *image, uint32_t w) {
+	return Image_ViewOfRegion(image, 0, 0, 0, w, image->width, image->height, image->depth, 1);
+}
+
+AL2O3_EXTERN_C Image_View Image_ViewOfMipLevel(Image_ImageHeader const *image, uint32_t level) {
+	ASSERT(image);
+	ASSERT(level < Image_MipMapCountOf(image));
+
+	// the level directory covers linked and packed levels alike
+	Image_LevelInfo const info = Image_LevelInfoOf(image, level);
+	if (Image_IsTiled(info.image)) {
+		return EmptyViewOf(info.format);
+	}
+	Image_ImageHeader levelHeader;
+	Image_FillHeader(info.width, info.height, info.depth, info.slices, info.format, &levelHeader);
+	Image_View view;
+	view.data = info.data;
+	view.format = info.format;
+	view.width = info.width;
+	view.height = info.height;
+	view.depth = info.depth;
+	view.slices = info.slices;
+	view.rowPitch = Image_ByteCountPerRowOf(&levelHeader);
+	view.pagePitch = Image_ByteCountPerPageOf(&levelHeader);
+	view.slicePitch = Image_ByteCountPerSliceOf(&levelHeader);
+	view.image = info.image;
+	view.readOnly = Image_IsReadOnly(info.image);
+	return view;
+}
+
+AL2O3_EXTERN_C Image_View Image_SubView(Image_View const *view,
+																				uint32_t x, uint32_t y, uint32_t z, uint32_t w,
+																				uint32_t width, uint32_t height, uint32_t depth, uint32_t slices) {
+	ASSERT(view);
+	ASSERT(x + width <= view->width);
+	ASSERT(y + height <= view->height);
+	ASSERT(z + depth <= view->depth);
+	ASSERT(w + slices <= view->slices);
+	uint32_t const blockWidth = TinyImageFormat_WidthOfBlock(view->format);
+	uint32_t const blockHeight = TinyImageFormat_HeightOfBlock(view->format);
+	ASSERT(x % blockWidth == 0 && y % blockHeight == 0);
+	ASSERT(width % blockWidth == 0 || x + width == view->width);
+	ASSERT(height % blockHeight == 0 || y + height == view->height);
+
+	Image_View sub = *view;
+	sub.data = ((uint8_t *) view->data) + (size_t) w * view->slicePitch + (size_t) z * view->pagePitch +
+			(size_t) (y / blockHeight) * view->rowPitch + (size_t) (x / blockWidth) * Image::BlockSizeOf(*view);
+	sub.width = width;
+	sub.height = height;
+	sub.depth = depth;
+	sub.slices = slices;
+	return sub;
+}
+
+AL2O3_EXTERN_C bool Image_ViewCopy(Image_View const *src, Image_View const *dst) {
+	ASSERT(src);
+	ASSERT(dst);
+	// the image may have been shared since the view was made
+	if (dst->readOnly || (dst->image && Image_IsReadOnly(dst->image)) || !src->data) {
+		return false;
+	}
+	Image::CopyPlan const plan = Image::PlanCopy(src->format, dst->format);
+	return Image::CopyView(plan, *src, *dst);
+}
+
+AL2O3_EXTERN_C Image_ImageHeader const *Image_ViewClone(Image_View const *view, TinyImageFormat newFormat) {
+	ASSERT(view);
+	if (!view->data) {
+		return nullptr;
+	}
+	if (newFormat == TinyImageFormat_UNDEFINED) {
+		newFormat = view->format;
+	}
+	Image_ImageHeader const *image = Image_CreateNoClear(view->width, view->height, view->depth, view->slices, newFormat);
+	if (!image) {
+		return nullptr;
+	}
+	Image_View const dst = Image_ViewOf(image);
+	if (!Image_ViewCopy(view, &dst)) {
+		Image_Destroy(image);
+		return nullptr;
+	}
+	return image;
+}
+
+AL2O3_EXTERN_C bool Image_ViewGetColorRangeOf(Image_View const *view, Image_PixelD *omin, Image_PixelD *omax) {
+	ASSERT(view);
+	ASSERT(omin);
+	ASSERT(omax);
+	Image::ColorRangeOf(*view, 1, &omin->r, &omax->r);
+	return true;
+}
@@ -0,0 +1,84 @@
+// Walking an Image_View. A whole image is just the view Image_ViewOf gives,
+// so the reductions and copies use these for images and views alike
+#ifndef WYRD_IMAGE_VIEW_HPP
+#define WYRD_IMAGE_VIEW_HPP
+
+#include "al2o3_platform/platform.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "tiny_imageformat/tinyimageformat_query.h"
+#include "gfx_image/image.h"
+#include "gfx_image_impl_basic/view.h"
+
+namespace Image {
+
+// every pixel of image in storage order, tiled or not, for work that doesn't
+// care where a pixel is (ranges, statistics). Image_ViewOf refuses tiled
+// images
+Image_View StorageViewOf(Image_ImageHeader const *image);
+
+inline size_t BlockSizeOf(Image_View const &view) {
+	return TinyImageFormat_BitSizeOfBlock(view.format) / 8;
+}
+
+inline uint32_t BlocksPerRowOf(Image_View const &view) {
+	return view.width / TinyImageFormat_WidthOfBlock(view.format);
+}
+
+inline uint32_t RowsPerPageOf(Image_View const &view) {
+	return view.height / TinyImageFormat_HeightOfBlock(view.format);
+}
+
+// rows (of blocks) of every page, in z then slice order
+inline size_t RowCountOf(Image_View const &view) {
+	return (size_t) RowsPerPageOf(view) * view.depth * view.slices;
+}
+
+inline size_t PixelCountOf(Image_View const &view) {
+	return (size_t) view.width * view.height * view.depth * view.slices;
+}
+
+// row is in RowCountOf order
+inline uint8_t *RowPtrOf(Image_View const &view, size_t row) {
+	size_t const rowsPerPage = RowsPerPageOf(view);
+	size_t const page = row / rowsPerPage;
+	return ((uint8_t *) view.data) + (row % rowsPerPage) * view.rowPitch +
+			(page % view.depth) * view.pagePitch + (page / view.depth) * view.slicePitch;
+}
+
+// row y (of blocks) of page (z, w)
+inline uint8_t *RowPtrOf(Image_View const &view, uint32_t y, uint32_t z, uint32_t w) {
+	return ((uint8_t *) view.data) + y * view.rowPitch + z * view.pagePitch + w * view.slicePitch;
+}
+
+// true if every row directly follows the one before, as in a whole image
+inline bool IsContiguous(Image_View const &view) {
+	size_t const rowBytes = BlocksPerRowOf(view) * BlockSizeOf(view);
+	size_t const pageBytes = rowBytes * RowsPerPageOf(view);
+	return (RowsPerPageOf(view) == 1 || view.rowPitch == rowBytes) &&
+			(view.depth == 1 || view.pagePitch == pageBytes) &&
+			(view.slices == 1 || view.slicePitch == pageBytes * view.depth);
+}
+
+// calls func(pixels, pixelCount) for each contiguous run of the count pixels
+// from pixel begin (in row order) of a view of a one pixel block format
+template<typename Func>
+void ForEachRun(Image_View const &view, size_t begin, size_t count, Func const &func) {
+	size_t const pixelSize = BlockSizeOf(view);
+	if (IsContiguous(view)) {
+		func(((uint8_t *) view.data) + begin * pixelSize, count);
+		return;
+	}
+	size_t row = begin / view.width;
+	size_t x = begin % view.width;
+	while (count) {
+		size_t const n = count < view.width - x ? count : view.width - x;
+		func(RowPtrOf(view, row) + x * pixelSize, n);
+		count -= n;
+		x = 0;
+		++row;
+	}
+}
+
+} // end namespace Image
+
+#endif //WYRD_IMAGE_VIEW_HPP
@@ -0,0 +1,148 @@
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image/utils.h"
+#include "gfx_image_impl_basic/allocator.h"
+#include "gfx_image_impl_basic/mipmap.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "al2o3_catch2/catch2.hpp"
+#include <cstring>
+
+TEST_CASE("Arena allocator routes every create variant (C)", "[Image Allocator]") {
+	Image_Allocator *arena = Image_AllocatorCreateArena(64 * 1024);
+	REQUIRE(arena);
+	CHECK(Image_SetThreadAllocator(arena) == nullptr);
+	CHECK(Image_GetThreadAllocator() == arena);
+
+	Image_ImageHeader const *images[] = {
+			Image_Create1D(100, TinyImageFormat_R8_UNORM),
+			Image_Create2DNoClear(17, 9, TinyImageFormat_R8G8B8A8_UNORM),
+			Image_Create3D(8, 8, 8, TinyImageFormat_R16_SFLOAT),
+			Image_CreateCubemapArray(16, 16, 2, TinyImageFormat_R8G8B8A8_UNORM),
+			Image_CreateCLUT(8, 8, TinyImageFormat_CLUT_P8, 256),
+			// bigger than a block gets a block of its own
+			Image_Create2D(256, 256, TinyImageFormat_R32G32B32A32_SFLOAT),
+	};
+	Image_ImageHeader const *mipped = Image_Create2D(32, 32, TinyImageFormat_R8G8B8A8_UNORM);
+	Image_CreateMipMapChain(mipped, true);
+	Image_ImageHeader const *clone = Image_Clone(mipped);
+	CHECK(Image_LinkedImageCountOf(clone) == Image_LinkedImageCountOf(mipped));
+
+	CHECK(Image_SetThreadAllocator(nullptr) == arena);
+	for (auto image : images) {
+		REQUIRE(image);
+		CHECK(((uintptr_t) Image_RawDataPtr(image) & (Image_DefaultDataAlignment - 1)) == 0);
+		Image_Destroy(image);
+	}
+	Image_Destroy(mipped);
+	Image_Destroy(clone);
+
+	// after a reset the same memory is handed out again
+	Image_AllocatorReset(arena);
+	Image_ImageHeader const *again = Image_CreateWithAllocator(arena, 100, 1, 1, 1, TinyImageFormat_R8_UNORM);
+	CHECK(again == images[0]);
+	auto data = (uint8_t const *) Image_RawDataPtr(again);
+	for (uint32_t i = 0; i < 100; ++i) {
+		CHECK(data[i] == 0);
+	}
+	Image_Destroy(again);
+	Image_AllocatorDestroy(arena);
+}
+
+TEST_CASE("Pool allocator recycles by size class (C)", "[Image Allocator]") {
+	Image_Allocator *pool = Image_AllocatorCreatePool(64 * 1024);
+	REQUIRE(pool);
+
+	Image_ImageHeader const *a = Image_CreateNoClearWithAllocator(pool, 20, 16, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(a);
+	Image_Destroy(a);
+	// same size class, reuses the freed block
+	Image_ImageHeader const *b = Image_CreateWithAllocator(pool, 16, 16, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	CHECK(b == a);
+	CHECK(b->width == 16);
+
+	// too big to pool, straight from the heap
+	Image_ImageHeader const *big = Image_CreateWithAllocator(pool, 256, 256, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(big);
+	memset(Image_RawDataPtr(big), 0xff, big->dataSize);
+
+	// heap and pool images mix in one chain
+	Image_ImageHeader const *heap = Image_Create2D(8, 8, TinyImageFormat_R8G8B8A8_UNORM);
+	((Image_ImageHeader *) heap)->nextType = Image_NT_Layer;
+	((Image_ImageHeader *) heap)->nextImage = b;
+	Image_Destroy(heap);
+	Image_Destroy(big);
+
+	Image_AllocatorReset(pool);
+	Image_AllocatorDestroy(pool);
+}
+
+TEST_CASE("Pixel data alignment (C)", "[Image Allocator]") {
+	Image_ImageHeader const *image = Image_Create2D(3, 3, TinyImageFormat_R8_UNORM);
+	REQUIRE(image);
+	CHECK(((uintptr_t) Image_RawDataPtr(image) & (Image_DefaultDataAlignment - 1)) == 0);
+	Image_Destroy(image);
+
+	CHECK(Image_SetThreadDataAlignment(4096) == Image_DefaultDataAlignment);
+	Image_Allocator *pool = Image_AllocatorCreatePool(0);
+	Image_Allocator *arena = Image_AllocatorCreateArena(0);
+	Image_ImageHeader const *images[] = {
+			Image_Create2D(3, 3, TinyImageFormat_R8_UNORM),
+			Image_CreateWithAllocator(pool, 5, 5, 1, 1, TinyImageFormat_R8_UNORM),
+			Image_CreateWithAllocator(arena, 7, 7, 1, 1, TinyImageFormat_R8_UNORM),
+			Image_CreateWithAllocator(arena, 9, 9, 1, 1, TinyImageFormat_R8_UNORM),
+	};
+	for (auto image : images) {
+		REQUIRE(image);
+		CHECK(((uintptr_t) Image_RawDataPtr(image) & 4095) == 0);
+		Image_Destroy(image);
+	}
+	// below the default gives the default
+	CHECK(Image_SetThreadDataAlignment(16) == 4096);
+	CHECK(Image_GetThreadDataAlignment() == Image_DefaultDataAlignment);
+
+	Image_AllocatorDestroy(pool);
+	Image_AllocatorDestroy(arena);
+}
+
+TEST_CASE("Create clears reused and fresh memory (C)", "[Image Allocator]") {
+	auto allZero = [](Image_ImageHeader const *image) {
+		uint8_t const *data = (uint8_t const *) Image_RawDataPtr(image);
+		for (uint64_t i = 0; i < image->dataSize; ++i) {
+			if (data[i] != 0) {
+				return false;
+			}
+		}
+		return true;
+	};
+
+	Image_Allocator *pool = Image_AllocatorCreatePool(64 * 1024);
+	REQUIRE(pool);
+	Image_ImageHeader const *dirty = Image_CreateNoClearWithAllocator(pool, 16, 16, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(dirty);
+	memset(Image_RawDataPtr(dirty), 0xff, dirty->dataSize);
+	Image_Destroy(dirty);
+	Image_ImageHeader const *reused = Image_CreateWithAllocator(pool, 16, 16, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(reused == dirty);
+	CHECK(allZero(reused));
+	Image_Destroy(reused);
+	Image_AllocatorDestroy(pool);
+
+	Image_Allocator *arena = Image_AllocatorCreateArena(0);
+	REQUIRE(arena);
+	dirty = Image_CreateNoClearWithAllocator(arena, 16, 16, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(dirty);
+	memset(Image_RawDataPtr(dirty), 0xff, dirty->dataSize);
+	Image_AllocatorReset(arena);
+	reused = Image_CreateWithAllocator(arena, 16, 16, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(reused == dirty);
+	CHECK(allZero(reused));
+	Image_AllocatorReset(arena);
+	Image_AllocatorDestroy(arena);
+
+	// big enough to come straight from the OS via calloc
+	Image_ImageHeader const *large = Image_Create2D(2048, 2048, TinyImageFormat_R32G32B32A32_SFLOAT);
+	REQUIRE(large);
+	CHECK(allZero(large));
+	Image_Destroy(large);
+}
@@ -0,0 +1,529 @@
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image/utils.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "gfx_image_impl_basic/allocator.h"
+#include "gfx_image_impl_basic/convert.h"
+#include "gfx_image_impl_basic/shared.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Fast convert R8G8B8 to R8G8B8A8 (C)", "[Image Convert]") {
+	// odd width to exercise the vector body and the scalar tail
+	Image_ImageHeader const *src = Image_Create2D(67, 5, TinyImageFormat_R8G8B8_UNORM);
+	REQUIRE(src);
+	auto sptr = (uint8_t *) Image_RawDataPtr(src);
+	for (auto i = 0u; i < src->dataSize; ++i) {
+		sptr[i] = (uint8_t) (i * 7);
+	}
+
+	Image_ImageHeader const *dst = Image_FastConvert(src, TinyImageFormat_R8G8B8A8_UNORM, true);
+	REQUIRE(dst);
+	CHECK(dst != src);
+	CHECK(dst->format == TinyImageFormat_R8G8B8A8_UNORM);
+	CHECK(dst->width == src->width);
+	CHECK(dst->height == src->height);
+
+	auto dptr = (uint8_t const *) Image_RawDataPtr(dst);
+	for (auto i = 0u; i < Image_PixelCountOf(src); ++i) {
+		CHECK(dptr[i * 4 + 0] == sptr[i * 3 + 0]);
+		CHECK(dptr[i * 4 + 1] == sptr[i * 3 + 1]);
+		CHECK(dptr[i * 4 + 2] == sptr[i * 3 + 2]);
+		CHECK(dptr[i * 4 + 3] == 255);
+	}
+	Image_Destroy(dst);
+
+	Image_Destroy(src);
+
+	// integer formats get an alpha of 1 not 255
+	src = Image_Create2D(5, 1, TinyImageFormat_R8G8B8_UINT);
+	REQUIRE(src);
+	dst = Image_FastConvert(src, TinyImageFormat_R8G8B8A8_UINT, true);
+	REQUIRE(dst);
+	dptr = (uint8_t const *) Image_RawDataPtr(dst);
+	CHECK(dptr[3] == 1);
+	Image_Destroy(dst);
+	Image_Destroy(src);
+}
+
+TEST_CASE("Fast convert R8G8B8A8 to B8G8R8A8 (C)", "[Image Convert]") {
+	Image_ImageHeader const *src = Image_Create2D(131, 3, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(src);
+	auto sptr = (uint8_t *) Image_RawDataPtr(src);
+	for (auto i = 0u; i < src->dataSize; ++i) {
+		sptr[i] = (uint8_t) (i * 13);
+	}
+
+	Image_ImageHeader const *dst = Image_FastConvert(src, TinyImageFormat_B8G8R8A8_UNORM, false);
+	REQUIRE(dst);
+	CHECK(dst != src);
+	CHECK(dst->format == TinyImageFormat_B8G8R8A8_UNORM);
+	auto dptr = (uint8_t const *) Image_RawDataPtr(dst);
+	for (auto i = 0u; i < Image_PixelCountOf(src); ++i) {
+		CHECK(dptr[i * 4 + 0] == sptr[i * 4 + 2]);
+		CHECK(dptr[i * 4 + 1] == sptr[i * 4 + 1]);
+		CHECK(dptr[i * 4 + 2] == sptr[i * 4 + 0]);
+		CHECK(dptr[i * 4 + 3] == sptr[i * 4 + 3]);
+	}
+
+	// and back again in place
+	Image_ImageHeader const *back = Image_FastConvert(dst, TinyImageFormat_R8G8B8A8_UNORM, true);
+	CHECK(back == dst);
+	CHECK(back->format == TinyImageFormat_R8G8B8A8_UNORM);
+	CHECK(memcmp(Image_RawDataPtr(back), sptr, src->dataSize) == 0);
+
+	Image_Destroy(back);
+	Image_Destroy(src);
+}
+
+TEST_CASE("Fast convert half to float (C)", "[Image Convert]") {
+	Image_ImageHeader const *src = Image_Create2D(37, 3, TinyImageFormat_R16G16B16A16_SFLOAT);
+	REQUIRE(src);
+	auto sptr = (uint16_t *) Image_RawDataPtr(src);
+	for (auto i = 0u; i < Image_PixelCountOf(src) * 4; ++i) {
+		sptr[i] = Math_Float2Half(((float) i - 200.0f) * 0.125f);
+	}
+
+	Image_ImageHeader const *dst = Image_FastConvert(src, TinyImageFormat_R32G32B32A32_SFLOAT, true);
+	REQUIRE(dst);
+	CHECK(dst->format == TinyImageFormat_R32G32B32A32_SFLOAT);
+	auto dptr = (float const *) Image_RawDataPtr(dst);
+	for (auto i = 0u; i < Image_PixelCountOf(src) * 4; ++i) {
+		CHECK(dptr[i] == ((float) i - 200.0f) * 0.125f);
+	}
+
+	// and back again
+	Image_ImageHeader const *back = Image_FastConvert(dst, TinyImageFormat_R16G16B16A16_SFLOAT, true);
+	REQUIRE(back);
+	CHECK(memcmp(Image_RawDataPtr(back), sptr, src->dataSize) == 0);
+
+	Image_Destroy(back);
+	Image_Destroy(dst);
+	Image_Destroy(src);
+}
+
+TEST_CASE("Fast convert float to half changing channel count (C)", "[Image Convert]") {
+	Image_ImageHeader const *src = Image_Create2D(300, 2, TinyImageFormat_R32G32B32_SFLOAT);
+	REQUIRE(src);
+	auto sptr = (float *) Image_RawDataPtr(src);
+	for (auto i = 0u; i < Image_PixelCountOf(src) * 3; ++i) {
+		sptr[i] = (float) (i % 1024);
+	}
+
+	Image_ImageHeader const *dst = Image_FastConvert(src, TinyImageFormat_R16G16B16A16_SFLOAT, true);
+	REQUIRE(dst);
+	auto dptr = (uint16_t const *) Image_RawDataPtr(dst);
+	for (auto i = 0u; i < Image_PixelCountOf(src); ++i) {
+		CHECK(Math_Half2Float(dptr[i * 4 + 0]) == sptr[i * 3 + 0]);
+		CHECK(Math_Half2Float(dptr[i * 4 + 1]) == sptr[i * 3 + 1]);
+		CHECK(Math_Half2Float(dptr[i * 4 + 2]) == sptr[i * 3 + 2]);
+		CHECK(Math_Half2Float(dptr[i * 4 + 3]) == 1.0f);
+	}
+
+	Image_ImageHeader const *red = Image_FastConvert(dst, TinyImageFormat_R32_SFLOAT, true);
+	REQUIRE(red);
+	auto rptr = (float const *) Image_RawDataPtr(red);
+	for (auto i = 0u; i < Image_PixelCountOf(src); ++i) {
+		CHECK(rptr[i] == sptr[i * 3 + 0]);
+	}
+
+	Image_Destroy(red);
+	Image_Destroy(dst);
+	Image_Destroy(src);
+}
+
+TEST_CASE("Fast convert every link of a chain (C)", "[Image Convert]") {
+	auto src = (Image_ImageHeader *) Image_Create2D(8, 8, TinyImageFormat_R16_SFLOAT);
+	auto mip = (Image_ImageHeader *) Image_Create2D(4, 4, TinyImageFormat_R16_SFLOAT);
+	REQUIRE(src);
+	REQUIRE(mip);
+	src->nextType = Image_NT_MipMap;
+	src->nextImage = mip;
+	auto mptr = (uint16_t *) Image_RawDataPtr(mip);
+	for (auto i = 0u; i < Image_PixelCountOf(mip); ++i) {
+		mptr[i] = Math_Float2Half(2.0f);
+	}
+
+	Image_ImageHeader const *dst = Image_FastConvert(src, TinyImageFormat_R32_SFLOAT, true);
+	REQUIRE(dst);
+	REQUIRE(dst->nextType == Image_NT_MipMap);
+	REQUIRE(dst->nextImage);
+	CHECK(dst->nextImage->format == TinyImageFormat_R32_SFLOAT);
+	CHECK(((float const *) Image_RawDataPtr(dst->nextImage))[15] == 2.0f);
+
+	Image_Destroy(dst);
+	Image_Destroy(src);
+}
+
+namespace {
+
+// the largest difference between two decodings of a channel of fmt that
+// rounding alone can make, one code for integers and normalised formats
+double ChannelToleranceOf(TinyImageFormat fmt, double v) {
+	if (TinyImageFormat_IsFloat(fmt)) {
+		return 1e-3 * (fabs(v) > 1.0 ? fabs(v) : 1.0);
+	}
+	if (TinyImageFormat_IsSRGB(fmt)) {
+		return 0.01;
+	}
+	if (TinyImageFormat_IsNormalised(fmt)) {
+		uint32_t const bits = TinyImageFormat_ChannelBitWidth(fmt, TinyImageFormat_LC_Red);
+		return 1.01 / (ldexp(1.0, TinyImageFormat_IsSigned(fmt) ? bits - 1 : bits) - 1.0);
+	}
+	return 1.0;
+}
+
+bool MatchesDecoder(Image_ImageHeader const *src, Image_ImageHeader const *dst) {
+	for (size_t i = 0; i < Image_PixelCountOf(src); ++i) {
+		double in[4];
+		double expected[4];
+		double actual[4];
+		Image_GetPixelAtD(src, in, i);
+		Image_ImageHeader const *reference = Image_Create(1, 1, 1, 1, dst->format);
+		Image_SetPixelAtD(reference, in, 0);
+		Image_GetPixelAtD(reference, expected, 0);
+		Image_Destroy(reference);
+		Image_GetPixelAtD(dst, actual, i);
+		for (int c = 0; c < 4; ++c) {
+			if (actual[c] != expected[c] && !(fabs(actual[c] - expected[c]) <= ChannelToleranceOf(dst->format, expected[c]))) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+} // end anon namespace
+
+TEST_CASE("Fast convert between plain formats matches the decoder (C)", "[Image Convert]") {
+	TinyImageFormat const formats[] = {
+			TinyImageFormat_R8_UNORM, TinyImageFormat_R8G8_SNORM, TinyImageFormat_R8G8B8_UINT,
+			TinyImageFormat_B8G8R8_SRGB, TinyImageFormat_R8G8B8A8_SINT, TinyImageFormat_R8G8B8A8_SRGB,
+			TinyImageFormat_B8G8R8A8_UNORM, TinyImageFormat_R16_SFLOAT, TinyImageFormat_R16G16_UNORM,
+			TinyImageFormat_R16G16B16_SNORM, TinyImageFormat_R16G16B16A16_UINT, TinyImageFormat_R16G16B16A16_SINT,
+			TinyImageFormat_R32_UINT, TinyImageFormat_R32G32_SFLOAT, TinyImageFormat_R32G32B32_SINT,
+			TinyImageFormat_R32G32B32A32_SFLOAT, TinyImageFormat_R64_SFLOAT, TinyImageFormat_R64G64_UINT,
+			TinyImageFormat_R64G64B64A64_SINT,
+	};
+	double const values[] = {-300.0, -2.0, -1.0, -0.5, 0.0, 0.2, 0.5, 0.75, 1.0, 3.0, 200.0, 60000.0};
+	size_t const valueCount = sizeof(values) / sizeof(values[0]);
+
+	for (TinyImageFormat from : formats) {
+		// 21 pixels so the blocked paths see a partial block
+		Image_ImageHeader const *src = Image_Create(7, 3, 1, 1, from);
+		REQUIRE(src);
+		for (size_t i = 0; i < Image_PixelCountOf(src); ++i) {
+			double const pixel[4] = {values[i % valueCount], values[(i + 5) % valueCount],
+															 values[(i + 7) % valueCount], values[(i + 3) % valueCount]};
+			Image_SetPixelAtD(src, pixel, i);
+		}
+
+		for (TinyImageFormat to : formats) {
+			Image_ImageHeader const *dst = Image_FastConvert(src, to, false);
+			REQUIRE(dst);
+			CHECK(dst->format == to);
+			INFO(TinyImageFormat_Name(from) << " to " << TinyImageFormat_Name(to));
+			CHECK(MatchesDecoder(src, dst));
+
+			// in place when every step of the plan is
+			Image_ConvertPlan plan;
+			Image_PlanFastConvert(from, to, true, &plan);
+			bool inPlace = true;
+			for (uint32_t i = 0; i < plan.stepCount; ++i) {
+				inPlace = inPlace && plan.steps[i].inPlace;
+			}
+			Image_ImageHeader const *clone = Image_Clone(src);
+			Image_ImageHeader const *converted = Image_FastConvert(clone, to, true);
+			CHECK((converted == clone) == inPlace);
+			CHECK(MatchesDecoder(src, converted));
+			if (converted != clone) {
+				Image_Destroy(converted);
+			}
+			Image_Destroy(clone);
+			Image_Destroy(dst);
+		}
+		Image_Destroy(src);
+	}
+}
+
+TEST_CASE("Fast convert integers to floats (C)", "[Image Convert]") {
+	// normalised formats give their logical values, not the stored integers
+	Image_ImageHeader const *unorm = Image_Create2D(2, 1, TinyImageFormat_B8G8R8A8_UNORM);
+	REQUIRE(unorm);
+	uint8_t const unormBytes[8] = {255, 51, 0, 0, 0, 0, 255, 255};
+	memcpy(Image_RawDataPtr(unorm), unormBytes, sizeof(unormBytes));
+	Image_ImageHeader const *rgb = Image_FastConvert(unorm, TinyImageFormat_R32G32B32_SFLOAT, true);
+	REQUIRE(rgb);
+	auto rgbPtr = (float const *) Image_RawDataPtr(rgb);
+	CHECK(rgbPtr[0] == 0.0f);
+	CHECK(rgbPtr[1] == Approx(0.2f));
+	CHECK(rgbPtr[2] == 1.0f);
+	CHECK(rgbPtr[3] == 1.0f);
+	CHECK(rgbPtr[4] == 0.0f);
+	CHECK(rgbPtr[5] == 0.0f);
+	Image_Destroy(rgb);
+	Image_Destroy(unorm);
+
+	Image_ImageHeader const *snorm = Image_Create2D(1, 1, TinyImageFormat_R8G8_SNORM);
+	REQUIRE(snorm);
+	((int8_t *) Image_RawDataPtr(snorm))[0] = -128;
+	((int8_t *) Image_RawDataPtr(snorm))[1] = 127;
+	Image_ImageHeader const *rg = Image_FastConvert(snorm, TinyImageFormat_R32G32_SFLOAT, true);
+	REQUIRE(rg);
+	CHECK(((float const *) Image_RawDataPtr(rg))[0] == -1.0f);
+	CHECK(((float const *) Image_RawDataPtr(rg))[1] == 1.0f);
+	Image_Destroy(rg);
+	Image_Destroy(snorm);
+
+	// integer formats keep their values and a missing alpha is 1
+	Image_ImageHeader const *uint = Image_Create2D(3, 1, TinyImageFormat_R16G16_UINT);
+	REQUIRE(uint);
+	auto uintPtr = (uint16_t *) Image_RawDataPtr(uint);
+	for (uint32_t i = 0; i < 6; ++i) {
+		uintPtr[i] = (uint16_t) (i * 13107);
+	}
+	Image_ImageHeader const *rgba = Image_FastConvert(uint, TinyImageFormat_R32G32B32A32_SFLOAT, true);
+	REQUIRE(rgba);
+	auto rgbaPtr = (float const *) Image_RawDataPtr(rgba);
+	for (uint32_t i = 0; i < 3; ++i) {
+		CHECK(rgbaPtr[i * 4 + 0] == (float) uintPtr[i * 2 + 0]);
+		CHECK(rgbaPtr[i * 4 + 1] == (float) uintPtr[i * 2 + 1]);
+		CHECK(rgbaPtr[i * 4 + 2] == 0.0f);
+		CHECK(rgbaPtr[i * 4 + 3] == 1.0f);
+	}
+	Image_Destroy(rgba);
+	Image_Destroy(uint);
+}
+
+TEST_CASE("Fast convert from several threads at once (C)", "[Image Convert]") {
+	TinyImageFormat const formats[] = {
+			TinyImageFormat_R8G8B8A8_UNORM, TinyImageFormat_B8G8R8A8_UNORM, TinyImageFormat_R16G16B16A16_UNORM,
+			TinyImageFormat_R16G16B16A16_SFLOAT, TinyImageFormat_R32G32B32A32_SFLOAT, TinyImageFormat_R64G64B64A64_SFLOAT,
+	};
+	size_t const formatCount = sizeof(formats) / sizeof(formats[0]);
+	Image_ImageHeader const *src = Image_Create2D(33, 9, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(src);
+	auto sptr = (uint8_t *) Image_RawDataPtr(src);
+	for (auto i = 0u; i < src->dataSize; ++i) {
+		sptr[i] = (uint8_t) (i * 11);
+	}
+
+	// every thread converts to every format and back, each lossless
+	uint32_t const threadCount = 8;
+	bool same[threadCount];
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < threadCount; ++t) {
+		threads.emplace_back([&, t]() {
+			same[t] = true;
+			for (size_t f = 0; f < formatCount; ++f) {
+				TinyImageFormat const to = formats[(f + t) % formatCount];
+				Image_ImageHeader const *dst = Image_FastConvert(src, to, false);
+				Image_ImageHeader const *back = Image_FastConvert(dst, TinyImageFormat_R8G8B8A8_UNORM, false);
+				same[t] = same[t] && memcmp(Image_RawDataPtr(back), sptr, src->dataSize) == 0;
+				Image_Destroy(back);
+				Image_Destroy(dst);
+			}
+		});
+	}
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+	for (uint32_t t = 0; t < threadCount; ++t) {
+		CHECK(same[t]);
+	}
+	Image_Destroy(src);
+}
+
+TEST_CASE("Fast convert plans (C)", "[Image Convert]") {
+	Image_ConvertPlan plan;
+
+	// nothing to do, or a copy
+	Image_PlanFastConvert(TinyImageFormat_R8G8B8A8_UNORM, TinyImageFormat_R8G8B8A8_UNORM, true, &plan);
+	CHECK(plan.stepCount == 0);
+	Image_PlanFastConvert(TinyImageFormat_R8G8B8A8_UNORM, TinyImageFormat_R8G8B8A8_UNORM, false, &plan);
+	REQUIRE(plan.stepCount == 1);
+	CHECK_FALSE(plan.steps[0].inPlace);
+
+	// a hand written kernel, in place only when allowed
+	Image_PlanFastConvert(TinyImageFormat_R8G8B8A8_UNORM, TinyImageFormat_B8G8R8A8_UNORM, true, &plan);
+	REQUIRE(plan.stepCount == 1);
+	CHECK(plan.steps[0].kernel == Image_CK_Fast);
+	CHECK(plan.steps[0].inPlace);
+	Image_PlanFastConvert(TinyImageFormat_R8G8B8A8_UNORM, TinyImageFormat_B8G8R8A8_UNORM, false, &plan);
+	REQUIRE(plan.stepCount == 1);
+	CHECK_FALSE(plan.steps[0].inPlace);
+
+	// half to 8 bit through float, SIMD half to float then the matrix
+	Image_PlanFastConvert(TinyImageFormat_R16G16B16A16_SFLOAT, TinyImageFormat_R8G8B8A8_UNORM, true, &plan);
+	REQUIRE(plan.stepCount == 2);
+	CHECK(plan.steps[0].kernel == Image_CK_Fast);
+	CHECK(plan.steps[0].to == TinyImageFormat_R32G32B32A32_SFLOAT);
+	CHECK(plan.steps[1].kernel == Image_CK_Matrix);
+	CHECK(plan.steps[1].from == TinyImageFormat_R32G32B32A32_SFLOAT);
+	CHECK(plan.steps[1].to == TinyImageFormat_R8G8B8A8_UNORM);
+	CHECK(plan.cost == Approx(plan.steps[0].cost + plan.steps[1].cost));
+
+	// two hand written kernels, the second in place on the first's image
+	Image_PlanFastConvert(TinyImageFormat_R8G8B8_UNORM, TinyImageFormat_B8G8R8A8_UNORM, false, &plan);
+	REQUIRE(plan.stepCount == 2);
+	CHECK(plan.steps[0].kernel == Image_CK_Fast);
+	CHECK_FALSE(plan.steps[0].inPlace);
+	CHECK(plan.steps[1].kernel == Image_CK_Fast);
+	CHECK(plan.steps[1].inPlace);
+
+	// formats the matrix doesn't handle decode
+	Image_PlanFastConvert(TinyImageFormat_R5G5B5A1_UNORM, TinyImageFormat_R8G8B8A8_UNORM, true, &plan);
+	REQUIRE(plan.stepCount == 1);
+	CHECK(plan.steps[0].kernel == Image_CK_Decode);
+}
+
+TEST_CASE("Fast convert through intermediate formats (C)", "[Image Convert]") {
+	Image_ImageHeader const *half = Image_Create2D(19, 7, TinyImageFormat_R16G16B16A16_SFLOAT);
+	REQUIRE(half);
+	auto hptr = (uint16_t *) Image_RawDataPtr(half);
+	for (auto i = 0u; i < Image_PixelCountOf(half) * 4; ++i) {
+		hptr[i] = Math_Float2Half(((float) (i % 300) - 20.0f) / 256.0f);
+	}
+
+	// the same bytes as the direct matrix conversion
+	Image_ImageHeader const *direct = Image_Create2D(19, 7, TinyImageFormat_R8G8B8A8_UNORM);
+	Image_CopyImage(half, direct);
+	Image_ImageHeader const *unorm = Image_FastConvert(half, TinyImageFormat_R8G8B8A8_UNORM, true);
+	REQUIRE(unorm);
+	CHECK(unorm != half);
+	CHECK(unorm->format == TinyImageFormat_R8G8B8A8_UNORM);
+	CHECK(memcmp(Image_RawDataPtr(unorm), Image_RawDataPtr(direct), direct->dataSize) == 0);
+
+	Image_ImageHeader const *rgb = Image_FastConvert(unorm, TinyImageFormat_R8G8B8_UNORM, false);
+	REQUIRE(rgb);
+	Image_ImageHeader const *bgra = Image_FastConvert(rgb, TinyImageFormat_B8G8R8A8_UNORM, false);
+	REQUIRE(bgra);
+	auto rgbPtr = (uint8_t const *) Image_RawDataPtr(rgb);
+	auto bgraPtr = (uint8_t const *) Image_RawDataPtr(bgra);
+	for (auto i = 0u; i < Image_PixelCountOf(rgb); ++i) {
+		CHECK(bgraPtr[i * 4 + 0] == rgbPtr[i * 3 + 2]);
+		CHECK(bgraPtr[i * 4 + 1] == rgbPtr[i * 3 + 1]);
+		CHECK(bgraPtr[i * 4 + 2] == rgbPtr[i * 3 + 0]);
+		CHECK(bgraPtr[i * 4 + 3] == 255);
+	}
+
+	Image_Destroy(bgra);
+	Image_Destroy(rgb);
+	Image_Destroy(unorm);
+	Image_Destroy(direct);
+	Image_Destroy(half);
+}
+
+TEST_CASE("Fast convert batch (C)", "[Image Convert]") {
+	// a hand written kernel, two in a row, one through float and the matrix
+	struct Pair {
+		TinyImageFormat from;
+		TinyImageFormat to;
+	} const pairs[] = {
+			{TinyImageFormat_R8G8B8A8_UNORM, TinyImageFormat_B8G8R8A8_UNORM},
+			{TinyImageFormat_R8G8B8_UNORM, TinyImageFormat_B8G8R8A8_UNORM},
+			{TinyImageFormat_R16G16B16A16_SFLOAT, TinyImageFormat_R8G8B8A8_UNORM},
+			{TinyImageFormat_R8G8B8A8_SRGB, TinyImageFormat_R32G32B32A32_SFLOAT},
+	};
+	size_t const pairCount = sizeof(pairs) / sizeof(pairs[0]);
+	size_t const jobCount = 61;
+
+	std::vector<Image_ConvertJob> jobs(jobCount);
+	for (size_t j = 0; j < jobCount; ++j) {
+		Pair const &pair = pairs[j % pairCount];
+		Image_ImageHeader const *image = Image_Create2D(3 + (uint32_t) (j % 7), 4, pair.from);
+		REQUIRE(image);
+		auto ptr = (uint8_t *) Image_RawDataPtr(image);
+		for (auto i = 0u; i < image->dataSize; ++i) {
+			ptr[i] = (uint8_t) (i * 7 + j);
+		}
+		if (pair.from == TinyImageFormat_R16G16B16A16_SFLOAT) {
+			// keep the halfs finite
+			auto hptr = (uint16_t *) ptr;
+			for (auto i = 0u; i < Image_PixelCountOf(image) * 4; ++i) {
+				hptr[i] = Math_Float2Half((float) ((i + j) % 300) / 256.0f);
+			}
+		}
+		jobs[j] = {image, pair.to, nullptr};
+	}
+
+	// the same as converting one at a time
+	REQUIRE(Image_FastConvertBatch(jobs.data(), jobCount, false, 4));
+	for (Image_ConvertJob &job : jobs) {
+		REQUIRE(job.result);
+		CHECK(job.result != job.image);
+		CHECK(job.result->format == job.format);
+		Image_ImageHeader const *single = Image_FastConvert(job.image, job.format, false);
+		REQUIRE(single);
+		REQUIRE(job.result->dataSize == single->dataSize);
+		CHECK(memcmp(Image_RawDataPtr(job.result), Image_RawDataPtr(single), single->dataSize) == 0);
+		Image_Destroy(single);
+		Image_Destroy(job.result);
+	}
+
+	// in place where every step can be, except for shared images
+	Image_ImageHeader const *shared = Image_CreateSharedSnapshot(jobs[0].image);
+	REQUIRE(Image_FastConvertBatch(jobs.data(), jobCount, true, 0));
+	for (size_t j = 0; j < jobCount; ++j) {
+		Image_ConvertJob &job = jobs[j];
+		REQUIRE(job.result);
+		CHECK(job.result->format == job.format);
+		bool const inPlace = j % pairCount == 0 && j != 0;
+		CHECK((job.result == job.image) == inPlace);
+		if (!inPlace) {
+			Image_Destroy(job.result);
+		}
+		Image_Destroy(job.image);
+	}
+	Image_Destroy(shared);
+
+	CHECK(Image_FastConvertBatch(nullptr, 0, true, 0));
+}
+
+TEST_CASE("Batch conversion results of chains (C)", "[Image Convert]") {
+	// a mip chain among lone images, every result carved from one allocation
+	Image_ImageHeader const *chain = CreatePattern(16, 8, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(chain);
+	Image_CreateMipMapChain(chain, true);
+	Image_ImageHeader const *lone = CreatePattern(5, 3, 2, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(lone);
+	Image_ConvertJob jobs[3] = {
+			{lone, TinyImageFormat_R32G32B32A32_SFLOAT, nullptr},
+			{chain, TinyImageFormat_B8G8R8A8_UNORM, nullptr},
+			{lone, TinyImageFormat_B8G8R8A8_UNORM, nullptr},
+	};
+	REQUIRE(Image_FastConvertBatch(jobs, 3, false, 2));
+
+	REQUIRE(jobs[1].result);
+	CHECK(Image_LinkedImageCountOf(jobs[1].result) == Image_LinkedImageCountOf(chain));
+	CHECK(Image_MipMapCountOf(jobs[1].result) == Image_MipMapCountOf(chain));
+	for (size_t i = 0; i < Image_LinkedImageCountOf(chain); ++i) {
+		Image_ImageHeader const *link = Image_LinkedImageOf(jobs[1].result, i);
+		Image_ImageHeader const *single = Image_FastConvert(Image_LinkedImageOf(chain, i), TinyImageFormat_B8G8R8A8_UNORM, false);
+		REQUIRE(single);
+		CHECK(((uintptr_t) Image_RawDataPtr(link) & (Image_DefaultDataAlignment - 1)) == 0);
+		REQUIRE(link->dataSize == single->dataSize);
+		CHECK(memcmp(Image_RawDataPtr(link), Image_RawDataPtr(single), single->dataSize) == 0);
+		Image_Destroy(single);
+	}
+
+	// destroyed in any order, the allocation goes with the last
+	Image_Destroy(jobs[1].result);
+	for (size_t j = 0; j < 3; j += 2) {
+		REQUIRE(jobs[j].result);
+		CHECK(((uintptr_t) Image_RawDataPtr(jobs[j].result) & (Image_DefaultDataAlignment - 1)) == 0);
+		Image_ImageHeader const *single = Image_FastConvert(lone, jobs[j].format, false);
+		REQUIRE(single);
+		CHECK(memcmp(Image_RawDataPtr(jobs[j].result), Image_RawDataPtr(single), single->dataSize) == 0);
+		Image_Destroy(single);
+	}
+	Image_Destroy(jobs[2].result);
+	Image_Destroy(jobs[0].result);
+	Image_Destroy(lone);
+	Image_Destroy(chain);
+}
@@ -0,0 +1,38 @@
+// Image fixtures shared by the test files
+#ifndef WYRD_IMAGE_TEST_HELPERS_HPP
+#define WYRD_IMAGE_TEST_HELPERS_HPP
+
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+
+// every byte of image from an LCG, the same seed gives the same bytes
+inline void FillBytes(Image_ImageHeader const *image, uint32_t seed) {
+	auto ptr = (uint8_t *) Image_RawDataPtr(image);
+	uint32_t state = seed;
+	for (size_t i = 0; i < image->dataSize; ++i) {
+		state = state * 1664525u + 1013904223u;
+		ptr[i] = (uint8_t) (state >> 24);
+	}
+}
+
+// a 2D image (or stack of slices) of a repeating but irregular byte pattern,
+// for R32G32B32A32_SFLOAT floats in 0..1 instead
+inline Image_ImageHeader const *CreatePattern(uint32_t width, uint32_t height, uint32_t slices,
+																							TinyImageFormat format) {
+	Image_ImageHeader const *image = Image_Create(width, height, 1, slices, format);
+	auto ptr = (uint8_t *) Image_RawDataPtr(image);
+	if (format == TinyImageFormat_R32G32B32A32_SFLOAT) {
+		auto fptr = (float *) ptr;
+		for (size_t i = 0; i < image->dataSize / sizeof(float); ++i) {
+			fptr[i] = (float) ((i * 37) % 101) / 100.0f;
+		}
+	} else {
+		for (size_t i = 0; i < image->dataSize; ++i) {
+			ptr[i] = (uint8_t) ((i * 37) ^ (i >> 5));
+		}
+	}
+	return image;
+}
+
+#endif //WYRD_IMAGE_TEST_HELPERS_HPP
@@ -0,0 +1,112 @@
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image/utils.h"
+#include "gfx_image_impl_basic/allocator.h"
+#include "gfx_image_impl_basic/mapped.h"
+#include "gfx_image_impl_basic/normalize.h"
+#include "gfx_image_impl_basic/shared.h"
+#include "gfx_image_impl_basic/stream.h"
+#include "gfx_image_impl_basic/view.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "al2o3_catch2/catch2.hpp"
+#include <cstdio>
+#include <cstring>
+
+TEST_CASE("File mapped images (C)", "[Image Mapped]") {
+	char const *fileName = "image_mapped_test.bin";
+	size_t const offset = Image_MapOffsetAlignment();
+	std::remove(fileName);
+
+	// misaligned offsets and missing files fail cleanly
+	CHECK(Image_CreateMapped(fileName, 0, Image_MM_ReadOnly, 16, 16, 1, 1, TinyImageFormat_R8G8B8A8_UNORM) == nullptr);
+	CHECK(Image_CreateMappedOutput(fileName, offset + 1, 16, 16, 1, 1, TinyImageFormat_R8G8B8A8_UNORM) == nullptr);
+
+	Image_ImageHeader const *output = Image_CreateMappedOutput(fileName, offset, 32, 16, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(output);
+	CHECK(Image_IsMapped(output));
+	CHECK(((uintptr_t) Image_RawDataPtr(output) & (Image_DefaultDataAlignment - 1)) == 0);
+	uint8_t *data = (uint8_t *) Image_RawDataPtr(output);
+	for (uint64_t i = 0; i < output->dataSize; ++i) {
+		data[i] = (uint8_t) (i * 7);
+	}
+	CHECK(Image_FlushMapped(output));
+	Image_Destroy(output);
+
+	// the file is now long enough to read back
+	Image_ImageHeader const *input = Image_CreateMapped(fileName, offset, Image_MM_ReadOnly, 32, 16, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(input);
+	CHECK(input->width == 32);
+	Image_ImageHeader const *copy = Image_CreateMapped(fileName, offset, Image_MM_CopyOnWrite, 32, 16, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(copy);
+	bool same = true;
+	uint8_t const *inData = (uint8_t const *) Image_RawDataPtr(input);
+	for (uint64_t i = 0; i < input->dataSize; ++i) {
+		same = same && inData[i] == (uint8_t) (i * 7);
+	}
+	CHECK(same);
+
+	// copy on write changes never reach the file
+	memset(Image_RawDataPtr(copy), 0, copy->dataSize);
+	CHECK(inData[1] == 7);
+	Image_ImageHeader const *heap = Image_Clone(input);
+	REQUIRE(heap);
+	CHECK(!Image_IsMapped(heap));
+	CHECK(memcmp(Image_RawDataPtr(heap), inData, heap->dataSize) == 0);
+
+	// too big for the file
+	CHECK(Image_CreateMapped(fileName, offset, Image_MM_ReadOnly, 64, 64, 1, 1, TinyImageFormat_R8G8B8A8_UNORM) == nullptr);
+
+	Image_Destroy(heap);
+	Image_Destroy(copy);
+	Image_Destroy(input);
+	std::remove(fileName);
+}
+
+TEST_CASE("Read only mappings refuse writes (C)", "[Image Mapped]") {
+	char const *fileName = "image_mapped_read_only_test.bin";
+	size_t const offset = Image_MapOffsetAlignment();
+	std::remove(fileName);
+	Image_ImageHeader const *output = Image_CreateMappedOutput(fileName, offset, 16, 16, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(output);
+	memset(Image_RawDataPtr(output), 0x40, output->dataSize);
+	Image_Destroy(output);
+
+	Image_ImageHeader const *input = Image_CreateMapped(fileName, offset, Image_MM_ReadOnly, 16, 16, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(input);
+	CHECK(Image_IsReadOnly(input));
+	CHECK_FALSE(Image_IsShared(input));
+	Image_ImageHeader const *other = Image_Create2D(16, 16, TinyImageFormat_R8G8B8A8_UNORM);
+	REQUIRE(other);
+	memset(Image_RawDataPtr(other), 0x80, other->dataSize);
+
+	// every writer refuses rather than faulting on the pages
+	float const pixel[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+	CHECK_FALSE(Image_SetPixelAtF(input, pixel, 0));
+	CHECK_FALSE(Image_TryCopyImage(other, input));
+	CHECK_FALSE(Image_TryCopyRow(other, 0, 0, 0, input, 0, 0, 0));
+	CHECK_FALSE(Image_NormalizeEachChannel(input));
+	Image_View const view = Image_ViewOf(input);
+	Image_View const otherView = Image_ViewOf(other);
+	CHECK(view.readOnly);
+	CHECK_FALSE(Image_ViewCopy(&otherView, &view));
+	Image_StreamSink const sink = Image_StreamSinkOfImage(input);
+	CHECK_FALSE(sink.writeRows(sink.user, 0, 1, Image_RawDataPtr(other)));
+	Image_ImageHeader const *converted = Image_FastConvert(input, TinyImageFormat_B8G8R8A8_UNORM, true);
+	REQUIRE(converted);
+	CHECK(converted != input);
+	Image_Destroy(converted);
+	CHECK(((uint8_t const *) Image_RawDataPtr(input))[0] == 0x40);
+
+	// unsharing gives a writable copy and unmaps the file
+	Image_ImageHeader const *writable = Image_Unshare(input);
+	REQUIRE(writable);
+	CHECK_FALSE(Image_IsMapped(writable));
+	CHECK_FALSE(Image_IsReadOnly(writable));
+	CHECK(Image_SetPixelAtF(writable, pixel, 0));
+	CHECK(((uint8_t const *) Image_RawDataPtr(writable))[1] == 0x40);
+
+	Image_Destroy(writable);
+	Image_Destroy(other);
+	std::remove(fileName);
+}
@@ -0,0 +1,502 @@
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image/utils.h"
+#include "gfx_image_impl_basic/levels.h"
+#include "gfx_image_impl_basic/mipmap.h"
+#include "gfx_image_impl_basic/view.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "test_helpers.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+bool ChainsIdentical(Image_ImageHeader const *a, Image_ImageHeader const *b) {
+	while (a && b) {
+		if (a->width != b->width || a->height != b->height || a->dataSize != b->dataSize) {
+			return false;
+		}
+		if (memcmp(Image_RawDataPtr(a), Image_RawDataPtr(b), a->dataSize) != 0) {
+			return false;
+		}
+		a = a->nextType == Image_NT_None ? nullptr : a->nextImage;
+		b = b->nextType == Image_NT_None ? nullptr : b->nextImage;
+	}
+	return a == nullptr && b == nullptr;
+}
+
+// Mitchell Netravali with B = C = 1/3, the filter of Image_MMF_HighQuality
+float MitchellNetravali(float x) {
+	float const B = 1.0f / 3.0f;
+	float const C = 1.0f / 3.0f;
+	x = std::abs(x);
+	if (x < 1) {
+		return ((12 - 9 * B - 6 * C) * x * x * x + (-18 + 12 * B + 6 * C) * x * x + (6 - 2 * B)) / 6;
+	} else if (x < 2) {
+		return ((-B - 6 * C) * x * x * x + (6 * B + 30 * C) * x * x + (-12 * B - 48 * C) * x + (8 * B + 24 * C)) / 6;
+	}
+	return 0;
+}
+
+// one channel of a high quality level of a float image, evaluated per pixel
+// the way the resampler is specified: 4x4 clamped taps around the scaled
+// position, filtered horizontally then vertically
+float HQReference(Image_ImageHeader const *src, uint32_t channel,
+									uint32_t dstWidth, uint32_t dstHeight, uint32_t x, uint32_t y) {
+	uint32_t const channelCount = TinyImageFormat_ChannelCount(src->format);
+	auto const data = (float const *) Image_RawDataPtr(src);
+	int const srcX = (int) std::floor((float) x * (src->width / (float) dstWidth));
+	int const srcY = (int) std::floor((float) y * (src->height / (float) dstHeight));
+	float const fx = (float) x / (float) dstWidth;
+	float const fy = (float) y / (float) dstHeight;
+
+	float result = 0;
+	for (int j = 0; j < 4; ++j) {
+		int const sy = std::min(std::max(0, srcY + j - 2), (int) src->height - 1);
+		float row = 0;
+		for (int i = 0; i < 4; ++i) {
+			int const sx = std::min(std::max(0, srcX + i - 2), (int) src->width - 1);
+			row += MitchellNetravali(fx + (float) i - 2) * data[(sy * src->width + sx) * channelCount + channel];
+		}
+		result += MitchellNetravali(fy + (float) j - 2) * row;
+	}
+	return result;
+}
+
+} // end anon namespace
+
+TEST_CASE("Mip map chain levels (C)", "[Image MipMap]") {
+	Image_ImageHeader const *image = CreatePattern(64, 16, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	Image_CreateMipMapChain(image, true);
+
+	CHECK(Image_LinkedImageCountOf(image) == 7);
+	uint32_t expectedWidth = 64;
+	uint32_t expectedHeight = 16;
+	for (size_t i = 0; i < Image_LinkedImageCountOf(image); ++i) {
+		Image_ImageHeader const *level = Image_LinkedImageOf(image, i);
+		CHECK(level->width == expectedWidth);
+		CHECK(level->height == expectedHeight);
+		CHECK(level->slices == 1);
+		expectedWidth = expectedWidth > 1 ? expectedWidth / 2 : 1;
+		expectedHeight = expectedHeight > 1 ? expectedHeight / 2 : 1;
+	}
+
+	Image_Destroy(image);
+}
+
+TEST_CASE("Threaded mip map chain matches serial (C)", "[Image MipMap]") {
+	TinyImageFormat const formats[] = {
+			TinyImageFormat_R8G8B8A8_UNORM,
+			TinyImageFormat_R32G32B32A32_SFLOAT,
+	};
+
+	for (auto format : formats) {
+		// a cubemap array sized slices so the bands and slices both get split
+		Image_ImageHeader const *serial = CreatePattern(128, 128, 12, format);
+		Image_ImageHeader const *threaded = Image_Clone(serial);
+
+		Image_MipMapChainDesc desc = {true, 1, Image_MMF_HighQuality};
+		Image_CreateMipMapChainEx(serial, &desc);
+		desc.threadCount = 5;
+		Image_CreateMipMapChainEx(threaded, &desc);
+
+		CHECK(Image_LinkedImageCountOf(threaded) == 8);
+		CHECK(ChainsIdentical(serial, threaded));
+
+		Image_Destroy(serial);
+		Image_Destroy(threaded);
+	}
+}
+
+TEST_CASE("High quality mip map chain matches the filter (C)", "[Image MipMap]") {
+	// float so no encode rounding or clamping gets in the way
+	Image_ImageHeader const *image = CreatePattern(24, 12, 1, TinyImageFormat_R32G32B32A32_SFLOAT);
+	Image_MipMapChainDesc const desc = {true, 1, Image_MMF_HighQuality};
+	Image_CreateMipMapChainEx(image, &desc);
+
+	// 24x12 -> 12x6 -> 6x3 -> 3x1 -> 1x1, every level filtered from the base
+	REQUIRE(Image_LinkedImageCountOf(image) == 5);
+	for (size_t l = 1; l < Image_LinkedImageCountOf(image); ++l) {
+		Image_ImageHeader const *level = Image_LinkedImageOf(image, l);
+		auto const data = (float const *) Image_RawDataPtr(level);
+		for (uint32_t y = 0; y < level->height; ++y) {
+			for (uint32_t x = 0; x < level->width; ++x) {
+				for (uint32_t c = 0; c < 4; ++c) {
+					float const expected = HQReference(image, c, level->width, level->height, x, y);
+					CHECK(data[(y * level->width + x) * 4 + c] == Approx(expected).margin(1e-5f));
+				}
+			}
+		}
+	}
+
+	// the weights sum to 1, so a constant image stays constant
+	Image_ImageHeader const *constant = Image_Create2D(10, 6, TinyImageFormat_R32_SFLOAT);
+	auto cptr = (float *) Image_RawDataPtr(constant);
+	for (size_t i = 0; i < Image_PixelCountOf(constant); ++i) {
+		cptr[i] = 0.375f;
+	}
+	Image_CreateMipMapChainEx(constant, &desc);
+	for (size_t l = 1; l < Image_LinkedImageCountOf(constant); ++l) {
+		Image_ImageHeader const *level = Image_LinkedImageOf(constant, l);
+		auto const data = (float const *) Image_RawDataPtr(level);
+		for (size_t i = 0; i < Image_PixelCountOf(level); ++i) {
+			CHECK(data[i] == Approx(0.375f).margin(1e-6f));
+		}
+	}
+
+	Image_Destroy(constant);
+	Image_Destroy(image);
+}
+
+TEST_CASE("Fast box mip map chain R8G8B8A8 (C)", "[Image MipMap]") {
+	Image_ImageHeader const *image = CreatePattern(32, 8, 2, TinyImageFormat_R8G8B8A8_UNORM);
+	Image_MipMapChainDesc const desc = {true, 1, Image_MMF_FastBox};
+	Image_CreateMipMapChainEx(image, &desc);
+	REQUIRE(Image_LinkedImageCountOf(image) == 6);
+
+	// every level is the rounded 2x2 average of the stored bytes of the one above
+	for (size_t i = 1; i < Image_LinkedImageCountOf(image); ++i) {
+		Image_ImageHeader const *src = Image_LinkedImageOf(image, i - 1);
+		Image_ImageHeader const *dst = Image_LinkedImageOf(image, i);
+		auto sptr = (uint8_t const *) Image_RawDataPtr(src);
+		auto dptr = (uint8_t const *) Image_RawDataPtr(dst);
+		for (uint32_t w = 0; w < dst->slices; ++w) {
+			for (uint32_t y = 0; y < dst->height; ++y) {
+				for (uint32_t x = 0; x < dst->width; ++x) {
+					uint32_t const sx1 = x * 2 + 1 < src->width ? x * 2 + 1 : src->width - 1;
+					uint32_t const sy1 = y * 2 + 1 < src->height ? y * 2 + 1 : src->height - 1;
+					for (uint32_t c = 0; c < 4; ++c) {
+						uint32_t const sum = sptr[Image_CalculateIndex(src, x * 2, y * 2, 0, w) * 4 + c] +
+								sptr[Image_CalculateIndex(src, sx1, y * 2, 0, w) * 4 + c] +
+								sptr[Image_CalculateIndex(src, x * 2, sy1, 0, w) * 4 + c] +
+								sptr[Image_CalculateIndex(src, sx1, sy1, 0, w) * 4 + c];
+						CHECK(dptr[Image_CalculateIndex(dst, x, y, 0, w) * 4 + c] == (sum + 2) / 4);
+					}
+				}
+			}
+		}
+	}
+
+	Image_Destroy(image);
+}
+
+TEST_CASE("Fast box mip map chain of constant images (C)", "[Image MipMap]") {
+	SECTION("R16G16_SNORM") {
+		Image_ImageHeader const *image = Image_Create2D(16, 16, TinyImageFormat_R16G16_SNORM);
+		auto ptr = (int16_t *) Image_RawDataPtr(image);
+		for (size_t i = 0; i < Image_PixelCountOf(image); ++i) {
+			ptr[i * 2 + 0] = -1234;
+			ptr[i * 2 + 1] = 4321;
+		}
+		Image_MipMapChainDesc const desc = {true, 1, Image_MMF_FastBox};
+		Image_CreateMipMapChainEx(image, &desc);
+		auto last = Image_LinkedImageOf(image, Image_LinkedImageCountOf(image) - 1);
+		CHECK(last->width == 1);
+		CHECK(((int16_t const *) Image_RawDataPtr(last))[0] == -1234);
+		CHECK(((int16_t const *) Image_RawDataPtr(last))[1] == 4321);
+		Image_Destroy(image);
+	}
+
+	SECTION("R16G16B16A16_SFLOAT") {
+		Image_ImageHeader const *image = Image_Create2D(16, 4, TinyImageFormat_R16G16B16A16_SFLOAT);
+		for (size_t i = 0; i < Image_PixelCountOf(image); ++i) {
+			float const pixel[4] = {0.25f, -2.0f, 100.0f, 1.0f};
+			Image_SetPixelAtF(image, pixel, i);
+		}
+		Image_MipMapChainDesc const desc = {true, 3, Image_MMF_FastBox};
+		Image_CreateMipMapChainEx(image, &desc);
+		auto last = Image_LinkedImageOf(image, Image_LinkedImageCountOf(image) - 1);
+		float pixel[4];
+		Image_GetPixelAtF(last, pixel, 0);
+		CHECK(pixel[0] == 0.25f);
+		CHECK(pixel[1] == -2.0f);
+		CHECK(pixel[2] == 100.0f);
+		CHECK(pixel[3] == 1.0f);
+		Image_Destroy(image);
+	}
+}
+
+TEST_CASE("Threaded fast box mip map chain matches serial (C)", "[Image MipMap]") {
+	TinyImageFormat const formats[] = {
+			TinyImageFormat_R8G8B8A8_UNORM,
+			TinyImageFormat_R8G8B8A8_SRGB,
+			TinyImageFormat_R32G32B32A32_SFLOAT,
+	};
+
+	for (auto format : formats) {
+		Image_ImageHeader const *serial = CreatePattern(128, 64, 6, format);
+		Image_ImageHeader const *threaded = Image_Clone(serial);
+
+		Image_MipMapChainDesc desc = {true, 1, Image_MMF_FastBox};
+		Image_CreateMipMapChainEx(serial, &desc);
+		desc.threadCount = 7;
+		Image_CreateMipMapChainEx(threaded, &desc);
+
+		CHECK(ChainsIdentical(serial, threaded));
+
+		Image_Destroy(serial);
+		Image_Destroy(threaded);
+	}
+}
+
+TEST_CASE("Non power of 2 mip map chain (C)", "[Image MipMap]") {
+	Image_ImageHeader const *image = Image_Create2D(7, 5, TinyImageFormat_R8_UNORM);
+	auto ptr = (uint8_t *) Image_RawDataPtr(image);
+	for (size_t i = 0; i < Image_PixelCountOf(image); ++i) {
+		ptr[i] = (uint8_t) (i * 7);
+	}
+	Image_MipMapChainDesc const desc = {true, 1, Image_MMF_FastBox};
+	Image_CreateMipMapChainEx(image, &desc);
+
+	// floor halving, 7x5 -> 3x2 -> 1x1
+	REQUIRE(Image_LinkedImageCountOf(image) == 3);
+	Image_ImageHeader const *level1 = Image_LinkedImageOf(image, 1);
+	Image_ImageHeader const *level2 = Image_LinkedImageOf(image, 2);
+	CHECK(level1->width == 3);
+	CHECK(level1->height == 2);
+	CHECK(level2->width == 1);
+	CHECK(level2->height == 1);
+
+	// the odd width uses the 3 tap polyphase box (weights 3-x, 3, x+1 over 7)
+	// and the odd height 5 -> 2 (weights 2-y, 2, y+1 over 5)
+	auto l1 = (uint8_t const *) Image_RawDataPtr(level1);
+	for (uint32_t y = 0; y < 2; ++y) {
+		for (uint32_t x = 0; x < 3; ++x) {
+			uint32_t const wx[3] = {3 - x, 3, x + 1};
+			uint32_t const wy[3] = {2 - y, 2, y + 1};
+			uint64_t sum = 0;
+			for (uint32_t j = 0; j < 3; ++j) {
+				for (uint32_t i = 0; i < 3; ++i) {
+					sum += wx[i] * wy[j] * ptr[(y * 2 + j) * 7 + x * 2 + i];
+				}
+			}
+			CHECK(l1[y * 3 + x] == (sum * 2 + 35) / 70);
+		}
+	}
+
+	Image_Destroy(image);
+}
+
+TEST_CASE("Volume mip map chain (C)", "[Image MipMap]") {
+	Image_MipMapFilter const filters[] = {Image_MMF_HighQuality, Image_MMF_FastBox};
+	for (auto filter : filters) {
+		Image_ImageHeader const *image = Image_Create3D(8, 4, 6, TinyImageFormat_R32_SFLOAT);
+		for (size_t i = 0; i < Image_PixelCountOf(image); ++i) {
+			((float *) Image_RawDataPtr(image))[i] = 0.5f;
+		}
+		Image_MipMapChainDesc const desc = {true, 2, filter};
+		Image_CreateMipMapChainEx(image, &desc);
+
+		// 8x4x6 -> 4x2x3 -> 2x1x1 -> 1x1x1
+		REQUIRE(Image_LinkedImageCountOf(image) == 4);
+		CHECK(Image_LinkedImageOf(image, 1)->depth == 3);
+		CHECK(Image_LinkedImageOf(image, 2)->depth == 1);
+		Image_ImageHeader const *last = Image_LinkedImageOf(image, 3);
+		CHECK(last->width == 1);
+		CHECK(last->height == 1);
+		CHECK(last->depth == 1);
+		if (filter == Image_MMF_FastBox) {
+			CHECK(((float const *) Image_RawDataPtr(last))[0] == Approx(0.5f));
+		}
+		Image_Destroy(image);
+	}
+}
+
+TEST_CASE("sRGB mip map chain filters in linear light (C)", "[Image MipMap]") {
+	Image_MipMapFilter const filters[] = {Image_MMF_HighQuality, Image_MMF_FastBox};
+	for (auto filter : filters) {
+		// 2x2 blocks of every code so each level 1 pixel must round trip its code
+		Image_ImageHeader const *image = Image_Create2D(512, 2, TinyImageFormat_R8G8B8A8_SRGB);
+		auto ptr = (uint8_t *) Image_RawDataPtr(image);
+		for (uint32_t y = 0; y < 2; ++y) {
+			for (uint32_t x = 0; x < 512; ++x) {
+				for (uint32_t c = 0; c < 4; ++c) {
+					ptr[(y * 512 + x) * 4 + c] = (uint8_t) (x / 2);
+				}
+			}
+		}
+		Image_MipMapChainDesc const desc = {true, 2, filter};
+		Image_CreateMipMapChainEx(image, &desc);
+
+		auto level1 = Image_LinkedImageOf(image, 1);
+		auto l1 = (uint8_t const *) Image_RawDataPtr(level1);
+		if (filter == Image_MMF_FastBox) {
+			for (uint32_t x = 0; x < 256; ++x) {
+				CHECK(l1[x * 4 + 0] == x);
+				CHECK(l1[x * 4 + 3] == x);
+			}
+		}
+
+		// the last level of black and white halves is mid grey in linear light
+		// (sRGB code 188) not the gamma space average 128, alpha stays linear
+		auto last = Image_LinkedImageOf(image, Image_LinkedImageCountOf(image) - 1);
+		REQUIRE(last->width == 1);
+		Image_Destroy(image);
+
+		image = Image_Create2D(2, 2, TinyImageFormat_R8G8B8A8_SRGB);
+		ptr = (uint8_t *) Image_RawDataPtr(image);
+		for (uint32_t i = 0; i < 4; ++i) {
+			uint8_t const v = (i & 1) ? 255 : 0;
+			ptr[i * 4 + 0] = ptr[i * 4 + 1] = ptr[i * 4 + 2] = ptr[i * 4 + 3] = v;
+		}
+		Image_CreateMipMapChainEx(image, &desc);
+		if (filter == Image_MMF_FastBox) {
+			auto grey = (uint8_t const *) Image_RawDataPtr(Image_LinkedImageOf(image, 1));
+			CHECK(grey[0] == 188);
+			CHECK(grey[3] == 128);
+		}
+		Image_Destroy(image);
+	}
+}
+
+TEST_CASE("Level directory of linked and packed chains (C)", "[Image MipMap]") {
+	Image_ImageHeader const *image = CreatePattern(40, 24, 2, TinyImageFormat_R8G8B8A8_UNORM);
+	Image_CreateMipMapChain(image, true);
+	size_t const levelCount = Image_LevelCountOf(image);
+	REQUIRE(levelCount == 6);
+	CHECK(Image_LinkedImageCountOf(image) == levelCount);
+	CHECK(Image_MipMapCountOf(image) == levelCount);
+	CHECK(Image_LinkedImageOf(image, levelCount) == nullptr);
+
+	Image_ImageHeader const *packed = Image_PackMipmaps(image);
+	REQUIRE(Image_HasPackedMipMaps(packed));
+	CHECK(Image_LevelCountOf(packed) == levelCount);
+	CHECK(Image_ByteCountOfImageChainOf(packed) == Image_ByteCountOfImageChainOf(image));
+
+	// a link and its packed level have the same place in the packed layout
+	size_t offset = 0;
+	Image_ImageHeader const *link = image;
+	for (size_t i = 0; i < levelCount; ++i, link = link->nextImage) {
+		Image_LevelInfo const linked = Image_LevelInfoOf(image, i);
+		Image_LevelInfo const level = Image_LevelInfoOf(packed, i);
+		CHECK(Image_LinkedImageOf(image, i) == link);
+		CHECK(linked.image == link);
+		CHECK(linked.data == Image_RawDataPtr(link));
+		CHECK(linked.offset == offset);
+		CHECK(linked.byteCount == Image_ByteCountOf(link));
+		CHECK(level.image == packed);
+		CHECK(level.width == link->width);
+		CHECK(level.height == link->height);
+		CHECK(level.offset == offset);
+		CHECK(level.data == ((uint8_t *) Image_RawDataPtr(packed)) + offset);
+		CHECK(memcmp(level.data, linked.data, linked.byteCount) == 0);
+		offset += linked.byteCount;
+	}
+	CHECK(Image_ByteCountOfImageChainOf(image) == offset);
+
+	// relinking the head is picked up, deeper edits need a reset
+	auto head = (Image_ImageHeader *) image;
+	Image_ImageHeader const *rest = head->nextImage;
+	head->nextImage = nullptr;
+	head->nextType = Image_NT_None;
+	CHECK(Image_LinkedImageCountOf(image) == 1);
+	head->nextImage = rest;
+	head->nextType = Image_NT_MipMap;
+	auto second = (Image_ImageHeader *) rest;
+	Image_ImageHeader const *tail = second->nextImage;
+	second->nextImage = nullptr;
+	second->nextType = Image_NT_None;
+	Image_ResetLevelDirectory(image);
+	CHECK(Image_LinkedImageCountOf(image) == 2);
+	CHECK(Image_MipMapCountOf(image) == 2);
+	Image_Destroy(tail);
+
+	Image_Destroy(packed);
+	Image_Destroy(image);
+}
+
+TEST_CASE("Level directory of chains linked by hand (C)", "[Image MipMap]") {
+	// built a link at a time with lookups in between, no directory is kept
+	auto head = (Image_ImageHeader *) Image_Create2D(8, 8, TinyImageFormat_R8G8B8A8_UNORM);
+	auto a = (Image_ImageHeader *) Image_Create2D(4, 4, TinyImageFormat_R8G8B8A8_UNORM);
+	Image_ImageHeader const *b = Image_Create2D(2, 2, TinyImageFormat_R8G8B8A8_UNORM);
+	head->nextImage = a;
+	head->nextType = Image_NT_MipMap;
+	CHECK(Image_LinkedImageCountOf(head) == 2);
+	a->nextImage = (Image_ImageHeader *) b;
+	a->nextType = Image_NT_MipMap;
+	CHECK(Image_LinkedImageCountOf(head) == 3);
+	CHECK(Image_MipMapCountOf(head) == 3);
+	CHECK(Image_LinkedImageOf(head, 2) == b);
+	Image_LevelInfo const info = Image_LevelInfoOf(head, 2);
+	CHECK(info.image == b);
+	CHECK(info.offset == Image_ByteCountOf(head) + Image_ByteCountOf(a));
+	CHECK(Image_LevelInfoOf(head, 3).image == nullptr);
+	Image_Destroy(head);
+
+	// a generated chain extended below its last link is walked again
+	Image_ImageHeader const *image = CreatePattern(4, 4, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	Image_CreateMipMapChain(image, true);
+	REQUIRE(Image_LinkedImageCountOf(image) == 3);
+	auto last = (Image_ImageHeader *) Image_LinkedImageOf(image, 2);
+	Image_ImageHeader const *extra = Image_Create2D(1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	last->nextImage = (Image_ImageHeader *) extra;
+	last->nextType = Image_NT_MipMap;
+	CHECK(Image_LinkedImageCountOf(image) == 4);
+	CHECK(Image_LinkedImageOf(image, 3) == extra);
+	Image_Destroy(image);
+}
+
+TEST_CASE("Level directory of a chain converted in place (C)", "[Image MipMap]") {
+	Image_ImageHeader const *image = CreatePattern(8, 8, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	Image_CreateMipMapChain(image, true);
+	REQUIRE(Image_LevelInfoOf(image, 1).format == TinyImageFormat_R8G8B8A8_UNORM);
+
+	// the links change format but not size, every level reports the new one
+	REQUIRE(Image_FastConvert(image, TinyImageFormat_B8G8R8A8_UNORM, true) == image);
+	for (size_t i = 0; i < Image_LevelCountOf(image); ++i) {
+		Image_ImageHeader const *link = Image_LinkedImageOf(image, i);
+		CHECK(link->format == TinyImageFormat_B8G8R8A8_UNORM);
+		CHECK(Image_LevelInfoOf(image, i).format == TinyImageFormat_B8G8R8A8_UNORM);
+		CHECK(Image_ViewOfMipLevel(image, i).format == TinyImageFormat_B8G8R8A8_UNORM);
+	}
+	Image_Destroy(image);
+}
+
+TEST_CASE("Packed mip maps generated in place match repacked chains (C)", "[Image MipMap]") {
+	Image_MipMapFilter const filters[] = {Image_MMF_HighQuality, Image_MMF_FastBox};
+	TinyImageFormat const formats[] = {TinyImageFormat_R8G8B8A8_UNORM, TinyImageFormat_R32G32B32A32_SFLOAT};
+	for (auto filter : filters) {
+		for (auto format : formats) {
+			// a cubemap array sized stack of slices with odd sizes on the way down
+			Image_ImageHeader const *image = CreatePattern(48, 20, 12, format);
+			Image_MipMapChainDesc const desc = {true, 3, filter};
+			Image_ImageHeader const *packed = Image_CreatePackedMipMapChainEx(image, &desc);
+			REQUIRE(packed);
+			CHECK(Image_HasPackedMipMaps(packed));
+
+			Image_CreateMipMapChainEx(image, &desc);
+			Image_ImageHeader const *repacked = Image_PackMipmaps(image);
+			REQUIRE(packed->packedMipMapCount == repacked->packedMipMapCount);
+			CHECK(packed->dataSize == repacked->dataSize);
+			CHECK(memcmp(Image_RawDataPtr(packed), Image_RawDataPtr(repacked), packed->dataSize) == 0);
+
+			// the level views see the linked levels
+			Image_View const view = Image_ViewOfMipLevel(packed, 3);
+			Image_ImageHeader const *link = Image_LinkedImageOf(image, 3);
+			CHECK(view.width == link->width);
+			CHECK(view.height == link->height);
+			CHECK(memcmp(view.data, Image_RawDataPtr(link), link->dataSize) == 0);
+
+			Image_Destroy(repacked);
+			Image_Destroy(packed);
+			Image_Destroy(image);
+		}
+	}
+
+	// filled by hand then generated
+	Image_ImageHeader const *volume = Image_CreateWithPackedMipMaps(8, 4, 6, 1, TinyImageFormat_R32_SFLOAT);
+	REQUIRE(volume);
+	CHECK(volume->packedMipMapCount == 4);
+	for (size_t i = 0; i < Image_PixelCountOf(volume); ++i) {
+		((float *) Image_RawDataPtr(volume))[i] = 0.5f;
+	}
+	Image_GeneratePackedMipMaps(volume, 2, Image_MMF_FastBox);
+	Image_View const last = Image_ViewOfMipLevel(volume, 3);
+	CHECK(last.width == 1);
+	CHECK(((float const *) last.data)[0] == Approx(0.5f));
+	Image_Destroy(volume);
+}
@@ -0,0 +1,162 @@
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image/utils.h"
+#include "gfx_image_impl_basic/mipmap.h"
+#include "gfx_image_impl_basic/shared.h"
+#include "gfx_image_impl_basic/stream.h"
+#include "gfx_image_impl_basic/view.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "al2o3_catch2/catch2.hpp"
+#include <cstring>
+
+TEST_CASE("Shared snapshots unshare before writing (C)", "[Image Shared]") {
+	Image_ImageHeader const *image = Image_Create2D(16, 16, TinyImageFormat_R8G8B8A8_UNORM);
+	memset(Image_RawDataPtr(image), 0x40, image->dataSize);
+	Image_CreateMipMapChain(image, true);
+	CHECK_FALSE(Image_IsShared(image));
+	CHECK(Image_Unshare(image) == image);
+
+	// headers this library didn't allocate are never shared
+	Image_ImageHeader own;
+	Image_FillHeader(16, 16, 1, 1, TinyImageFormat_R8G8B8A8_UNORM, &own);
+	CHECK_FALSE(Image_IsShared(&own));
+
+	// a snapshot is the same chain
+	Image_ImageHeader const *snapshot = Image_CreateSharedSnapshot(image);
+	CHECK(snapshot == image);
+	CHECK(Image_IsShared(image));
+
+	// writing through the first reference copies the chain, the snapshot keeps
+	// the original pixels
+	Image_ImageHeader const *writable = Image_Unshare(image);
+	REQUIRE(writable);
+	CHECK(writable != snapshot);
+	CHECK_FALSE(Image_IsShared(writable));
+	CHECK_FALSE(Image_IsShared(snapshot));
+	CHECK(Image_LinkedImageCountOf(writable) == Image_LinkedImageCountOf(snapshot));
+	memset(Image_RawDataPtr(writable), 0x80, writable->dataSize);
+	CHECK(((uint8_t const *) Image_RawDataPtr(snapshot))[0] == 0x40);
+	Image_Destroy(writable);
+
+	// in place conversion of a shared image converts a copy
+	Image_ImageHeader const *again = Image_CreateSharedSnapshot(snapshot);
+	Image_ImageHeader const *converted = Image_FastConvert(again, TinyImageFormat_B8G8R8A8_UNORM, true);
+	REQUIRE(converted);
+	CHECK(converted != snapshot);
+	CHECK(snapshot->format == TinyImageFormat_R8G8B8A8_UNORM);
+	Image_Destroy(converted);
+	Image_Destroy(again);
+
+	// each reference is destroyed once, the last one frees the chain
+	CHECK_FALSE(Image_IsShared(snapshot));
+	Image_Destroy(snapshot);
+}
+
+TEST_CASE("Bulk writes to shared images fail (C)", "[Image Shared]") {
+	Image_ImageHeader const *image = Image_Create2D(8, 8, TinyImageFormat_R8G8B8A8_UNORM);
+	memset(Image_RawDataPtr(image), 0x40, image->dataSize);
+	Image_ImageHeader const *other = Image_Create2D(8, 8, TinyImageFormat_R8G8B8A8_UNORM);
+	memset(Image_RawDataPtr(other), 0x80, other->dataSize);
+	Image_ImageHeader const *snapshot = Image_CreateSharedSnapshot(image);
+
+	auto unchanged = [snapshot]() {
+		auto ptr = (uint8_t const *) Image_RawDataPtr(snapshot);
+		for (size_t i = 0; i < snapshot->dataSize; ++i) {
+			if (ptr[i] != 0x40) {
+				return false;
+			}
+		}
+		return true;
+	};
+
+	CHECK_FALSE(Image_TryCopyImage(other, image));
+	CHECK_FALSE(Image_TryCopySlice(other, 0, image, 0));
+	CHECK_FALSE(Image_TryCopyPage(other, 0, 0, image, 0, 0));
+	CHECK_FALSE(Image_TryCopyRow(other, 0, 0, 0, image, 1, 0, 0));
+	CHECK_FALSE(Image_TryCopyPixel(other, 0, 0, 0, 0, image, 2, 2, 0, 0));
+	CHECK_FALSE(Image_NormalizeEachChannel(image));
+	CHECK(unchanged());
+
+	Image_View const view = Image_ViewOf(image);
+	Image_View const otherView = Image_ViewOf(other);
+	CHECK(view.readOnly);
+	CHECK_FALSE(otherView.readOnly);
+	CHECK_FALSE(Image_ViewCopy(&otherView, &view));
+	Image_StreamSink const sink = Image_StreamSinkOfImage(image);
+	CHECK_FALSE(sink.writeRows(sink.user, 0, 1, Image_RawDataPtr(other)));
+	Image_MipMapChainDesc const desc = {true, 1, Image_MMF_FastBox};
+	CHECK_FALSE(Image_CreateMipMapChainEx(image, &desc));
+	CHECK(image->nextImage == nullptr);
+	CHECK(unchanged());
+
+	// writable again once the other reference is gone
+	Image_Destroy(snapshot);
+	CHECK(Image_TryCopyImage(other, image));
+	CHECK(((uint8_t const *) Image_RawDataPtr(image))[0] == 0x80);
+	Image_Destroy(other);
+	Image_Destroy(image);
+}
+
+TEST_CASE("Shared chains refuse bulk writes below the head (C)", "[Image Shared]") {
+	Image_ImageHeader const *image = Image_Create2D(16, 16, TinyImageFormat_R8G8B8A8_UNORM);
+	memset(Image_RawDataPtr(image), 0x40, image->dataSize);
+	Image_CreateMipMapChain(image, true);
+	Image_ImageHeader const *other = Image_Create2D(16, 16, TinyImageFormat_R8G8B8A8_UNORM);
+	memset(Image_RawDataPtr(other), 0x80, other->dataSize);
+	Image_CreateMipMapChain(other, true);
+	Image_ImageHeader const *snapshot = Image_CreateSharedSnapshot(image);
+
+	auto unchanged = [snapshot]() {
+		for (size_t i = 0; i < Image_LinkedImageCountOf(snapshot); ++i) {
+			Image_ImageHeader const *level = Image_LinkedImageOf(snapshot, i);
+			auto ptr = (uint8_t const *) Image_RawDataPtr(level);
+			for (size_t j = 0; j < level->dataSize; ++j) {
+				if (ptr[j] != 0x40) {
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+
+	// every link is shared, not just the head
+	Image_ImageHeader const *level1 = Image_LinkedImageOf(snapshot, 1);
+	REQUIRE(level1);
+	CHECK(Image_IsShared(level1));
+	CHECK_FALSE(Image_TryCopyImageChain(other, snapshot));
+	CHECK_FALSE(Image_TryCopyImage(Image_LinkedImageOf(other, 1), level1));
+	Image_ImageHeader const *converted = Image_FastConvert(level1, TinyImageFormat_B8G8R8A8_UNORM, true);
+	REQUIRE(converted);
+	CHECK(converted != level1);
+	CHECK(level1->format == TinyImageFormat_R8G8B8A8_UNORM);
+	Image_Destroy(converted);
+	CHECK(unchanged());
+
+	// dropping one reference leaves every link alive and writable again
+	Image_Destroy(image);
+	CHECK_FALSE(Image_IsShared(level1));
+	CHECK(Image_TryCopyImage(Image_LinkedImageOf(other, 1), level1));
+	Image_Destroy(other);
+	Image_Destroy(snapshot);
+}
+
+TEST_CASE("Views made before sharing refuse copies (C)", "[Image Shared]") {
+	Image_ImageHeader const *image = Image_Create2D(8, 8, TinyImageFormat_R8G8B8A8_UNORM);
+	memset(Image_RawDataPtr(image), 0x40, image->dataSize);
+	Image_ImageHeader const *other = Image_Create2D(8, 8, TinyImageFormat_R8G8B8A8_UNORM);
+	memset(Image_RawDataPtr(other), 0x80, other->dataSize);
+	Image_View const view = Image_ViewOf(image);
+	Image_View const otherView = Image_ViewOf(other);
+	CHECK_FALSE(view.readOnly);
+
+	Image_ImageHeader const *snapshot = Image_CreateSharedSnapshot(image);
+	CHECK_FALSE(Image_ViewCopy(&otherView, &view));
+	CHECK(((uint8_t const *) Image_RawDataPtr(snapshot))[0] == 0x40);
+
+	Image_Destroy(snapshot);
+	CHECK(Image_ViewCopy(&otherView, &view));
+	CHECK(((uint8_t const *) Image_RawDataPtr(image))[0] == 0x80);
+	Image_Destroy(other);
+	Image_Destroy(image);
+}
@@ -0,0 +1,179 @@
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image/utils.h"
+#include "gfx_image_impl_basic/mipmap.h"
+#include "gfx_image_impl_basic/normalize.h"
+#include "gfx_image_impl_basic/stream.h"
+#include "gfx_image_impl_basic/tiled.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "test_helpers.hpp"
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// one image per level of the chain of image, for the sinks to write into
+std::vector<Image_ImageHeader const *> CloneLevels(Image_ImageHeader const *chain) {
+	std::vector<Image_ImageHeader const *> levels;
+	for (size_t i = 0; i < Image_LinkedImageCountOf(chain); ++i) {
+		Image_ImageHeader const *level = Image_LinkedImageOf(chain, i);
+		levels.push_back(Image_Create(level->width, level->height, 1, 1, level->format));
+	}
+	return levels;
+}
+
+bool FailingRead(void *user, uint32_t firstRow, uint32_t rowCount, void *) {
+	return firstRow + rowCount < *(uint32_t *) user;
+}
+
+} // end anon namespace
+
+TEST_CASE("Streamed convert and mip maps match whole image (C)", "[Image Stream]") {
+	uint32_t const sizes[][2] = {{64, 48}, {37, 29}, {1, 13}, {19, 1}};
+	uint32_t const bandHeights[] = {1, 3, 0};
+	for (auto const &size : sizes) {
+		Image_ImageHeader const *src = CreatePattern(size[0], size[1], 1, TinyImageFormat_R8G8B8A8_UNORM);
+		Image_ImageHeader const *expected = Image_PreciseConvert(src, TinyImageFormat_R16G16B16A16_UNORM);
+		Image_MipMapChainDesc const mipDesc = {true, 1, Image_MMF_FastBox};
+		Image_CreateMipMapChainEx(expected, &mipDesc);
+
+		for (uint32_t bandHeight : bandHeights) {
+			std::vector<Image_ImageHeader const *> levels = CloneLevels(expected);
+			std::vector<Image_StreamSink> sinks;
+			for (Image_ImageHeader const *level : levels) {
+				sinks.push_back(Image_StreamSinkOfImage(level));
+			}
+			Image_StreamSource const source = Image_StreamSourceOfImage(src);
+			Image_StreamDesc desc{};
+			desc.bandHeight = bandHeight;
+			desc.threadCount = bandHeight == 0 ? 0 : 1;
+			desc.outputFormat = TinyImageFormat_R16G16B16A16_UNORM;
+			REQUIRE(Image_StreamProcess(&source, sinks.data(), (uint32_t) sinks.size(), &desc));
+
+			for (size_t i = 0; i < levels.size(); ++i) {
+				Image_ImageHeader const *level = Image_LinkedImageOf(expected, i);
+				CHECK(memcmp(Image_RawDataPtr(levels[i]), Image_RawDataPtr(level), level->dataSize) == 0);
+				Image_Destroy(levels[i]);
+			}
+		}
+		Image_Destroy(expected);
+		Image_Destroy(src);
+	}
+}
+
+TEST_CASE("Streamed color range and normalise (C)", "[Image Stream]") {
+	Image_ImageHeader const *src = CreatePattern(33, 70, 1, TinyImageFormat_R16G16_UNORM);
+	Image_StreamSource const source = Image_StreamSourceOfImage(src);
+	Image_StreamDesc desc{};
+	desc.bandHeight = 16;
+	desc.threadCount = 2;
+	desc.outputFormat = TinyImageFormat_R32G32_SFLOAT;
+
+	// channels the format doesn't have are left alone
+	Image_PixelD streamMin = {0.0, 0.0, -5.0, -5.0};
+	Image_PixelD streamMax = {0.0, 0.0, 5.0, 5.0};
+	Image_PixelD expectedMin, expectedMax;
+	REQUIRE(Image_StreamColorRange(&source, &desc, &streamMin, &streamMax));
+	REQUIRE(Image_GetColorRangeOf(src, &expectedMin, &expectedMax));
+	CHECK(streamMin.r == expectedMin.r);
+	CHECK(streamMin.g == expectedMin.g);
+	CHECK(streamMax.r == expectedMax.r);
+	CHECK(streamMax.g == expectedMax.g);
+	CHECK(streamMin.b == -5.0);
+	CHECK(streamMax.a == 5.0);
+
+	Image_ImageHeader const *expected = Image_PreciseConvert(src, TinyImageFormat_R32G32_SFLOAT);
+	Image_NormalizeDesc const normalizeDesc = {1, true, streamMin, streamMax};
+	Image_NormalizeEachChannelEx(expected, &normalizeDesc);
+
+	Image_ImageHeader const *out = Image_Create(33, 70, 1, 1, TinyImageFormat_R32G32_SFLOAT);
+	Image_StreamSink const sink = Image_StreamSinkOfImage(out);
+	desc.normalize = true;
+	desc.rangeMin = streamMin;
+	desc.rangeMax = streamMax;
+	REQUIRE(Image_StreamProcess(&source, &sink, 1, &desc));
+	CHECK(memcmp(Image_RawDataPtr(out), Image_RawDataPtr(expected), out->dataSize) == 0);
+
+	Image_Destroy(out);
+	Image_Destroy(expected);
+	Image_Destroy(src);
+}
+
+TEST_CASE("Failing stream source aborts (C)", "[Image Stream]") {
+	uint32_t failAt = 40;
+	Image_StreamSource source{};
+	source.width = 8;
+	source.height = 64;
+	source.format = TinyImageFormat_R8_UNORM;
+	source.readRows = &FailingRead;
+	source.user = &failAt;
+	Image_StreamSink const sinks[2] = {{nullptr, nullptr}, {nullptr, nullptr}};
+	Image_StreamDesc desc{};
+	desc.bandHeight = 8;
+	CHECK_FALSE(Image_StreamProcess(&source, sinks, 2, &desc));
+	Image_PixelD pmin, pmax;
+	CHECK_FALSE(Image_StreamColorRange(&source, &desc, &pmin, &pmax));
+}
+
+TEST_CASE("Streams of tiled images fail (C)", "[Image Stream]") {
+	Image_ImageHeader const *src = CreatePattern(16, 16, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	Image_ImageHeader const *tiled = Image_CloneTiled(src);
+	REQUIRE(Image_IsTiled(tiled));
+	Image_StreamDesc desc{};
+	desc.bandHeight = 8;
+
+	Image_StreamSource const tiledSource = Image_StreamSourceOfImage(tiled);
+	Image_StreamSink const discard = {nullptr, nullptr};
+	CHECK_FALSE(Image_StreamProcess(&tiledSource, &discard, 1, &desc));
+
+	Image_StreamSource const source = Image_StreamSourceOfImage(src);
+	Image_StreamSink const tiledSink = Image_StreamSinkOfImage(tiled);
+	CHECK_FALSE(Image_StreamProcess(&source, &tiledSink, 1, &desc));
+
+	Image_Destroy(tiled);
+	Image_Destroy(src);
+}
+
+TEST_CASE("Streams to formats that can't be processed fail (C)", "[Image Stream]") {
+	Image_ImageHeader const *src = CreatePattern(16, 16, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	Image_StreamSource const source = Image_StreamSourceOfImage(src);
+	Image_StreamSink const discard[2] = {{nullptr, nullptr}, {nullptr, nullptr}};
+	Image_StreamDesc desc{};
+	desc.bandHeight = 8;
+
+	// block formats can't be normalised or box filtered
+	desc.outputFormat = TinyImageFormat_DXBC1_RGB_UNORM;
+	desc.normalize = true;
+	CHECK_FALSE(Image_StreamProcess(&source, discard, 1, &desc));
+	desc.normalize = false;
+	CHECK_FALSE(Image_StreamProcess(&source, discard, 2, &desc));
+
+	// the same stream to a plain format works
+	desc.outputFormat = TinyImageFormat_R32G32B32A32_SFLOAT;
+	desc.normalize = true;
+	desc.rangeMax = {1.0, 1.0, 1.0, 1.0};
+	CHECK(Image_StreamProcess(&source, discard, 2, &desc));
+	Image_Destroy(src);
+}
+
+TEST_CASE("Streams of multi page images don't filter across pages (C)", "[Image Stream]") {
+	Image_ImageHeader const *src = CreatePattern(16, 16, 4, TinyImageFormat_R8G8B8A8_UNORM);
+	Image_StreamSource const source = Image_StreamSourceOfImage(src);
+	CHECK(source.height == 64);
+	Image_StreamSink const discard[2] = {{nullptr, nullptr}, {nullptr, nullptr}};
+	Image_StreamDesc desc{};
+	desc.bandHeight = 8;
+
+	// mip levels would blend rows of neighbouring slices
+	CHECK_FALSE(Image_StreamProcess(&source, discard, 2, &desc));
+
+	// just converting every page is fine
+	Image_ImageHeader const *out = Image_Create(16, 16, 1, 4, TinyImageFormat_R8G8B8A8_UNORM);
+	Image_StreamSink const sink = Image_StreamSinkOfImage(out);
+	REQUIRE(Image_StreamProcess(&source, &sink, 1, &desc));
+	CHECK(memcmp(Image_RawDataPtr(out), Image_RawDataPtr(src), out->dataSize) == 0);
+	Image_Destroy(out);
+	Image_Destroy(src);
+}
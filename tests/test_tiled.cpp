@@ -0,0 +1,176 @@
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image/utils.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "gfx_image_impl_basic/mipmap.h"
+#include "gfx_image_impl_basic/tiled.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "test_helpers.hpp"
+#include <cstring>
+
+namespace {
+
+// every pixel of a and b decode the same, whatever their layouts
+bool SamePixels(Image_ImageHeader const *a, Image_ImageHeader const *b) {
+	for (uint32_t w = 0; w < a->slices; ++w) {
+		for (uint32_t y = 0; y < a->height; ++y) {
+			for (uint32_t x = 0; x < a->width; ++x) {
+				double pa[4] = {0, 0, 0, 0};
+				double pb[4] = {0, 0, 0, 0};
+				Image_GetPixelAtD(a, pa, Image_CalculateLayoutIndex(a, x, y, 0, w));
+				Image_GetPixelAtD(b, pb, Image_CalculateLayoutIndex(b, x, y, 0, w));
+				if (memcmp(pa, pb, sizeof(pa)) != 0) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+bool SameBytes(Image_ImageHeader const *a, Image_ImageHeader const *b) {
+	return a->dataSize == b->dataSize && memcmp(Image_RawDataPtr(a), Image_RawDataPtr(b), a->dataSize) == 0;
+}
+
+} // end anon namespace
+
+TEST_CASE("Tiled round trip (C)", "[Image Tiled]") {
+	TinyImageFormat const formats[] = {
+			TinyImageFormat_R8_UNORM, TinyImageFormat_R8G8B8_UNORM, TinyImageFormat_R8G8B8A8_UNORM,
+			TinyImageFormat_R32G32B32_SFLOAT, TinyImageFormat_R32G32B32A32_SFLOAT,
+	};
+	for (TinyImageFormat format : formats) {
+		Image_ImageHeader const *image = Image_Create(32, 24, 1, 2, format);
+		FillBytes(image, 3);
+		REQUIRE(Image_CanBeTiled(image));
+		CHECK_FALSE(Image_IsTiled(image));
+
+		Image_ImageHeader const *tiled = Image_CloneTiled(image);
+		REQUIRE(tiled);
+		CHECK(Image_IsTiled(tiled));
+		CHECK(tiled->dataSize == image->dataSize);
+		CHECK_FALSE(SameBytes(tiled, image));
+		CHECK(SamePixels(tiled, image));
+
+		// the first 2x2 footprint is the first 4 pixels
+		size_t const pixelSize = TinyImageFormat_BitSizeOfBlock(format) / 8;
+		CHECK(Image_CalculateLayoutIndex(tiled, 1, 0, 0, 0) == 1);
+		CHECK(Image_CalculateLayoutIndex(tiled, 0, 1, 0, 0) == 2);
+		CHECK(Image_CalculateLayoutIndex(tiled, 1, 1, 0, 0) == 3);
+		CHECK(Image_CalculateLayoutIndex(tiled, 8, 0, 0, 0) == 64);
+		CHECK(Image_CalculateLayoutIndex(tiled, 0, 8, 0, 1) == 32 * 24 + 4 * 64);
+		CHECK(memcmp(((uint8_t *) Image_RawDataPtr(tiled)) + 2 * pixelSize,
+								 ((uint8_t *) Image_RawDataPtr(image)) + 32 * pixelSize, pixelSize) == 0);
+
+		Image_ImageHeader const *clone = Image_Clone(tiled);
+		CHECK(Image_IsTiled(clone));
+		CHECK(SameBytes(clone, tiled));
+
+		Image_ImageHeader const *linear = Image_CloneLinear(tiled);
+		REQUIRE(linear);
+		CHECK_FALSE(Image_IsTiled(linear));
+		CHECK(SameBytes(linear, image));
+
+		Image_Destroy(linear);
+		Image_Destroy(clone);
+		Image_Destroy(tiled);
+		Image_Destroy(image);
+	}
+
+	// only 2D images of whole tiles
+	Image_ImageHeader const *odd = Image_Create(12, 8, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	Image_ImageHeader const *volume = Image_Create(8, 8, 2, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	CHECK_FALSE(Image_CanBeTiled(odd));
+	CHECK_FALSE(Image_CanBeTiled(volume));
+	Image_ImageHeader const *oddClone = Image_CloneTiled(odd);
+	CHECK_FALSE(Image_IsTiled(oddClone));
+	Image_Destroy(oddClone);
+	Image_Destroy(volume);
+	Image_Destroy(odd);
+}
+
+TEST_CASE("Tiled copies across layouts and formats (C)", "[Image Tiled]") {
+	Image_ImageHeader const *image = Image_Create(24, 16, 1, 3, TinyImageFormat_R8G8B8A8_UNORM);
+	FillBytes(image, 7);
+
+	auto wide = (Image_ImageHeader *) Image_Create(24, 16, 1, 3, TinyImageFormat_R16G16B16A16_UNORM);
+	wide->flags |= Image_Flag_Tiled;
+	Image_CopyImage(image, wide);
+	CHECK(SamePixels(wide, image));
+
+	// back to linear in another format and back into a tiled slice
+	Image_ImageHeader const *bgra = Image_PreciseConvert(wide, TinyImageFormat_B8G8R8A8_UNORM);
+	CHECK(Image_IsTiled(bgra));
+	CHECK(SamePixels(bgra, image));
+	Image_ImageHeader const *back = Image_Create(24, 16, 1, 3, TinyImageFormat_R8G8B8A8_UNORM);
+	Image_CopyImage(bgra, back);
+	CHECK(SameBytes(back, image));
+
+	auto slices = (Image_ImageHeader *) Image_Create(24, 16, 1, 3, TinyImageFormat_R8G8B8A8_UNORM);
+	slices->flags |= Image_Flag_Tiled;
+	for (uint32_t w = 0; w < 3; ++w) {
+		Image_CopySlice(image, w, slices, w);
+	}
+	CHECK(SamePixels(slices, image));
+
+	// rows and pixels go through the layout index
+	Image_ImageHeader const *rows = Image_Create(24, 16, 1, 3, TinyImageFormat_R8G8B8A8_UNORM);
+	for (uint32_t w = 0; w < 3; ++w) {
+		for (uint32_t y = 0; y < 16; ++y) {
+			Image_CopyRow(slices, y, 0, w, rows, y, 0, w);
+		}
+	}
+	CHECK(SameBytes(rows, image));
+
+	Image_Destroy(rows);
+	Image_Destroy(slices);
+	Image_Destroy(back);
+	Image_Destroy(bgra);
+	Image_Destroy(wide);
+	Image_Destroy(image);
+}
+
+TEST_CASE("Tiled mip maps match linear ones (C)", "[Image Tiled]") {
+	TinyImageFormat const formats[] = {
+			TinyImageFormat_R8G8B8A8_UNORM, TinyImageFormat_R8G8B8A8_SRGB, TinyImageFormat_R16G16_SINT,
+			TinyImageFormat_R16G16B16A16_SFLOAT, TinyImageFormat_R32_SFLOAT,
+	};
+	Image_MipMapFilter const filters[] = {Image_MMF_FastBox, Image_MMF_HighQuality};
+	for (TinyImageFormat format : formats) {
+		for (Image_MipMapFilter filter : filters) {
+			Image_ImageHeader const *linear = Image_Create(64, 32, 1, 2, format);
+			FillBytes(linear, 5);
+			if (format == TinyImageFormat_R16G16B16A16_SFLOAT || format == TinyImageFormat_R32_SFLOAT) {
+				// keep the floats finite
+				Image_ImageHeader const *unorm = Image_Create(64, 32, 1, 2, TinyImageFormat_R8G8B8A8_UNORM);
+				FillBytes(unorm, 5);
+				Image_Destroy(linear);
+				linear = Image_PreciseConvert(unorm, format);
+				Image_Destroy(unorm);
+			}
+			Image_ImageHeader const *tiled = Image_CloneTiled(linear);
+
+			Image_MipMapChainDesc const desc = {true, 2, filter};
+			Image_CreateMipMapChainEx(linear, &desc);
+			Image_CreateMipMapChainEx(tiled, &desc);
+			REQUIRE(Image_LinkedImageCountOf(tiled) == Image_LinkedImageCountOf(linear));
+
+			// 32x16 and 16x8 stay tiled, 8x4 and below can't be
+			CHECK(Image_IsTiled(Image_LinkedImageOf(tiled, 1)));
+			CHECK(Image_IsTiled(Image_LinkedImageOf(tiled, 2)));
+			CHECK_FALSE(Image_IsTiled(Image_LinkedImageOf(tiled, 3)));
+
+			Image_ImageHeader const *untiled = Image_CloneLinear(tiled);
+			bool same = true;
+			for (size_t i = 0; i < Image_LinkedImageCountOf(linear); ++i) {
+				same = same && SameBytes(Image_LinkedImageOf(untiled, i), Image_LinkedImageOf(linear, i));
+			}
+			CHECK(same);
+
+			Image_Destroy(untiled);
+			Image_Destroy(tiled);
+			Image_Destroy(linear);
+		}
+	}
+}
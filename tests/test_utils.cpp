@@ -0,0 +1,341 @@
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image/utils.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "tiny_imageformat/tinyimageformat_query.h"
+#include "gfx_image_impl_basic/normalize.h"
+#include "gfx_image_impl_basic/range.h"
+#include "gfx_image_impl_basic/statistics.h"
+#include "gfx_image_impl_basic/tiled.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// the pixel at a time range the fast paths must match
+void ReferenceColorRange(Image_ImageHeader const *image, double *omin, double *omax) {
+	uint32_t const channelCount = TinyImageFormat_ChannelCount(image->format);
+	for (uint32_t i = 0u; i < channelCount; ++i) {
+		omin[i] = TinyImageFormat_Max(image->format, (TinyImageFormat_LogicalChannel) i);
+		omax[i] = TinyImageFormat_Min(image->format, (TinyImageFormat_LogicalChannel) i);
+	}
+	for (size_t p = 0; p < Image_PixelCountOf(image); ++p) {
+		double data[4];
+		Image_GetPixelAtD(image, data, p);
+		for (uint32_t i = 0u; i < channelCount; ++i) {
+			if (data[i] < omin[i]) {
+				omin[i] = data[i];
+			}
+			if (data[i] > omax[i]) {
+				omax[i] = data[i];
+			}
+		}
+	}
+}
+
+} // end anon namespace
+
+TEST_CASE("Color range matches per pixel decode (C)", "[Image Utils]") {
+	TinyImageFormat const formats[] = {
+			TinyImageFormat_R8_UNORM,
+			TinyImageFormat_R8G8B8_UNORM,
+			TinyImageFormat_B8G8R8A8_UNORM,
+			TinyImageFormat_R8G8B8A8_SNORM,
+			TinyImageFormat_R8G8B8A8_SRGB,
+			TinyImageFormat_R8G8B8A8_SINT,
+			TinyImageFormat_R16G16_UINT,
+			TinyImageFormat_R16G16B16_SNORM,
+			TinyImageFormat_R16G16B16A16_SINT,
+			TinyImageFormat_R16_SFLOAT,
+			TinyImageFormat_R16G16B16A16_SFLOAT,
+			TinyImageFormat_R32_SINT,
+			TinyImageFormat_R32G32B32_SFLOAT,
+			TinyImageFormat_R32G32B32A32_UINT,
+			TinyImageFormat_R64G64_SFLOAT,
+			TinyImageFormat_R64_SINT,
+	};
+
+	for (auto format : formats) {
+		// odd sizes so every vector loop has a tail
+		Image_ImageHeader const *image = Image_Create(61, 7, 3, 2, format);
+		REQUIRE(image);
+		FillBytes(image, (uint32_t) format);
+
+		Image_PixelD pmin, pmax;
+		double rmin[4], rmax[4];
+		REQUIRE(Image_GetColorRangeOf(image, &pmin, &pmax));
+		ReferenceColorRange(image, rmin, rmax);
+		INFO("format " << TinyImageFormat_Name(format));
+		for (uint32_t i = 0u; i < TinyImageFormat_ChannelCount(format); ++i) {
+			CHECK((&pmin.r)[i] == rmin[i]);
+			CHECK((&pmax.r)[i] == rmax[i]);
+		}
+		Image_Destroy(image);
+	}
+}
+
+TEST_CASE("Color range of large images split across tasks (C)", "[Image Utils]") {
+	Image_ImageHeader const *image = Image_Create2D(1024, 1100, TinyImageFormat_R16G16B16A16_UNORM);
+	REQUIRE(image);
+	auto ptr = (uint16_t *) Image_RawDataPtr(image);
+	for (size_t i = 0; i < Image_PixelCountOf(image) * 4; ++i) {
+		ptr[i] = 1000;
+	}
+	// extremes near the end so only a later task sees them
+	ptr[Image_PixelCountOf(image) * 4 - 2] = 10;
+	ptr[Image_PixelCountOf(image) * 4 - 7] = 60000;
+
+	Image_PixelD pmin, pmax;
+	REQUIRE(Image_GetColorRangeOfEx(image, 4, &pmin, &pmax));
+	CHECK(pmin.r == Approx(1000.0 / 65535.0));
+	CHECK(pmin.g == Approx(1000.0 / 65535.0));
+	CHECK(pmin.b == Approx(10.0 / 65535.0));
+	CHECK(pmax.g == Approx(60000.0 / 65535.0));
+	CHECK(pmax.b == Approx(1000.0 / 65535.0));
+
+	// the same on the calling thread alone
+	Image_PixelD smin, smax;
+	REQUIRE(Image_GetColorRangeOf(image, &smin, &smax));
+	CHECK(memcmp(&smin, &pmin, sizeof(pmin)) == 0);
+	CHECK(memcmp(&smax, &pmax, sizeof(pmax)) == 0);
+
+	double dmin, dmax;
+	REQUIRE(Image_GetColorRangeOfD(image, &dmin, &dmax));
+	CHECK(dmin == Approx(10.0 / 65535.0));
+	CHECK(dmax == Approx(60000.0 / 65535.0));
+	Image_Destroy(image);
+}
+
+TEST_CASE("Normalize each channel matches per pixel (C)", "[Image Utils]") {
+	TinyImageFormat const formats[] = {
+			TinyImageFormat_R32_SFLOAT,
+			TinyImageFormat_R32G32B32_SFLOAT,
+			TinyImageFormat_R32G32B32A32_SFLOAT,
+			TinyImageFormat_R64G64_SFLOAT,
+			TinyImageFormat_R16G16B16A16_SFLOAT,
+			TinyImageFormat_R16G16_UNORM,
+	};
+
+	for (auto format : formats) {
+		INFO("format " << TinyImageFormat_Name(format));
+		Image_ImageHeader const *image = Image_Create(37, 9, 1, 2, format);
+		REQUIRE(image);
+		for (size_t p = 0; p < Image_PixelCountOf(image); ++p) {
+			double const pixel[4] = {(double) (p % 17) - 3.0, (double) (p % 5) * 0.25, (double) (p % 11), 0.5 + (p % 3)};
+			Image_SetPixelAtD(image, pixel, p);
+		}
+
+		double rmin[4], rmax[4];
+		ReferenceColorRange(image, rmin, rmax);
+		Image_ImageHeader const *expected = Image_Clone(image);
+		for (size_t p = 0; p < Image_PixelCountOf(image); ++p) {
+			double pixel[4];
+			Image_GetPixelAtD(expected, pixel, p);
+			for (uint32_t i = 0u; i < TinyImageFormat_ChannelCount(format); ++i) {
+				double const s = 1.0 / (rmax[i] - rmin[i]);
+				pixel[i] = pixel[i] * s + -rmin[i] * s;
+			}
+			Image_SetPixelAtD(expected, pixel, p);
+		}
+
+		REQUIRE(Image_NormalizeEachChannel(image));
+		CHECK(memcmp(Image_RawDataPtr(image), Image_RawDataPtr(expected), image->dataSize) == 0);
+		Image_Destroy(image);
+		Image_Destroy(expected);
+	}
+}
+
+TEST_CASE("Normalize threaded and with a given range (C)", "[Image Utils]") {
+	Image_ImageHeader const *serial = Image_Create2D(1024, 300, TinyImageFormat_R32_SFLOAT);
+	REQUIRE(serial);
+	auto ptr = (float *) Image_RawDataPtr(serial);
+	for (size_t i = 0; i < Image_PixelCountOf(serial); ++i) {
+		ptr[i] = (float) ((i * 7919) % 1000) * 0.5f - 100.0f;
+	}
+	Image_ImageHeader const *threaded = Image_Clone(serial);
+	Image_ImageHeader const *given = Image_Clone(serial);
+
+	REQUIRE(Image_NormalizeAcrossChannels(serial));
+	CHECK(ptr[0] >= 0.0f);
+
+	Image_NormalizeDesc desc = {};
+	desc.threadCount = 4;
+	REQUIRE(Image_NormalizeAcrossChannelsEx(threaded, &desc));
+	CHECK(memcmp(Image_RawDataPtr(serial), Image_RawDataPtr(threaded), serial->dataSize) == 0);
+
+	// the range is used as is, not rescanned
+	desc.useRange = true;
+	desc.rangeMin.r = -100.0;
+	desc.rangeMax.r = 399.5;
+	REQUIRE(Image_NormalizeEachChannelEx(given, &desc));
+	CHECK(memcmp(Image_RawDataPtr(serial), Image_RawDataPtr(given), serial->dataSize) == 0);
+
+	desc.rangeMin.r = 0.0;
+	desc.rangeMax.r = 2.0;
+	REQUIRE(Image_NormalizeEachChannelEx(given, &desc));
+	auto gptr = (float const *) Image_RawDataPtr(given);
+	auto sptr = (float const *) Image_RawDataPtr(serial);
+	CHECK(gptr[10] == (float) (sptr[10] * 0.5));
+
+	Image_Destroy(serial);
+	Image_Destroy(threaded);
+	Image_Destroy(given);
+}
+
+namespace {
+
+bool StatisticsIdentical(Image_Statistics const *a, Image_Statistics const *b) {
+	if (a->binCount != b->binCount || memcmp(a->channel, b->channel, sizeof(a->channel)) != 0) {
+		return false;
+	}
+	return memcmp(Image_StatisticsHistogramOf(a, 0), Image_StatisticsHistogramOf(b, 0),
+								sizeof(uint64_t) * 4 * a->binCount) == 0;
+}
+
+void CheckAgainstPixels(Image_ImageHeader const *image, Image_Statistics const *stats) {
+	for (uint32_t i = 0u; i < TinyImageFormat_ChannelCount(image->format); ++i) {
+		double sum = 0.0;
+		uint64_t count = 0;
+		double mn = INFINITY, mx = -INFINITY;
+		for (size_t p = 0; p < Image_PixelCountOf(image); ++p) {
+			double pixel[4];
+			Image_GetPixelAtD(image, pixel, p);
+			if (std::isnan(pixel[i])) {
+				continue;
+			}
+			sum += pixel[i];
+			mn = pixel[i] < mn ? pixel[i] : mn;
+			mx = pixel[i] > mx ? pixel[i] : mx;
+			count++;
+		}
+		double const mean = sum / (double) count;
+		double m2 = 0.0;
+		for (size_t p = 0; p < Image_PixelCountOf(image); ++p) {
+			double pixel[4];
+			Image_GetPixelAtD(image, pixel, p);
+			if (!std::isnan(pixel[i])) {
+				m2 += (pixel[i] - mean) * (pixel[i] - mean);
+			}
+		}
+
+		Image_ChannelStatistics const &channel = stats->channel[i];
+		CHECK(channel.count == count);
+		CHECK(channel.min == mn);
+		CHECK(channel.max == mx);
+		CHECK(channel.mean == Approx(mean).epsilon(1e-9));
+		CHECK(channel.variance == Approx(m2 / (double) count).epsilon(1e-9));
+
+		uint64_t binned = 0;
+		uint64_t const *histogram = Image_StatisticsHistogramOf(stats, i);
+		for (uint32_t b = 0; b < stats->binCount; ++b) {
+			binned += histogram[b];
+		}
+		CHECK(binned == count);
+	}
+}
+
+} // end anon namespace
+
+TEST_CASE("Statistics match per pixel decode (C)", "[Image Utils]") {
+	TinyImageFormat const formats[] = {
+			TinyImageFormat_R8G8B8A8_UNORM,
+			TinyImageFormat_B8G8R8_SRGB,
+			TinyImageFormat_R8_SNORM,
+			TinyImageFormat_R16G16B16A16_SFLOAT,
+			TinyImageFormat_R32G32B32_SFLOAT,
+			TinyImageFormat_R16G16_UNORM,
+			TinyImageFormat_R64_SFLOAT,
+	};
+
+	for (auto format : formats) {
+		INFO("format " << TinyImageFormat_Name(format));
+		Image_ImageHeader const *image = Image_Create(301, 290, 1, 2, format);
+		REQUIRE(image);
+		FillBytes(image, (uint32_t) format + 11);
+		if (TinyImageFormat_IsFloat(format)) {
+			// random bits give infinities and huge values, keep them sane
+			for (size_t p = 0; p < Image_PixelCountOf(image); ++p) {
+				double const pixel[4] = {std::sin((double) p) * 100.0, (double) (p % 1000) * 0.01, std::cos(p * 0.1), (p % 7) ? 1.0 : NAN};
+				Image_SetPixelAtD(image, pixel, p);
+			}
+		}
+
+		Image_StatisticsDesc desc = {};
+		desc.threadCount = 1;
+		desc.binCount = 64;
+		Image_Statistics const *serial = Image_ComputeStatistics(image, &desc);
+		REQUIRE(serial);
+		CheckAgainstPixels(image, serial);
+
+		desc.threadCount = 5;
+		Image_Statistics const *threaded = Image_ComputeStatistics(image, &desc);
+		REQUIRE(threaded);
+		CHECK(StatisticsIdentical(serial, threaded));
+
+		Image_DestroyStatistics(serial);
+		Image_DestroyStatistics(threaded);
+		Image_Destroy(image);
+	}
+}
+
+TEST_CASE("Statistics percentiles from the histogram (C)", "[Image Utils]") {
+	Image_ImageHeader const *image = Image_Create2D(1000, 1, TinyImageFormat_R32_SFLOAT);
+	REQUIRE(image);
+	auto ptr = (float *) Image_RawDataPtr(image);
+	for (uint32_t i = 0; i < 1000; ++i) {
+		ptr[i] = (float) ((i * 337) % 1000);
+	}
+
+	Image_StatisticsDesc desc = {};
+	desc.binCount = 1000;
+	desc.useRange = true;
+	desc.rangeMin.r = 0.0;
+	desc.rangeMax.r = 1000.0;
+	Image_Statistics const *stats = Image_ComputeStatistics(image, &desc);
+	REQUIRE(stats);
+	CHECK(stats->channel[0].histogramMin == 0.0);
+	CHECK(stats->channel[0].histogramMax == 1000.0);
+	CHECK(stats->channel[0].mean == Approx(499.5));
+	CHECK(Image_StatisticsPercentile(stats, 0, 0.0) == 0.0);
+	CHECK(Image_StatisticsPercentile(stats, 0, 50.0) == Approx(500.0));
+	CHECK(Image_StatisticsPercentile(stats, 0, 90.0) == Approx(900.0));
+	CHECK(Image_StatisticsPercentile(stats, 0, 100.0) == 999.0);
+	for (uint32_t b = 0; b < 1000; ++b) {
+		CHECK(Image_StatisticsHistogramOf(stats, 0)[b] == 1);
+	}
+	// channels the format doesn't have are empty
+	CHECK(stats->channel[1].count == 0);
+	Image_DestroyStatistics(stats);
+	Image_Destroy(image);
+}
+
+TEST_CASE("Statistics of empty views (C)", "[Image Utils]") {
+	Image_ImageHeader const *image = Image_Create2D(64, 64, TinyImageFormat_R16G16B16A16_UNORM);
+	REQUIRE(image);
+	FillBytes(image, 3);
+	Image_ImageHeader const *tiled = Image_CloneTiled(image);
+	REQUIRE(tiled);
+
+	// tiled images have no plain view to count over
+	Image_View const view = Image_ViewOf(tiled);
+	REQUIRE(view.width == 0);
+	Image_StatisticsDesc desc = {};
+	desc.threadCount = 4;
+	Image_Statistics const *stats = Image_ViewComputeStatistics(&view, &desc);
+	REQUIRE(stats);
+	CHECK(stats->binCount == 256);
+	for (uint32_t i = 0; i < 4; ++i) {
+		CHECK(stats->channel[i].count == 0);
+		CHECK(stats->channel[i].min == 0.0);
+		CHECK(stats->channel[i].max == 0.0);
+		for (uint32_t b = 0; b < stats->binCount; ++b) {
+			CHECK(Image_StatisticsHistogramOf(stats, i)[b] == 0);
+		}
+	}
+	Image_DestroyStatistics(stats);
+	Image_Destroy(tiled);
+	Image_Destroy(image);
+}
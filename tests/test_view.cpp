@@ -0,0 +1,181 @@
+#include "al2o3_platform/platform.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "gfx_image/utils.h"
+#include "tiny_imageformat/tinyimageformat_base.h"
+#include "gfx_image_impl_basic/mipmap.h"
+#include "gfx_image_impl_basic/statistics.h"
+#include "gfx_image_impl_basic/tiled.h"
+#include "gfx_image_impl_basic/view.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "test_helpers.hpp"
+#include <cstring>
+
+namespace {
+
+// pixel (x, y, 0, w) of a and (bx, by, 0, bw) of b decode the same
+bool SamePixel(Image_ImageHeader const *a, uint32_t x, uint32_t y, uint32_t w,
+							 Image_ImageHeader const *b, uint32_t bx, uint32_t by, uint32_t bw) {
+	double pa[4] = {0, 0, 0, 0};
+	double pb[4] = {0, 0, 0, 0};
+	Image_GetPixelAtD(a, pa, Image_CalculateIndex(a, x, y, 0, w));
+	Image_GetPixelAtD(b, pb, Image_CalculateIndex(b, bx, by, 0, bw));
+	return memcmp(pa, pb, sizeof(pa)) == 0;
+}
+
+} // end anon namespace
+
+TEST_CASE("Views of regions clone and convert (C)", "[Image View]") {
+	Image_ImageHeader const *image = Image_Create(32, 24, 1, 3, TinyImageFormat_R8G8B8A8_UNORM);
+	FillBytes(image, 11);
+
+	Image_View const crop = Image_ViewOfRegion(image, 3, 5, 0, 1, 10, 7, 1, 2);
+	TinyImageFormat const formats[] = {
+			TinyImageFormat_UNDEFINED, TinyImageFormat_B8G8R8A8_UNORM, TinyImageFormat_R16G16B16A16_UNORM,
+	};
+	for (TinyImageFormat format : formats) {
+		Image_ImageHeader const *clone = Image_ViewClone(&crop, format);
+		REQUIRE(clone);
+		CHECK(clone->width == 10);
+		CHECK(clone->height == 7);
+		CHECK(clone->slices == 2);
+		bool same = true;
+		for (uint32_t w = 0; w < 2; ++w) {
+			for (uint32_t y = 0; y < 7; ++y) {
+				for (uint32_t x = 0; x < 10; ++x) {
+					same = same && SamePixel(clone, x, y, w, image, x + 3, y + 5, w + 1);
+				}
+			}
+		}
+		CHECK(same);
+		Image_Destroy(clone);
+	}
+
+	// pasting a tile only touches the tile
+	Image_ImageHeader const *tile = Image_Create(4, 4, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	memset(Image_RawDataPtr(tile), 0xff, tile->dataSize);
+	Image_ImageHeader const *before = Image_Clone(image);
+	Image_View const src = Image_ViewOf(tile);
+	Image_View const dst = Image_ViewOfRegion(image, 8, 4, 0, 2, 4, 4, 1, 1);
+	REQUIRE(Image_ViewCopy(&src, &dst));
+	bool untouched = true;
+	bool pasted = true;
+	for (uint32_t w = 0; w < 3; ++w) {
+		for (uint32_t y = 0; y < 24; ++y) {
+			for (uint32_t x = 0; x < 32; ++x) {
+				if (w == 2 && x >= 8 && x < 12 && y >= 4 && y < 8) {
+					pasted = pasted && SamePixel(image, x, y, w, tile, x - 8, y - 4, 0);
+				} else {
+					untouched = untouched && SamePixel(image, x, y, w, before, x, y, w);
+				}
+			}
+		}
+	}
+	CHECK(pasted);
+	CHECK(untouched);
+
+	Image_Destroy(before);
+	Image_Destroy(tile);
+	Image_Destroy(image);
+}
+
+TEST_CASE("Color range and statistics of views (C)", "[Image View]") {
+	TinyImageFormat const formats[] = {
+			TinyImageFormat_R8G8B8A8_UNORM,
+			TinyImageFormat_R16G16_SINT,
+			TinyImageFormat_R16G16B16A16_SFLOAT,
+			TinyImageFormat_R32G32B32A32_SFLOAT,
+	};
+	for (TinyImageFormat format : formats) {
+		Image_ImageHeader const *image = Image_Create(67, 45, 1, 2, format);
+		FillBytes(image, 5);
+		Image_View const crop = Image_ViewOfRegion(image, 7, 3, 0, 1, 41, 30, 1, 1);
+		Image_ImageHeader const *clone = Image_ViewClone(&crop, TinyImageFormat_UNDEFINED);
+		REQUIRE(clone);
+
+		Image_PixelD viewMin, viewMax, cloneMin, cloneMax;
+		REQUIRE(Image_ViewGetColorRangeOf(&crop, &viewMin, &viewMax));
+		REQUIRE(Image_GetColorRangeOf(clone, &cloneMin, &cloneMax));
+		CHECK(memcmp(&viewMin, &cloneMin, sizeof(double) * TinyImageFormat_ChannelCount(format)) == 0);
+		CHECK(memcmp(&viewMax, &cloneMax, sizeof(double) * TinyImageFormat_ChannelCount(format)) == 0);
+
+		Image_StatisticsDesc desc{};
+		desc.threadCount = 2;
+		Image_Statistics const *viewStats = Image_ViewComputeStatistics(&crop, &desc);
+		Image_Statistics const *cloneStats = Image_ComputeStatistics(clone, &desc);
+		REQUIRE(viewStats);
+		REQUIRE(cloneStats);
+		for (uint32_t c = 0; c < 4; ++c) {
+			CHECK(viewStats->channel[c].count == cloneStats->channel[c].count);
+			CHECK(viewStats->channel[c].mean == cloneStats->channel[c].mean);
+			CHECK(viewStats->channel[c].variance == cloneStats->channel[c].variance);
+			CHECK(memcmp(Image_StatisticsHistogramOf(viewStats, c), Image_StatisticsHistogramOf(cloneStats, c),
+									 sizeof(uint64_t) * viewStats->binCount) == 0);
+		}
+
+		Image_DestroyStatistics(cloneStats);
+		Image_DestroyStatistics(viewStats);
+		Image_Destroy(clone);
+		Image_Destroy(image);
+	}
+}
+
+TEST_CASE("Views of slices and mip levels (C)", "[Image View]") {
+	Image_ImageHeader const *image = Image_Create(16, 8, 1, 6, TinyImageFormat_R8G8B8A8_UNORM);
+	FillBytes(image, 3);
+	Image_View const face = Image_ViewOfSlice(image, 4);
+	CHECK(face.data == (uint8_t *) Image_RawDataPtr(image) + 4 * Image_ByteCountPerSliceOf(image));
+	CHECK(face.slices == 1);
+	Image_Destroy(image);
+
+	Image_ImageHeader const *chain = Image_Create(16, 8, 1, 1, TinyImageFormat_R8G8B8A8_UNORM);
+	FillBytes(chain, 9);
+	Image_MipMapChainDesc const mipDesc = {true, 1, Image_MMF_FastBox};
+	Image_CreateMipMapChainEx(chain, &mipDesc);
+	Image_ImageHeader const *packed = Image_PackMipmaps(chain);
+	REQUIRE(packed != chain);
+	for (uint32_t level = 0; level < Image_MipMapCountOf(chain); ++level) {
+		Image_View const linked = Image_ViewOfMipLevel(chain, level);
+		Image_View const inPacked = Image_ViewOfMipLevel(packed, level);
+		Image_ImageHeader const *levelImage = Image_LinkedImageOf(chain, level);
+		CHECK(linked.data == Image_RawDataPtr(levelImage));
+		CHECK(inPacked.width == levelImage->width);
+		CHECK(inPacked.height == levelImage->height);
+		CHECK(memcmp(inPacked.data, linked.data, levelImage->dataSize) == 0);
+	}
+	Image_Destroy(packed);
+	Image_Destroy(chain);
+}
+
+TEST_CASE("Views of tiled images are empty (C)", "[Image View]") {
+	Image_ImageHeader const *image = Image_Create(16, 16, 1, 2, TinyImageFormat_R8G8B8A8_UNORM);
+	FillBytes(image, 5);
+	Image_ImageHeader const *tiled = Image_CloneTiled(image);
+	REQUIRE(Image_IsTiled(tiled));
+
+	Image_View const views[] = {
+			Image_ViewOf(tiled),
+			Image_ViewOfRegion(tiled, 0, 0, 0, 0, 16, 16, 1, 1),
+			Image_ViewOfSlice(tiled, 1),
+			Image_ViewOfMipLevel(tiled, 0),
+	};
+	Image_View const linear = Image_ViewOf(image);
+	for (Image_View const &view : views) {
+		CHECK(view.data == nullptr);
+		CHECK(view.width == 0);
+		CHECK(view.slices == 0);
+		CHECK(Image_ViewClone(&view, TinyImageFormat_UNDEFINED) == nullptr);
+		CHECK_FALSE(Image_ViewCopy(&view, &linear));
+		CHECK_FALSE(Image_ViewCopy(&linear, &view));
+	}
+
+	// the whole image queries don't care about the order
+	Image_PixelD tiledMin, tiledMax, linearMin, linearMax;
+	Image_GetColorRangeOf(tiled, &tiledMin, &tiledMax);
+	Image_GetColorRangeOf(image, &linearMin, &linearMax);
+	CHECK(memcmp(&tiledMin, &linearMin, sizeof(tiledMin)) == 0);
+	CHECK(memcmp(&tiledMax, &linearMax, sizeof(tiledMax)) == 0);
+
+	Image_Destroy(tiled);
+	Image_Destroy(image);
+}